@@ -0,0 +1,69 @@
+/*
+
+Shared by the cglm benchmarks in this folder.
+
+Each one checks the batch functions against the ones they replace,
+and then times both, keeping the best of several runs.
+Built and run with:
+
+	make bench
+
+*/
+
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "cglm/cglm.h"
+#include "cglm/call.h"
+
+
+// A million items, large enough not to fit in any cache
+#define BENCH_COUNT ( 1 << 20 )
+
+// Seconds from an arbitrary point, never going back
+static double benchNow( void ){
+
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+
+	return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// Between -1 and 1
+static float benchRandom( void ){
+
+	return (float) rand() / RAND_MAX * 2 - 1;
+}
+
+// Aligned for any SIMD width, and never NULL, even for 0 bytes
+static void* benchAlloc( size_t size ){
+
+	void* memory = aligned_alloc( 64, ( size + 64 ) & ~(size_t) 63 );
+
+	if ( memory == NULL ){
+		printf( "Out of memory.\n" );
+		exit( -1 );
+	}
+
+	return memory;
+}
+
+// Which kernels the inline glm_ functions were built with
+static const char* benchInstructionSet( void ){
+
+#if defined( __AVX2__ ) && defined( __FMA__ )
+	return "AVX2+FMA";
+#elif defined( __AVX__ )
+	return "AVX";
+#elif defined( __SSE2__ )
+	return "SSE2";
+#elif defined( CGLM_NEON_FP )
+	return "NEON";
+#else
+	return "scalar";
+#endif
+}
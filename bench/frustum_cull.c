@@ -0,0 +1,251 @@
+/*
+
+Frustum culling of a million boxes and spheres:
+glm_aabb_frustum_soa and glm_sphere_frustum_soa, and their _index
+versions, against calling glm_aabb_frustum and glm_sphere_frustum
+for each one.
+
+The boxes are spread around a camera looking along a diagonal,
+so that a fair share of them are visible and the rest are not.
+
+*/
+
+#include "bench.h"
+
+
+#define BENCH_RUNS 50
+
+typedef struct {
+	// Array of structures, for the single versions
+	vec3 (*boxes)[2];
+	vec4 * spheres;
+
+	// Structure of arrays, for the batch ones
+	float * centers[3];
+	float * extents[3];
+	float * sphereArrays[4];
+
+	vec4 planes[6];
+	uint32_t * mask;
+	uint32_t * indices;
+	size_t count;
+} Scene;
+
+static void init( Scene * s, size_t count ){
+
+	s->count = count;
+	s->boxes = (vec3 (*)[2]) benchAlloc( count * sizeof( vec3[2] ) );
+	s->spheres = (vec4*) benchAlloc( count * sizeof( vec4 ) );
+
+	for ( int a = 0; a < 3; a++ ){
+		s->centers[a] = (float*) benchAlloc( count * sizeof( float ) );
+		s->extents[a] = (float*) benchAlloc( count * sizeof( float ) );
+	}
+
+	for ( int a = 0; a < 4; a++ )
+		s->sphereArrays[a] = (float*) benchAlloc( count * sizeof( float ) );
+
+	// One more word, to catch writes past the last one
+	s->mask = (uint32_t*) benchAlloc( ( ( count + 31 ) / 32 + 1 ) * sizeof( uint32_t ) );
+	s->indices = (uint32_t*) benchAlloc( count * sizeof( uint32_t ) );
+
+	for ( size_t i = 0; i < count; i++ ){
+
+		for ( int a = 0; a < 3; a++ ){
+
+			float center = benchRandom() * 100;
+			float extent = fabsf( benchRandom() ) * 2;
+
+			s->centers[a][i] = center;
+			s->extents[a][i] = extent;
+			s->boxes[i][0][a] = center - extent;
+			s->boxes[i][1][a] = center + extent;
+			s->spheres[i][a] = s->sphereArrays[a][i] = center;
+		}
+
+		s->spheres[i][3] = s->sphereArrays[3][i] = fabsf( benchRandom() ) * 3;
+	}
+
+	mat4 projection, view, viewProjection;
+	vec3 eye = { 0, 0, 0 }, target = { 1, 0.2f, 0.5f }, up = { 0, 1, 0 };
+
+	glm_perspective( glm_rad( 60 ), 16.0f / 9, 0.1f, 80, projection );
+	glm_lookat( eye, target, up, view );
+	glm_mat4_mul( projection, view, viewProjection );
+	glm_frustum_planes( viewProjection, s->planes );
+}
+
+static void destroy( Scene * s ){
+
+	free( s->boxes );
+	free( s->spheres );
+
+	for ( int a = 0; a < 3; a++ ){
+		free( s->centers[a] );
+		free( s->extents[a] );
+	}
+
+	for ( int a = 0; a < 4; a++ )
+		free( s->sphereArrays[a] );
+
+	free( s->mask );
+	free( s->indices );
+}
+
+static int maskBit( Scene * s, size_t i ){
+
+	return ( s->mask[i >> 5] >> ( i & 31 ) ) & 1;
+}
+
+// Items where the batch versions disagree with the single ones,
+// or the index lists with the mask. Returns the visible boxes and spheres
+static size_t check( Scene * s, size_t * visibleSpheres ){
+
+	size_t wrong = 0, visible = 0, count = s->count;
+	size_t words = ( count + 31 ) / 32;
+
+	s->mask[words] = 0xDEADBEEF;
+	glm_aabb_frustum_soa( s->centers, s->extents, s->planes, s->mask, count );
+
+	for ( size_t i = 0; i < count; i++ ){
+		int single = glm_aabb_frustum( s->boxes[i], s->planes );
+		visible += single;
+		wrong += single != maskBit( s, i );
+	}
+
+	// Bits past the last box are cleared, and nothing after them written
+	if ( count & 31 )
+		wrong += ( s->mask[count >> 5] >> ( count & 31 ) ) != 0;
+	wrong += s->mask[words] != 0xDEADBEEF;
+
+	size_t listed = glm_aabb_frustum_soa_index( s->centers, s->extents, s->planes, s->indices, count );
+	size_t k = 0;
+
+	for ( size_t i = 0; i < count; i++ )
+		if ( maskBit( s, i ) )
+			wrong += k >= listed || s->indices[k++] != i;
+	wrong += k != listed;
+
+	// The library build, with the kernel picked at load time
+	wrong += glmc_aabb_frustum_soa_index( s->centers, s->extents, s->planes, s->indices, count ) != listed;
+
+
+	*visibleSpheres = 0;
+	glm_sphere_frustum_soa( s->sphereArrays, s->planes, s->mask, count );
+
+	for ( size_t i = 0; i < count; i++ ){
+		int single = glm_sphere_frustum( s->spheres[i], s->planes );
+		*visibleSpheres += single;
+		wrong += single != maskBit( s, i );
+	}
+
+	wrong += glm_sphere_frustum_soa_index( s->sphereArrays, s->planes, s->indices, count ) != *visibleSpheres;
+	wrong += glmc_sphere_frustum_soa_index( s->sphereArrays, s->planes, s->indices, count ) != *visibleSpheres;
+
+	if ( wrong > 0 ){
+		printf( "%zu results differ with %zu items.\n", wrong, count );
+		exit( -1 );
+	}
+
+	return visible;
+}
+
+enum {
+	AABB_LOOP,
+	AABB_SOA,
+	AABB_SOA_INDEX,
+	SPHERE_LOOP,
+	SPHERE_SOA,
+	SPHERE_SOA_INDEX,
+	VERSIONS
+};
+
+static const char* names[VERSIONS] = {
+	"glm_aabb_frustum loop",
+	"glm_aabb_frustum_soa",
+	"glm_aabb_frustum_soa_index",
+	"glm_sphere_frustum loop",
+	"glm_sphere_frustum_soa",
+	"glm_sphere_frustum_soa_index"
+};
+
+// Returns how many are visible, so that the loops aren't optimized out
+static size_t run( int version, Scene * s ){
+
+	size_t visible = 0, i;
+
+	switch ( version ){
+
+		case AABB_LOOP:
+			for ( i = 0; i < s->count; i++ )
+				visible += glm_aabb_frustum( s->boxes[i], s->planes );
+			break;
+
+		case AABB_SOA:
+			glm_aabb_frustum_soa( s->centers, s->extents, s->planes, s->mask, s->count );
+			break;
+
+		case AABB_SOA_INDEX:
+			visible = glm_aabb_frustum_soa_index( s->centers, s->extents, s->planes, s->indices, s->count );
+			break;
+
+		case SPHERE_LOOP:
+			for ( i = 0; i < s->count; i++ )
+				visible += glm_sphere_frustum( s->spheres[i], s->planes );
+			break;
+
+		case SPHERE_SOA:
+			glm_sphere_frustum_soa( s->sphereArrays, s->planes, s->mask, s->count );
+			break;
+
+		case SPHERE_SOA_INDEX:
+			visible = glm_sphere_frustum_soa_index( s->sphereArrays, s->planes, s->indices, s->count );
+			break;
+	}
+
+	return visible;
+}
+
+int main( void ){
+
+	Scene s;
+	size_t visible, visibleSpheres;
+
+	// Every tail length first, then the whole million
+	for ( size_t count = 0; count < 70; count++ ){
+		init( &s, count );
+		check( &s, &visibleSpheres );
+		destroy( &s );
+	}
+
+	init( &s, BENCH_COUNT );
+	visible = check( &s, &visibleSpheres );
+
+	printf(
+		"Frustum culling, %s, %zu of %zu boxes and %zu spheres visible\n",
+		benchInstructionSet(), visible, s.count, visibleSpheres
+	);
+
+	double loop = 0;
+	volatile size_t sink = 0;
+
+	for ( int v = 0; v < VERSIONS; v++ ){
+
+		double best = 1e9;
+
+		for ( int r = 0; r < BENCH_RUNS; r++ ){
+			double start = benchNow();
+			sink += run( v, &s );
+			best = fmin( best, benchNow() - start );
+		}
+
+		if ( v == AABB_LOOP || v == SPHERE_LOOP )
+			loop = best;
+
+		printf( "  %-30s %7.3f ms %5.2fx\n", names[v], best * 1e3, loop / best );
+	}
+
+	destroy( &s );
+
+	return 0;
+}
@@ -0,0 +1,154 @@
+/*
+
+glm_mat4_mul_batch and glm_mat4_mul_batch_stream,
+against calling glm_mat4_mul for each pair.
+
+The streaming version writes past the cache, which only pays off
+once the results are too many to stay in it, and are not read back soon.
+
+*/
+
+#include "bench.h"
+
+
+#define BENCH_RUNS 15
+
+enum {
+	MUL_LOOP,
+	MUL_BATCH,
+	MUL_BATCH_STREAM,
+	VERSIONS
+};
+
+static const char* names[VERSIONS] = {
+	"glm_mat4_mul loop",
+	"glm_mat4_mul_batch",
+	"glm_mat4_mul_batch_stream"
+};
+
+static void run( int version, mat4 * a, mat4 * b, mat4 * dest, size_t count ){
+
+	size_t i;
+
+	switch ( version ){
+
+		case MUL_LOOP:
+			for ( i = 0; i < count; i++ )
+				glm_mat4_mul( a[i], b[i], dest[i] );
+			break;
+
+		case MUL_BATCH:
+			glm_mat4_mul_batch( a, b, dest, count );
+			break;
+
+		case MUL_BATCH_STREAM:
+			glm_mat4_mul_batch_stream( a, b, dest, count );
+			break;
+	}
+}
+
+static float difference( mat4 x, mat4 y ){
+
+	float error = 0;
+
+	for ( int j = 0; j < 16; j++ )
+		error = fmaxf( error, fabsf( x[j / 4][j % 4] - y[j / 4][j % 4] ) );
+
+	return error;
+}
+
+// Largest difference with glm_mat4_mul, including odd counts,
+// storage only 16 byte aligned, and in place.
+// A mat4 pointer below the 32 byte alignment of AVX builds is undefined,
+// so 16 byte aligned storage gets the results through an aligned scratch
+// buffer; the & 31 fallback is for callers of glmc_ built without AVX
+static float check( mat4 * a, mat4 * b, mat4 * dest ){
+
+	const size_t count = 1000;
+	float error = 0;
+	mat4 expected;
+
+	for ( int v = MUL_BATCH; v < VERSIONS; v++ ){
+
+		run( v, a, b, dest, count );
+
+		for ( size_t i = 0; i < count; i++ ){
+			glm_mat4_mul( a[i], b[i], expected );
+			error = fmaxf( error, difference( expected, dest[i] ) );
+		}
+	}
+
+	float * unaligned = (float*) dest + 4;
+	mat4 scratch[7];
+	glm_mat4_mul_batch_stream( a, b, scratch, 7 );
+	memcpy( unaligned, scratch, sizeof( scratch ) );
+
+	for ( size_t i = 0; i < 7; i++ ){
+		glm_mat4_mul( a[i], b[i], expected );
+		for ( int j = 0; j < 16; j++ )
+			error = fmaxf( error, fabsf( expected[j / 4][j % 4] - unaligned[i * 16 + j] ) );
+	}
+
+	mat4 inPlace[5];
+	memcpy( inPlace, a, sizeof( inPlace ) );
+	glm_mat4_mul_batch( inPlace, b, inPlace, 5 );
+
+	for ( size_t i = 0; i < 5; i++ ){
+		glm_mat4_mul( a[i], b[i], expected );
+		error = fmaxf( error, difference( expected, inPlace[i] ) );
+	}
+
+	return error;
+}
+
+int main( void ){
+
+	mat4 * a = (mat4*) benchAlloc( BENCH_COUNT * sizeof( mat4 ) );
+	mat4 * b = (mat4*) benchAlloc( BENCH_COUNT * sizeof( mat4 ) );
+	mat4 * dest = (mat4*) benchAlloc( BENCH_COUNT * sizeof( mat4 ) );
+
+	for ( size_t i = 0; i < BENCH_COUNT; i++ )
+		for ( int j = 0; j < 16; j++ ){
+			a[i][j / 4][j % 4] = benchRandom();
+			b[i][j / 4][j % 4] = benchRandom();
+		}
+
+	printf( "mat4 * mat4, %s, largest error %g\n", benchInstructionSet(), check( a, b, dest ) );
+
+
+	// From in L1 to far past the last level cache
+	size_t counts[] = { 1024, 16384, BENCH_COUNT };
+
+	for ( size_t c = 0; c < sizeof( counts ) / sizeof( counts[0] ); c++ ){
+
+		size_t count = counts[c];
+
+		// The small ones a few times over, for a measurable time
+		int repeats = BENCH_COUNT / count;
+		if ( repeats > 64 )
+			repeats = 64;
+
+		printf( "%zu matrices, %.1f MB per array:\n", count, count * sizeof( mat4 ) / 1048576.0 );
+
+		for ( int v = 0; v < VERSIONS; v++ ){
+
+			double best = 1e9;
+
+			for ( int r = 0; r < BENCH_RUNS; r++ ){
+
+				double start = benchNow();
+				for ( int k = 0; k < repeats; k++ )
+					run( v, a, b, dest, count );
+				best = fmin( best, ( benchNow() - start ) / repeats );
+			}
+
+			printf( "  %-26s %8.1f Mmat/s\n", names[v], count / best * 1e-6 );
+		}
+	}
+
+	free( a );
+	free( b );
+	free( dest );
+
+	return 0;
+}
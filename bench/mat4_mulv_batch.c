@@ -0,0 +1,208 @@
+/*
+
+glm_mat4_mulv_batch and the vec3 and SoA versions,
+against calling glm_mat4_mulv and glm_mat4_mulv3 for each vector.
+
+With a million points every version mostly waits for memory,
+so the vec4 batch is little faster than the loop: glm_mat4_mulv
+already uses whole registers, and both move the same bytes.
+The vec3 batch and the SoA versions gain from not wasting lanes on w,
+which shows best with the points in L1.
+
+*/
+
+#include "bench.h"
+
+
+#define BENCH_RUNS 20
+// Points that stay in L1, transformed this many times
+#define BENCH_SMALL_COUNT 1024
+#define BENCH_SMALL_REPEATS 1024
+
+typedef struct {
+	mat4 m;
+	vec4 * v4;
+	vec4 * dest4;
+	vec3 * v3;
+	vec3 * dest3;
+	float * soa[4];
+	float * destSoa[4];
+} Points;
+
+enum {
+	MULV_LOOP,
+	MULV_BATCH,
+	MULV3_LOOP,
+	MULV3_BATCH,
+	MULV_BATCH_SOA,
+	MULV3_BATCH_SOA,
+	VERSIONS
+};
+
+static const char* names[VERSIONS] = {
+	"glm_mat4_mulv loop",
+	"glm_mat4_mulv_batch",
+	"glm_mat4_mulv3 loop",
+	"glm_mat4_mulv3_batch",
+	"glm_mat4_mulv_batch_soa",
+	"glm_mat4_mulv3_batch_soa"
+};
+
+static void run( int version, Points * p, size_t count ){
+
+	size_t i;
+
+	switch ( version ){
+
+		case MULV_LOOP:
+			for ( i = 0; i < count; i++ )
+				glm_mat4_mulv( p->m, p->v4[i], p->dest4[i] );
+			break;
+
+		case MULV_BATCH:
+			glm_mat4_mulv_batch( p->m, p->v4, p->dest4, count );
+			break;
+
+		case MULV3_LOOP:
+			for ( i = 0; i < count; i++ )
+				glm_mat4_mulv3( p->m, p->v3[i], 1, p->dest3[i] );
+			break;
+
+		case MULV3_BATCH:
+			glm_mat4_mulv3_batch( p->m, p->v3, 1, p->dest3, count );
+			break;
+
+		case MULV_BATCH_SOA:
+			glm_mat4_mulv_batch_soa( p->m, p->soa, p->destSoa, count );
+			break;
+
+		case MULV3_BATCH_SOA:
+			glm_mat4_mulv3_batch_soa( p->m, p->soa, 1, p->destSoa, count );
+			break;
+	}
+}
+
+static void destroy( Points * p ){
+
+	free( p->v4 );
+	free( p->dest4 );
+	free( p->v3 );
+	free( p->dest3 );
+
+	for ( int j = 0; j < 4; j++ ){
+		free( p->soa[j] );
+		free( p->destSoa[j] );
+	}
+}
+
+// Largest difference with the loops, over counts that leave every tail length
+static float check( Points * p ){
+
+	size_t counts[] = { 0, 1, 3, 5, 7, 9, 13, 17, BENCH_COUNT };
+	float error = 0;
+
+	vec4 * loop4 = (vec4*) benchAlloc( BENCH_COUNT * sizeof( vec4 ) );
+	vec3 * loop3 = (vec3*) benchAlloc( BENCH_COUNT * sizeof( vec3 ) );
+
+	for ( size_t i = 0; i < BENCH_COUNT; i++ ){
+		glm_mat4_mulv( p->m, p->v4[i], loop4[i] );
+		glm_mat4_mulv3( p->m, p->v3[i], 1, loop3[i] );
+	}
+
+	for ( size_t c = 0; c < sizeof( counts ) / sizeof( counts[0] ); c++ ){
+
+		size_t count = counts[c];
+
+		run( MULV_BATCH, p, count );
+		run( MULV3_BATCH, p, count );
+		run( MULV_BATCH_SOA, p, count );
+
+		for ( size_t i = 0; i < count; i++ )
+			for ( int j = 0; j < 4; j++ ){
+				error = fmaxf( error, fabsf( loop4[i][j] - p->dest4[i][j] ) );
+				error = fmaxf( error, fabsf( loop4[i][j] - p->destSoa[j][i] ) );
+				if ( j < 3 )
+					error = fmaxf( error, fabsf( loop3[i][j] - p->dest3[i][j] ) );
+			}
+
+		run( MULV3_BATCH_SOA, p, count );
+
+		for ( size_t i = 0; i < count; i++ )
+			for ( int j = 0; j < 3; j++ )
+				error = fmaxf( error, fabsf( loop3[i][j] - p->destSoa[j][i] ) );
+	}
+
+	free( loop4 );
+	free( loop3 );
+
+	return error;
+}
+
+int main( void ){
+
+	Points p;
+
+	for ( int i = 0; i < 16; i++ )
+		p.m[i / 4][i % 4] = benchRandom();
+
+	p.v4 = (vec4*) benchAlloc( BENCH_COUNT * sizeof( vec4 ) );
+	p.dest4 = (vec4*) benchAlloc( BENCH_COUNT * sizeof( vec4 ) );
+	p.v3 = (vec3*) benchAlloc( BENCH_COUNT * sizeof( vec3 ) );
+	p.dest3 = (vec3*) benchAlloc( BENCH_COUNT * sizeof( vec3 ) );
+
+	for ( int j = 0; j < 4; j++ ){
+		p.soa[j] = (float*) benchAlloc( BENCH_COUNT * sizeof( float ) );
+		p.destSoa[j] = (float*) benchAlloc( BENCH_COUNT * sizeof( float ) );
+	}
+
+	// w is 1 for every layout, as mulv3 assumes
+	for ( size_t i = 0; i < BENCH_COUNT; i++ )
+		for ( int j = 0; j < 4; j++ ){
+			float x = j < 3 ? benchRandom() : 1;
+			p.v4[i][j] = p.soa[j][i] = x;
+			if ( j < 3 )
+				p.v3[i][j] = x;
+		}
+
+	printf( "mat4 * vector, %s, largest error %g\n", benchInstructionSet(), check( &p ) );
+
+
+	double big[VERSIONS], small[VERSIONS];
+
+	for ( int v = 0; v < VERSIONS; v++ ){
+
+		big[v] = small[v] = 1e9;
+
+		for ( int r = 0; r < BENCH_RUNS; r++ ){
+
+			double start = benchNow();
+			run( v, &p, BENCH_COUNT );
+			big[v] = fmin( big[v], benchNow() - start );
+
+			start = benchNow();
+			for ( int k = 0; k < BENCH_SMALL_REPEATS; k++ )
+				run( v, &p, BENCH_SMALL_COUNT );
+			small[v] = fmin( small[v], benchNow() - start );
+		}
+	}
+
+	printf( "%-26s %14s %22s\n", "", "1M points", "1024 points, in L1" );
+
+	for ( int v = 0; v < VERSIONS; v++ ){
+
+		// Against the loop over the same vectors
+		int loop = v == MULV_LOOP || v == MULV_BATCH || v == MULV_BATCH_SOA ? MULV_LOOP : MULV3_LOOP;
+
+		printf(
+			"%-26s %8.3f ms %4.2fx %10.2f Gpts/s %4.2fx\n",
+			names[v],
+			big[v] * 1e3, big[loop] / big[v],
+			BENCH_SMALL_COUNT * (double) BENCH_SMALL_REPEATS / small[v] * 1e-9,
+			small[loop] / small[v]
+		);
+	}
+
+	destroy( &p );
+
+	return 0;
+}
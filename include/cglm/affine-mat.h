@@ -148,7 +148,9 @@ glm_mul_rot(mat4 m1, mat4 m2, mat4 dest) {
 CGLM_INLINE
 void
 glm_inv_tr(mat4 mat) {
-#if defined( __SSE__ ) || defined( __SSE2__ )
+#if defined( __AVX__ ) && defined( __FMA__ )
+  glm_inv_tr_fma(mat);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
   glm_inv_tr_sse2(mat);
 #else
   CGLM_ALIGN_MAT mat3 r;
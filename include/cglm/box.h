@@ -13,6 +13,14 @@
 #include "vec4.h"
 #include "util.h"
 
+#ifdef CGLM_SSE_FP
+#  include "simd/sse2/box.h"
+#endif
+
+#ifdef CGLM_AVX_FP
+#  include "simd/avx/box.h"
+#endif
+
 /*!
  * @brief apply transform to Axis-Aligned Bounding Box
  *
@@ -150,6 +158,96 @@ glm_aabb_frustum(vec3 box[2], vec4 planes[6]) {
   return true;
 }
 
+/*!
+ * @brief frustum culling for many AABBs, stored as structure of arrays
+ *
+ * boxes are given by center and extent (half size), one array for each
+ * axis, e.g. center[0][i] is the x of the center of box i. four boxes
+ * (eight with AVX) are tested against the six planes at a time.
+ *
+ * box i is visible when bit (i & 31) of mask[i >> 5] is set. bits past
+ * count in the last word are cleared
+ *
+ * @param[in]  center center arrays, x y z
+ * @param[in]  extent extent arrays, x y z
+ * @param[in]  planes frustum planes, from glm_frustum_planes
+ * @param[out] mask   visibility, (count + 31) / 32 words
+ * @param[in]  count  number of boxes
+ */
+CGLM_INLINE
+void
+glm_aabb_frustum_soa(float *center[3], float *extent[3], vec4 planes[6],
+                     uint32_t *mask, size_t count) {
+#if defined( __AVX__ )
+  glm_aabb_frustum_soa_avx(center, extent, planes, mask, count);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
+  glm_aabb_frustum_soa_sse2(center, extent, planes, mask, count);
+#else
+  float   *p, dp;
+  uint32_t w;
+  size_t   i;
+  int      k;
+
+  w = 0;
+  for (i = 0; i < count; i++) {
+    for (k = 0; k < 6; k++) {
+      p  = planes[k];
+      dp = p[0] * center[0][i] + p[1] * center[1][i] + p[2] * center[2][i]
+         + p[3] + fabsf(p[0]) * extent[0][i] + fabsf(p[1]) * extent[1][i]
+         + fabsf(p[2]) * extent[2][i];
+
+      if (dp < 0.0f)
+        break;
+    }
+
+    w |= (uint32_t)(k == 6) << (i & 31);
+
+    if (((i + 1) & 31) == 0) {
+      mask[i >> 5] = w;
+      w = 0;
+    }
+  }
+
+  if (count & 31)
+    mask[count >> 5] = w;
+#endif
+}
+
+/*!
+ * @brief same as glm_aabb_frustum_soa, but writes the indices of the
+ *        visible boxes instead of a bitmask, e.g. for building draw lists
+ *
+ * @param[in]  center  center arrays, x y z
+ * @param[in]  extent  extent arrays, x y z
+ * @param[in]  planes  frustum planes, from glm_frustum_planes
+ * @param[out] indices visible boxes in increasing order, room for count
+ * @param[in]  count   number of boxes
+ *
+ * @return number of visible boxes
+ */
+CGLM_INLINE
+size_t
+glm_aabb_frustum_soa_index(float *center[3], float *extent[3],
+                           vec4 planes[6], uint32_t *indices, size_t count) {
+  uint32_t mask[8];
+  float   *c[3], *e[3];
+  size_t   i, k, n;
+
+  /* 256 boxes at a time, so the mask stays on the stack */
+  n = 0;
+  for (i = 0; i < count; i += k) {
+    k = GLM_MIN(count - i, 256);
+
+    c[0] = center[0] + i; c[1] = center[1] + i; c[2] = center[2] + i;
+    e[0] = extent[0] + i; e[1] = extent[1] + i; e[2] = extent[2] + i;
+
+    glm_aabb_frustum_soa(c, e, planes, mask, k);
+    n += glm_bitmask_index(mask, k, (uint32_t)i, indices + n);
+  }
+
+  return n;
+}
+
 /*!
  * @brief invalidate AABB min and max values
  *
@@ -27,6 +27,7 @@ extern "C" {
 #include "call/project.h"
 #include "call/sphere.h"
 #include "call/ease.h"
+#include "call/simd.h"
 
 #ifdef __cplusplus
 }
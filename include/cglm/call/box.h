@@ -36,6 +36,16 @@ CGLM_EXPORT
 bool
 glmc_aabb_frustum(vec3 box[2], vec4 planes[6]);
 
+CGLM_EXPORT
+void
+glmc_aabb_frustum_soa(float *center[3], float *extent[3], vec4 planes[6],
+                      uint32_t *mask, size_t count);
+
+CGLM_EXPORT
+size_t
+glmc_aabb_frustum_soa_index(float *center[3], float *extent[3],
+                            vec4 planes[6], uint32_t *indices, size_t count);
+
 CGLM_EXPORT
 void
 glmc_aabb_invalidate(vec3 box[2]);
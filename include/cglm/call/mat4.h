@@ -53,6 +53,14 @@ CGLM_EXPORT
 void
 glmc_mat4_mulN(mat4 * __restrict matrices[], uint32_t len, mat4 dest);
 
+CGLM_EXPORT
+void
+glmc_mat4_mul_batch(mat4 *a, mat4 *b, mat4 *dest, size_t count);
+
+CGLM_EXPORT
+void
+glmc_mat4_mul_batch_stream(mat4 *a, mat4 *b, mat4 *dest, size_t count);
+
 CGLM_EXPORT
 void
 glmc_mat4_mulv(mat4 m, vec4 v, vec4 dest);
@@ -61,6 +69,23 @@ CGLM_EXPORT
 void
 glmc_mat4_mulv3(mat4 m, vec3 v, float last, vec3 dest);
 
+CGLM_EXPORT
+void
+glmc_mat4_mulv_batch(mat4 m, vec4 *v, vec4 *dest, size_t count);
+
+CGLM_EXPORT
+void
+glmc_mat4_mulv3_batch(mat4 m, vec3 *v, float last, vec3 *dest, size_t count);
+
+CGLM_EXPORT
+void
+glmc_mat4_mulv_batch_soa(mat4 m, float *src[4], float *dest[4], size_t count);
+
+CGLM_EXPORT
+void
+glmc_mat4_mulv3_batch_soa(mat4 m, float *src[3], float last, float *dest[3],
+                          size_t count);
+
 CGLM_EXPORT
 float
 glmc_mat4_trace(mat4 m);
@@ -105,6 +130,14 @@ CGLM_EXPORT
 void
 glmc_mat4_inv_fast(mat4 mat, mat4 dest);
 
+CGLM_EXPORT
+void
+glmc_mat4_inv_batch(mat4 *mat, mat4 *dest, size_t count);
+
+CGLM_EXPORT
+void
+glmc_mat4_inv_batch_soa(float *src[16], float *dest[16], size_t count);
+
 CGLM_EXPORT
 void
 glmc_mat4_swap_col(mat4 mat, int col1, int col2);
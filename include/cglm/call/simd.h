@@ -0,0 +1,60 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+/*
+ The hot glmc_ functions (mat4 mul, mulv, det, inv and the batch kernels)
+ go through a table of kernels chosen once at load time, from what the
+ CPU supports, so that a single build of the library uses AVX where
+ it's there without faulting where it isn't.
+
+ Setting the CGLM_SIMD environment variable to one of the names below
+ caps the level used, e.g. CGLM_SIMD=sse2.
+ */
+
+#ifndef cglmc_simd_h
+#define cglmc_simd_h
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "../cglm.h"
+
+/* in order, each x86 level needing the ones before it */
+typedef enum glmc_simd_level {
+  CGLM_SIMD_SCALAR = 0,
+  CGLM_SIMD_NEON   = 1,
+  CGLM_SIMD_SSE2   = 2,
+  CGLM_SIMD_SSE41  = 3,
+  CGLM_SIMD_AVX    = 4,
+  CGLM_SIMD_AVX2   = 5, /* AVX2 and FMA */
+  CGLM_SIMD_AVX512 = 6
+} glmc_simd_level;
+
+/* best level the CPU and the OS support */
+CGLM_EXPORT
+glmc_simd_level
+glmc_simd_cpu(void);
+
+/* level of the kernels in use */
+CGLM_EXPORT
+glmc_simd_level
+glmc_simd_get(void);
+
+/* use the best kernels up to level that the CPU can run.
+   returns the level of the ones chosen */
+CGLM_EXPORT
+glmc_simd_level
+glmc_simd_set(glmc_simd_level level);
+
+CGLM_EXPORT
+const char *
+glmc_simd_name(glmc_simd_level level);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* cglmc_simd_h */
@@ -33,4 +33,18 @@ CGLM_EXPORT
 bool
 glmc_sphere_point(vec4 s, vec3 point);
 
+CGLM_EXPORT
+bool
+glmc_sphere_frustum(vec4 s, vec4 planes[6]);
+
+CGLM_EXPORT
+void
+glmc_sphere_frustum_soa(float *s[4], vec4 planes[6], uint32_t *mask,
+                        size_t count);
+
+CGLM_EXPORT
+size_t
+glmc_sphere_frustum_soa_index(float *s[4], vec4 planes[6], uint32_t *indices,
+                              size_t count);
+
 #endif /* cglmc_sphere_h */
@@ -10,6 +10,7 @@
 
 #define _USE_MATH_DEFINES /* for windows */
 
+#include <stddef.h>
 #include <stdint.h>
 #include <math.h>
 #include <float.h>
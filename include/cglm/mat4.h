@@ -27,8 +27,14 @@
    CGLM_INLINE void  glm_mat4_ins3(mat3 mat, mat4 dest);
    CGLM_INLINE void  glm_mat4_mul(mat4 m1, mat4 m2, mat4 dest);
    CGLM_INLINE void  glm_mat4_mulN(mat4 *matrices[], int len, mat4 dest);
+   CGLM_INLINE void  glm_mat4_mul_batch(mat4 *a, mat4 *b, mat4 *dest, size_t count);
+   CGLM_INLINE void  glm_mat4_mul_batch_stream(mat4 *a, mat4 *b, mat4 *dest, size_t count);
    CGLM_INLINE void  glm_mat4_mulv(mat4 m, vec4 v, vec4 dest);
    CGLM_INLINE void  glm_mat4_mulv3(mat4 m, vec3 v, vec3 dest);
+   CGLM_INLINE void  glm_mat4_mulv_batch(mat4 m, vec4 *v, vec4 *dest, size_t count);
+   CGLM_INLINE void  glm_mat4_mulv3_batch(mat4 m, vec3 *v, float last, vec3 *dest, size_t count);
+   CGLM_INLINE void  glm_mat4_mulv_batch_soa(mat4 m, float *src[4], float *dest[4], size_t count);
+   CGLM_INLINE void  glm_mat4_mulv3_batch_soa(mat4 m, float *src[3], float last, float *dest[3], size_t count);
    CGLM_INLINE float glm_mat4_trace(mat4 m);
    CGLM_INLINE float glm_mat4_trace3(mat4 m);
    CGLM_INLINE void  glm_mat4_transpose_to(mat4 m, mat4 dest);
@@ -38,6 +44,8 @@
    CGLM_INLINE float glm_mat4_det(mat4 mat);
    CGLM_INLINE void  glm_mat4_inv(mat4 mat, mat4 dest);
    CGLM_INLINE void  glm_mat4_inv_fast(mat4 mat, mat4 dest);
+   CGLM_INLINE void  glm_mat4_inv_batch(mat4 *mat, mat4 *dest, size_t count);
+   CGLM_INLINE void  glm_mat4_inv_batch_soa(float *src[16], float *dest[16], size_t count);
    CGLM_INLINE void  glm_mat4_swap_col(mat4 mat, int col1, int col2);
    CGLM_INLINE void  glm_mat4_swap_row(mat4 mat, int row1, int row2);
  */
@@ -318,6 +326,59 @@ glm_mat4_mulN(mat4 * __restrict matrices[], uint32_t len, mat4 dest) {
     glm_mat4_mul(dest, *matrices[i], dest);
 }
 
+/*!
+ * @brief multiply arrays of matrices pairwise: dest[i] = a[i] * b[i]
+ *
+ * e.g. parent world matrices by local ones for a whole hierarchy,
+ * or bind poses by bone transforms for a skinning palette.
+ * With FMA each element takes one rounding instead of four,
+ * so results may differ from glm_mat4_mul in the last bit
+ *
+ * @param[in]  a     left matrices
+ * @param[in]  b     right matrices
+ * @param[out] dest  result matrices, can be a or b
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_mul_batch(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+#if defined( __AVX__ ) && defined( __FMA__ )
+  glm_mat4_mul_batch_fma(a, b, dest, count);
+#elif defined( __AVX__ )
+  glm_mat4_mul_batch_avx(a, b, dest, count);
+#else
+  size_t i;
+  for (i = 0; i < count; i++)
+    glm_mat4_mul(a[i], b[i], dest[i]);
+#endif
+}
+
+/*!
+ * @brief same as glm_mat4_mul_batch, but written with non-temporal stores
+ *
+ * the results go to memory without being read into the cache first,
+ * which saves bandwidth when the output is much bigger than the cache
+ * and isn't read back right away. Slower for small outputs
+ *
+ * @param[in]  a     left matrices
+ * @param[in]  b     right matrices
+ * @param[out] dest  result matrices, can be a or b
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_mul_batch_stream(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+#if defined( __AVX__ ) && defined( __FMA__ )
+  glm_mat4_mul_batch_stream_fma(a, b, dest, count);
+#elif defined( __AVX__ )
+  glm_mat4_mul_batch_stream_avx(a, b, dest, count);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
+  glm_mat4_mul_batch_stream_sse2(a, b, dest, count);
+#else
+  glm_mat4_mul_batch(a, b, dest, count);
+#endif
+}
+
 /*!
  * @brief multiply mat4 with vec4 (column vector) and store in dest vector
  *
@@ -432,6 +493,133 @@ glm_mat4_mulv3(mat4 m, vec3 v, float last, vec3 dest) {
   glm_vec3(res, dest);
 }
 
+/*!
+ * @brief multiply many vec4 (column vectors) by the same mat4
+ *
+ * same as calling glm_mat4_mulv for each of them, but with the matrix
+ * kept in registers and, with AVX, two vectors at a time.
+ * vectors don't need to be aligned
+ *
+ * it is not several times faster than the loop: glm_mat4_mulv already
+ * fills a register per vector, and with arrays larger than the cache
+ * both are bound by memory bandwidth. glm_mat4_mulv3_batch and the
+ * SoA versions are the ones to use for speed (see bench/mat4_mulv_batch.c)
+ *
+ * @param[in]  m     mat4 (left)
+ * @param[in]  v     array of vec4
+ * @param[out] dest  array of vec4, can be v
+ * @param[in]  count number of vectors
+ */
+CGLM_INLINE
+void
+glm_mat4_mulv_batch(mat4 m, vec4 *v, vec4 *dest, size_t count) {
+#if defined( __AVX__ )
+  glm_mat4_mulv_batch_avx(m, v, dest, count);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
+  glm_mat4_mulv_batch_sse2(m, v, dest, count);
+#elif defined( CGLM_NEON_FP )
+  glm_mat4_mulv_batch_neon(m, v, dest, count);
+#else
+  size_t i;
+  for (i = 0; i < count; i++)
+    glm_mat4_mulv(m, v[i], dest[i]);
+#endif
+}
+
+/*!
+ * @brief multiply many vec3 by the same mat4, as glm_mat4_mulv3 does
+ *
+ * vectors are regrouped into x, y and z registers four
+ * (eight with AVX) at a time, so no lane is wasted on w
+ *
+ * @param[in]  m     mat4 (left)
+ * @param[in]  v     array of vec3
+ * @param[in]  last  4th item of every vector
+ * @param[out] dest  array of vec3, can be v
+ * @param[in]  count number of vectors
+ */
+CGLM_INLINE
+void
+glm_mat4_mulv3_batch(mat4 m, vec3 *v, float last, vec3 *dest, size_t count) {
+#if defined( __AVX__ )
+  glm_mat4_mulv3_batch_avx(m, v, last, dest, count);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
+  glm_mat4_mulv3_batch_sse2(m, v, last, dest, count);
+#elif defined( CGLM_NEON_FP )
+  glm_mat4_mulv3_batch_neon(m, v, last, dest, count);
+#else
+  size_t i;
+  for (i = 0; i < count; i++)
+    glm_mat4_mulv3(m, v[i], last, dest[i]);
+#endif
+}
+
+/*!
+ * @brief multiply many vec4 stored as separate x, y, z and w arrays
+ *        by the same mat4 (structure of arrays)
+ *
+ * the fastest layout: each register holds the same component
+ * of four (eight with AVX) vectors, with no shuffling at all
+ *
+ * @param[in]  m     mat4 (left)
+ * @param[in]  src   x, y, z and w arrays
+ * @param[out] dest  x, y, z and w arrays, can be the same as src
+ * @param[in]  count number of vectors
+ */
+CGLM_INLINE
+void
+glm_mat4_mulv_batch_soa(mat4 m, float *src[4], float *dest[4], size_t count) {
+#if defined( __AVX__ )
+  glm_mat4_mulv_batch_soa_avx(m, src, dest, count);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
+  glm_mat4_mulv_batch_soa_sse2(m, src, dest, count);
+#elif defined( CGLM_NEON_FP )
+  glm_mat4_mulv_batch_soa_neon(m, src, dest, count);
+#else
+  float  x, y, z, w;
+  size_t i;
+  for (i = 0; i < count; i++) {
+    x = src[0][i]; y = src[1][i]; z = src[2][i]; w = src[3][i];
+    dest[0][i] = m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0] * w;
+    dest[1][i] = m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1] * w;
+    dest[2][i] = m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2] * w;
+    dest[3][i] = m[0][3] * x + m[1][3] * y + m[2][3] * z + m[3][3] * w;
+  }
+#endif
+}
+
+/*!
+ * @brief multiply many vec3 stored as separate x, y and z arrays
+ *        by the same mat4, as glm_mat4_mulv3 does (structure of arrays)
+ *
+ * @param[in]  m     mat4 (left)
+ * @param[in]  src   x, y and z arrays
+ * @param[in]  last  4th item of every vector
+ * @param[out] dest  x, y and z arrays, can be the same as src
+ * @param[in]  count number of vectors
+ */
+CGLM_INLINE
+void
+glm_mat4_mulv3_batch_soa(mat4 m, float *src[3], float last, float *dest[3],
+                         size_t count) {
+#if defined( __AVX__ )
+  glm_mat4_mulv3_batch_soa_avx(m, src, last, dest, count);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
+  glm_mat4_mulv3_batch_soa_sse2(m, src, last, dest, count);
+#elif defined( CGLM_NEON_FP )
+  glm_mat4_mulv3_batch_soa_neon(m, src, last, dest, count);
+#else
+  float  x, y, z;
+  size_t i;
+  for (i = 0; i < count; i++) {
+    x = src[0][i]; y = src[1][i]; z = src[2][i];
+    dest[0][i] = m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0] * last;
+    dest[1][i] = m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1] * last;
+    dest[2][i] = m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2] * last;
+  }
+#endif
+}
+
 /*!
  * @brief transpose mat4 and store in dest
  *
@@ -521,7 +709,9 @@ glm_mat4_scale(mat4 m, float s) {
 CGLM_INLINE
 float
 glm_mat4_det(mat4 mat) {
-#if defined( __SSE__ ) || defined( __SSE2__ )
+#if defined( __AVX__ ) && defined( __FMA__ )
+  return glm_mat4_det_fma(mat);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
   return glm_mat4_det_sse2(mat);
 #else
   /* [square] det(A) = det(At) */
@@ -554,7 +744,9 @@ glm_mat4_det(mat4 mat) {
 CGLM_INLINE
 void
 glm_mat4_inv(mat4 mat, mat4 dest) {
-#if defined( __SSE__ ) || defined( __SSE2__ )
+#if defined( __AVX__ ) && defined( __FMA__ )
+  glm_mat4_inv_fma(mat, dest);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
   glm_mat4_inv_sse2(mat, dest);
 #else
   float t[6];
@@ -615,13 +807,71 @@ glm_mat4_inv(mat4 mat, mat4 dest) {
 CGLM_INLINE
 void
 glm_mat4_inv_fast(mat4 mat, mat4 dest) {
-#if defined( __SSE__ ) || defined( __SSE2__ )
+#if defined( __AVX__ ) && defined( __FMA__ )
+  glm_mat4_inv_fast_fma(mat, dest);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
   glm_mat4_inv_fast_sse2(mat, dest);
 #else
   glm_mat4_inv(mat, dest);
 #endif
 }
 
+/*!
+ * @brief inverse an array of matrices: dest[i] = inverse(mat[i])
+ *
+ * e.g. inverse model matrices, or normal matrices when followed by a
+ * transpose. With AVX and FMA eight matrices are inverted at once,
+ * one per lane, after an in-register transpose
+ *
+ * @param[in]  mat   matrices
+ * @param[out] dest  inverse matrices, can be mat
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_inv_batch(mat4 *mat, mat4 *dest, size_t count) {
+#if defined( __AVX__ ) && defined( __FMA__ )
+  glm_mat4_inv_batch_fma(mat, dest, count);
+#else
+  size_t i;
+  for (i = 0; i < count; i++)
+    glm_mat4_inv(mat[i], dest[i]);
+#endif
+}
+
+/*!
+ * @brief inverse matrices stored as structure of arrays
+ *
+ * src[e] is the array of element e of every matrix, column-major as in
+ * mat[e / 4][e % 4]. With AVX and FMA eight matrices are inverted per
+ * iteration with no shuffling at all
+ *
+ * @param[in]  src   16 element arrays
+ * @param[out] dest  16 element arrays for the inverses, can be src
+ * @param[in]  count number of matrices
+ */
+CGLM_INLINE
+void
+glm_mat4_inv_batch_soa(float *src[16], float *dest[16], size_t count) {
+#if defined( __AVX__ ) && defined( __FMA__ )
+  glm_mat4_inv_batch_soa_fma(src, dest, count);
+#else
+  CGLM_ALIGN_MAT mat4 t;
+  size_t i;
+  int    x;
+
+  for (i = 0; i < count; i++) {
+    for (x = 0; x < 16; x++)
+      t[x / 4][x % 4] = src[x][i];
+
+    glm_mat4_inv(t, t);
+
+    for (x = 0; x < 16; x++)
+      dest[x][i] = t[x / 4][x % 4];
+  }
+#endif
+}
+
 /*!
  * @brief swap two matrix columns
  *
@@ -62,5 +62,33 @@ glm_mul_avx(mat4 m1, mat4 m2, mat4 dest) {
                                             _mm256_mul_ps(y5, y9))));
 }
 
+#ifdef __FMA__
+
+CGLM_INLINE
+void
+glm_inv_tr_fma(mat4 mat) {
+  __m128 r0, r1, r2, r3, x0;
+
+  r0 = glmm_load(mat[0]);
+  r1 = glmm_load(mat[1]);
+  r2 = glmm_load(mat[2]);
+  r3 = glmm_load(mat[3]);
+  x0 = _mm_set_ps(1.0f, 0.0f, 0.0f, 0.0f);
+
+  _MM_TRANSPOSE4_PS(r0, r1, r2, x0);
+
+  /* w - R^T * t, with the negation folded into the fused products */
+  x0 = _mm_fnmadd_ps(r0, glmm_shuff1(r3, 0, 0, 0, 0), x0);
+  x0 = _mm_fnmadd_ps(r1, glmm_shuff1(r3, 1, 1, 1, 1), x0);
+  x0 = _mm_fnmadd_ps(r2, glmm_shuff1(r3, 2, 2, 2, 2), x0);
+
+  glmm_store(mat[0], r0);
+  glmm_store(mat[1], r1);
+  glmm_store(mat[2], r2);
+  glmm_store(mat[3], x0);
+}
+
+#endif
+
 #endif
 #endif /* cglm_affine_mat_avx_h */
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_box_avx_h
+#define cglm_box_avx_h
+#ifdef __AVX__
+
+#include "../../common.h"
+#include "../intrin.h"
+
+#include <immintrin.h>
+
+/*
+ * eight boxes at a time, one per lane. a box is outside a plane when its
+ * center is further behind it than its extent projected on the normal:
+ *   dot(n, c) + w + dot(|n|, e) < 0
+ */
+CGLM_INLINE
+void
+glm_aabb_frustum_soa_avx(float *center[3], float *extent[3],
+                         vec4 planes[6], uint32_t *mask, size_t count) {
+  __m256 p[6][7], cx, cy, cz, ex, ey, ez, d, out;
+  float *scx, *scy, *scz, *sex, *sey, *sez, *pl, dp;
+  uint32_t w;
+  size_t   i;
+  int      k;
+
+  /* n.x n.y n.z w |n.x| |n.y| |n.z|, splatted */
+  for (k = 0; k < 6; k++) {
+    pl = planes[k];
+    p[k][0] = _mm256_set1_ps(pl[0]);
+    p[k][1] = _mm256_set1_ps(pl[1]);
+    p[k][2] = _mm256_set1_ps(pl[2]);
+    p[k][3] = _mm256_set1_ps(pl[3]);
+    p[k][4] = _mm256_set1_ps(fabsf(pl[0]));
+    p[k][5] = _mm256_set1_ps(fabsf(pl[1]));
+    p[k][6] = _mm256_set1_ps(fabsf(pl[2]));
+  }
+
+  /* kept in registers, as the mask stores could alias the arrays */
+  scx = center[0]; scy = center[1]; scz = center[2];
+  sex = extent[0]; sey = extent[1]; sez = extent[2];
+
+  w = 0;
+  for (i = 0; i + 8 <= count; i += 8) {
+    cx = _mm256_loadu_ps(scx + i);
+    cy = _mm256_loadu_ps(scy + i);
+    cz = _mm256_loadu_ps(scz + i);
+    ex = _mm256_loadu_ps(sex + i);
+    ey = _mm256_loadu_ps(sey + i);
+    ez = _mm256_loadu_ps(sez + i);
+
+    out = _mm256_setzero_ps();
+    for (k = 0; k < 6; k++) {
+      d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(p[k][0], cx),
+                                      _mm256_mul_ps(p[k][1], cy)),
+                        _mm256_add_ps(_mm256_mul_ps(p[k][2], cz), p[k][3]));
+      d = _mm256_add_ps(d,
+                        _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(p[k][4], ex),
+                                                    _mm256_mul_ps(p[k][5], ey)),
+                                      _mm256_mul_ps(p[k][6], ez)));
+      out = _mm256_or_ps(out, _mm256_cmp_ps(d, _mm256_setzero_ps(),
+                                            _CMP_LT_OQ));
+    }
+
+    w |= (uint32_t)(~_mm256_movemask_ps(out) & 0xFF) << (i & 31);
+
+    if (((i + 8) & 31) == 0) {
+      mask[i >> 5] = w;
+      w = 0;
+    }
+  }
+
+  for (; i < count; i++) {
+    for (k = 0; k < 6; k++) {
+      pl = planes[k];
+      dp = pl[0] * scx[i] + pl[1] * scy[i] + pl[2] * scz[i] + pl[3]
+         + fabsf(pl[0]) * sex[i] + fabsf(pl[1]) * sey[i]
+         + fabsf(pl[2]) * sez[i];
+
+      if (dp < 0.0f)
+        break;
+    }
+
+    w |= (uint32_t)(k == 6) << (i & 31);
+  }
+
+  if (count & 31)
+    mask[count >> 5] = w;
+}
+
+#endif
+#endif /* cglm_box_avx_h */
@@ -11,6 +11,7 @@
 
 #include "../../common.h"
 #include "../intrin.h"
+#include "../sse2/mat4.h"
 
 #include <immintrin.h>
 
@@ -62,5 +63,689 @@ glm_mat4_mul_avx(mat4 m1, mat4 m2, mat4 dest) {
                                             _mm256_mul_ps(y5, y9))));
 }
 
+/*
+ * batch transforms, eight floats at a time.
+ * what is left over goes through the sse2 versions
+ */
+
+CGLM_INLINE
+void
+glm_mat4_mulv_batch_avx(mat4 m, vec4 *v, vec4 *dest, size_t count) {
+  __m256 c0, c1, c2, c3, y0;
+  size_t i;
+
+  /* columns repeated in both lanes, a vector in each lane */
+  c0 = _mm256_broadcast_ps((__m128 *)m[0]);
+  c1 = _mm256_broadcast_ps((__m128 *)m[1]);
+  c2 = _mm256_broadcast_ps((__m128 *)m[2]);
+  c3 = _mm256_broadcast_ps((__m128 *)m[3]);
+
+  for (i = 0; i + 2 <= count; i += 2) {
+    y0 = _mm256_loadu_ps(v[i]);
+    _mm256_storeu_ps(dest[i],
+                     _mm256_add_ps(
+                       _mm256_add_ps(
+                         _mm256_mul_ps(c0, _mm256_permute_ps(y0, 0x00)),
+                         _mm256_mul_ps(c1, _mm256_permute_ps(y0, 0x55))),
+                       _mm256_add_ps(
+                         _mm256_mul_ps(c2, _mm256_permute_ps(y0, 0xAA)),
+                         _mm256_mul_ps(c3, _mm256_permute_ps(y0, 0xFF)))));
+  }
+
+  glm_mat4_mulv_batch_sse2(m, v + i, dest + i, count - i);
+}
+
+CGLM_INLINE
+void
+glm_mat4_mulv3_batch_avx(mat4 m, vec3 *v, float last, vec3 *dest,
+                         size_t count) {
+  __m256 m00, m01, m02, m10, m11, m12, m20, m21, m22, t0, t1, t2;
+  __m256 a, b, c, x, y, z, s0, s1;
+  float *src, *dst;
+  size_t i;
+
+  m00 = _mm256_set1_ps(m[0][0]); m01 = _mm256_set1_ps(m[0][1]);
+  m02 = _mm256_set1_ps(m[0][2]); m10 = _mm256_set1_ps(m[1][0]);
+  m11 = _mm256_set1_ps(m[1][1]); m12 = _mm256_set1_ps(m[1][2]);
+  m20 = _mm256_set1_ps(m[2][0]); m21 = _mm256_set1_ps(m[2][1]);
+  m22 = _mm256_set1_ps(m[2][2]);
+
+  t0 = _mm256_set1_ps(m[3][0] * last);
+  t1 = _mm256_set1_ps(m[3][1] * last);
+  t2 = _mm256_set1_ps(m[3][2] * last);
+
+  src = v[0];
+  dst = dest[0];
+
+  /* vectors 0-3 in the low lane and 4-7 in the high one,
+     so that the in-lane shuffles of the sse2 version do the rest */
+  for (i = 0; i + 8 <= count; i += 8, src += 24, dst += 24) {
+    a = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src)),
+                             _mm_loadu_ps(src + 12), 1);
+    b = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 4)),
+                             _mm_loadu_ps(src + 16), 1);
+    c = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(src + 8)),
+                             _mm_loadu_ps(src + 20), 1);
+
+    s0 = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2));
+    s1 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));
+    x  = _mm256_shuffle_ps(a,  s0, _MM_SHUFFLE(2, 0, 3, 0));
+    y  = _mm256_shuffle_ps(s1, s0, _MM_SHUFFLE(3, 1, 2, 0));
+    z  = _mm256_shuffle_ps(s1, c,  _MM_SHUFFLE(3, 0, 3, 1));
+
+    a = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x),
+                                    _mm256_mul_ps(m10, y)),
+                      _mm256_add_ps(_mm256_mul_ps(m20, z), t0));
+    b = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, x),
+                                    _mm256_mul_ps(m11, y)),
+                      _mm256_add_ps(_mm256_mul_ps(m21, z), t1));
+    c = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, x),
+                                    _mm256_mul_ps(m12, y)),
+                      _mm256_add_ps(_mm256_mul_ps(m22, z), t2));
+
+    s0 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 0));
+    s1 = _mm256_shuffle_ps(c, a, _MM_SHUFFLE(1, 1, 0, 0));
+    x  = _mm256_shuffle_ps(s0, s1, _MM_SHUFFLE(2, 0, 2, 0));
+
+    s0 = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 1, 1));
+    s1 = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 2, 2, 2));
+    y  = _mm256_shuffle_ps(s0, s1, _MM_SHUFFLE(2, 0, 2, 0));
+
+    s0 = _mm256_shuffle_ps(c, a, _MM_SHUFFLE(3, 3, 2, 2));
+    s1 = _mm256_shuffle_ps(b, c, _MM_SHUFFLE(3, 3, 3, 3));
+    z  = _mm256_shuffle_ps(s0, s1, _MM_SHUFFLE(2, 0, 2, 0));
+
+    _mm_storeu_ps(dst,      _mm256_castps256_ps128(x));
+    _mm_storeu_ps(dst + 4,  _mm256_castps256_ps128(y));
+    _mm_storeu_ps(dst + 8,  _mm256_castps256_ps128(z));
+    _mm_storeu_ps(dst + 12, _mm256_extractf128_ps(x, 1));
+    _mm_storeu_ps(dst + 16, _mm256_extractf128_ps(y, 1));
+    _mm_storeu_ps(dst + 20, _mm256_extractf128_ps(z, 1));
+  }
+
+  glm_mat4_mulv3_batch_sse2(m, v + i, last, dest + i, count - i);
+}
+
+CGLM_INLINE
+void
+glm_mat4_mulv_batch_soa_avx(mat4 m, float *src[4], float *dest[4],
+                            size_t count) {
+  __m256 m00, m01, m02, m03, m10, m11, m12, m13,
+         m20, m21, m22, m23, m30, m31, m32, m33;
+  __m256 x, y, z, w, r0, r1, r2, r3;
+  float *srcLeft[4], *destLeft[4];
+  float *sx, *sy, *sz, *sw, *dx, *dy, *dz, *dw;
+  size_t i;
+
+  m00 = _mm256_set1_ps(m[0][0]); m01 = _mm256_set1_ps(m[0][1]);
+  m02 = _mm256_set1_ps(m[0][2]); m03 = _mm256_set1_ps(m[0][3]);
+  m10 = _mm256_set1_ps(m[1][0]); m11 = _mm256_set1_ps(m[1][1]);
+  m12 = _mm256_set1_ps(m[1][2]); m13 = _mm256_set1_ps(m[1][3]);
+  m20 = _mm256_set1_ps(m[2][0]); m21 = _mm256_set1_ps(m[2][1]);
+  m22 = _mm256_set1_ps(m[2][2]); m23 = _mm256_set1_ps(m[2][3]);
+  m30 = _mm256_set1_ps(m[3][0]); m31 = _mm256_set1_ps(m[3][1]);
+  m32 = _mm256_set1_ps(m[3][2]); m33 = _mm256_set1_ps(m[3][3]);
+
+  /* kept in registers, as the vector stores could alias the arrays */
+  sx = src[0]; sy = src[1]; sz = src[2]; sw = src[3];
+  dx = dest[0]; dy = dest[1]; dz = dest[2]; dw = dest[3];
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    x = _mm256_loadu_ps(sx + i);
+    y = _mm256_loadu_ps(sy + i);
+    z = _mm256_loadu_ps(sz + i);
+    w = _mm256_loadu_ps(sw + i);
+
+    r0 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x),
+                                     _mm256_mul_ps(m10, y)),
+                       _mm256_add_ps(_mm256_mul_ps(m20, z),
+                                     _mm256_mul_ps(m30, w)));
+    r1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, x),
+                                     _mm256_mul_ps(m11, y)),
+                       _mm256_add_ps(_mm256_mul_ps(m21, z),
+                                     _mm256_mul_ps(m31, w)));
+    r2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, x),
+                                     _mm256_mul_ps(m12, y)),
+                       _mm256_add_ps(_mm256_mul_ps(m22, z),
+                                     _mm256_mul_ps(m32, w)));
+    r3 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m03, x),
+                                     _mm256_mul_ps(m13, y)),
+                       _mm256_add_ps(_mm256_mul_ps(m23, z),
+                                     _mm256_mul_ps(m33, w)));
+
+    _mm256_storeu_ps(dx + i, r0);
+    _mm256_storeu_ps(dy + i, r1);
+    _mm256_storeu_ps(dz + i, r2);
+    _mm256_storeu_ps(dw + i, r3);
+  }
+
+  srcLeft[0]  = sx + i; srcLeft[1]  = sy + i;
+  srcLeft[2]  = sz + i; srcLeft[3]  = sw + i;
+  destLeft[0] = dx + i; destLeft[1] = dy + i;
+  destLeft[2] = dz + i; destLeft[3] = dw + i;
+
+  glm_mat4_mulv_batch_soa_sse2(m, srcLeft, destLeft, count - i);
+}
+
+CGLM_INLINE
+void
+glm_mat4_mulv3_batch_soa_avx(mat4 m, float *src[3], float last,
+                             float *dest[3], size_t count) {
+  __m256 m00, m01, m02, m10, m11, m12, m20, m21, m22, t0, t1, t2;
+  __m256 x, y, z, r0, r1, r2;
+  float *srcLeft[3], *destLeft[3];
+  float *sx, *sy, *sz, *dx, *dy, *dz;
+  size_t i;
+
+  m00 = _mm256_set1_ps(m[0][0]); m01 = _mm256_set1_ps(m[0][1]);
+  m02 = _mm256_set1_ps(m[0][2]); m10 = _mm256_set1_ps(m[1][0]);
+  m11 = _mm256_set1_ps(m[1][1]); m12 = _mm256_set1_ps(m[1][2]);
+  m20 = _mm256_set1_ps(m[2][0]); m21 = _mm256_set1_ps(m[2][1]);
+  m22 = _mm256_set1_ps(m[2][2]);
+
+  t0 = _mm256_set1_ps(m[3][0] * last);
+  t1 = _mm256_set1_ps(m[3][1] * last);
+  t2 = _mm256_set1_ps(m[3][2] * last);
+
+  /* kept in registers, as the vector stores could alias the arrays */
+  sx = src[0]; sy = src[1]; sz = src[2];
+  dx = dest[0]; dy = dest[1]; dz = dest[2];
+
+  for (i = 0; i + 8 <= count; i += 8) {
+    x = _mm256_loadu_ps(sx + i);
+    y = _mm256_loadu_ps(sy + i);
+    z = _mm256_loadu_ps(sz + i);
+
+    r0 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m00, x),
+                                     _mm256_mul_ps(m10, y)),
+                       _mm256_add_ps(_mm256_mul_ps(m20, z), t0));
+    r1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m01, x),
+                                     _mm256_mul_ps(m11, y)),
+                       _mm256_add_ps(_mm256_mul_ps(m21, z), t1));
+    r2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(m02, x),
+                                     _mm256_mul_ps(m12, y)),
+                       _mm256_add_ps(_mm256_mul_ps(m22, z), t2));
+
+    _mm256_storeu_ps(dx + i, r0);
+    _mm256_storeu_ps(dy + i, r1);
+    _mm256_storeu_ps(dz + i, r2);
+  }
+
+  srcLeft[0]  = sx + i; srcLeft[1]  = sy + i;
+  srcLeft[2]  = sz + i;
+  destLeft[0] = dx + i; destLeft[1] = dy + i;
+  destLeft[2] = dz + i;
+
+  glm_mat4_mulv3_batch_soa_sse2(m, srcLeft, last, destLeft, count - i);
+}
+
+/*
+ * batch multiply, dest[i] = a[i] * b[i].
+ * each register holds a pair of destination columns: both lanes get
+ * the same column of a, and each lane the elements of its column of b.
+ * everything is loaded before storing, so dest may be a or b
+ */
+
+CGLM_INLINE
+void
+glm_mat4_mul_step_avx(mat4 a, mat4 b, __m256 *d01, __m256 *d23) {
+  __m256 l0, l1, l2, l3, r01, r23;
+
+  l0  = _mm256_broadcast_ps((__m128 *)a[0]);
+  l1  = _mm256_broadcast_ps((__m128 *)a[1]);
+  l2  = _mm256_broadcast_ps((__m128 *)a[2]);
+  l3  = _mm256_broadcast_ps((__m128 *)a[3]);
+  r01 = _mm256_loadu_ps(b[0]);
+  r23 = _mm256_loadu_ps(b[2]);
+
+  *d01 = _mm256_add_ps(
+           _mm256_add_ps(_mm256_mul_ps(l0, _mm256_permute_ps(r01, 0x00)),
+                         _mm256_mul_ps(l1, _mm256_permute_ps(r01, 0x55))),
+           _mm256_add_ps(_mm256_mul_ps(l2, _mm256_permute_ps(r01, 0xAA)),
+                         _mm256_mul_ps(l3, _mm256_permute_ps(r01, 0xFF))));
+  *d23 = _mm256_add_ps(
+           _mm256_add_ps(_mm256_mul_ps(l0, _mm256_permute_ps(r23, 0x00)),
+                         _mm256_mul_ps(l1, _mm256_permute_ps(r23, 0x55))),
+           _mm256_add_ps(_mm256_mul_ps(l2, _mm256_permute_ps(r23, 0xAA)),
+                         _mm256_mul_ps(l3, _mm256_permute_ps(r23, 0xFF))));
+}
+
+CGLM_INLINE
+void
+glm_mat4_mul_batch_avx(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+  __m256 d01, d23;
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    glm_mat4_mul_step_avx(a[i], b[i], &d01, &d23);
+    _mm256_storeu_ps(dest[i][0], d01);
+    _mm256_storeu_ps(dest[i][2], d23);
+  }
+}
+
+/* non-temporal stores, which skip the cache, for outputs too big to stay
+   in it. dest needs the 16 byte alignment of mat4, 32 to use AVX stores */
+CGLM_INLINE
+void
+glm_mat4_mul_batch_stream_avx(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+  __m256 d01, d23;
+  size_t i;
+
+  if ((uintptr_t)dest & 31) {
+    glm_mat4_mul_batch_stream_sse2(a, b, dest, count);
+    return;
+  }
+
+  for (i = 0; i < count; i++) {
+    glm_mat4_mul_step_avx(a[i], b[i], &d01, &d23);
+    _mm256_stream_ps(dest[i][0], d01);
+    _mm256_stream_ps(dest[i][2], d23);
+  }
+
+  _mm_sfence();
+}
+
+/* 8x8 transpose, r[i][j] <-> r[j][i] */
+CGLM_INLINE
+void
+glm_mat4_transp8_avx(__m256 r[8]) {
+  __m256 t0, t1, t2, t3, t4, t5, t6, t7;
+  __m256 s0, s1, s2, s3, s4, s5, s6, s7;
+
+  t0 = _mm256_unpacklo_ps(r[0], r[1]);
+  t1 = _mm256_unpackhi_ps(r[0], r[1]);
+  t2 = _mm256_unpacklo_ps(r[2], r[3]);
+  t3 = _mm256_unpackhi_ps(r[2], r[3]);
+  t4 = _mm256_unpacklo_ps(r[4], r[5]);
+  t5 = _mm256_unpackhi_ps(r[4], r[5]);
+  t6 = _mm256_unpacklo_ps(r[6], r[7]);
+  t7 = _mm256_unpackhi_ps(r[6], r[7]);
+
+  s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+  s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+  s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+  s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+  s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+  s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+  s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+  s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+  r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+  r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+  r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+  r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+  r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+  r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+  r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+  r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+#ifdef __FMA__
+
+/* same as glm_mat4_mul_step_avx, with one rounding per column element */
+CGLM_INLINE
+void
+glm_mat4_mul_step_fma(mat4 a, mat4 b, __m256 *d01, __m256 *d23) {
+  __m256 l0, l1, l2, l3, r01, r23;
+
+  l0  = _mm256_broadcast_ps((__m128 *)a[0]);
+  l1  = _mm256_broadcast_ps((__m128 *)a[1]);
+  l2  = _mm256_broadcast_ps((__m128 *)a[2]);
+  l3  = _mm256_broadcast_ps((__m128 *)a[3]);
+  r01 = _mm256_loadu_ps(b[0]);
+  r23 = _mm256_loadu_ps(b[2]);
+
+  *d01 = _mm256_mul_ps(l0, _mm256_permute_ps(r01, 0x00));
+  *d01 = _mm256_fmadd_ps(l1, _mm256_permute_ps(r01, 0x55), *d01);
+  *d01 = _mm256_fmadd_ps(l2, _mm256_permute_ps(r01, 0xAA), *d01);
+  *d01 = _mm256_fmadd_ps(l3, _mm256_permute_ps(r01, 0xFF), *d01);
+
+  *d23 = _mm256_mul_ps(l0, _mm256_permute_ps(r23, 0x00));
+  *d23 = _mm256_fmadd_ps(l1, _mm256_permute_ps(r23, 0x55), *d23);
+  *d23 = _mm256_fmadd_ps(l2, _mm256_permute_ps(r23, 0xAA), *d23);
+  *d23 = _mm256_fmadd_ps(l3, _mm256_permute_ps(r23, 0xFF), *d23);
+}
+
+CGLM_INLINE
+void
+glm_mat4_mul_batch_fma(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+  __m256 d01, d23;
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    glm_mat4_mul_step_fma(a[i], b[i], &d01, &d23);
+    _mm256_storeu_ps(dest[i][0], d01);
+    _mm256_storeu_ps(dest[i][2], d23);
+  }
+}
+
+CGLM_INLINE
+void
+glm_mat4_mul_batch_stream_fma(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+  __m256 d01, d23;
+  size_t i;
+
+  if ((uintptr_t)dest & 31) {
+    glm_mat4_mul_batch_stream_sse2(a, b, dest, count);
+    return;
+  }
+
+  for (i = 0; i < count; i++) {
+    glm_mat4_mul_step_fma(a[i], b[i], &d01, &d23);
+    _mm256_stream_ps(dest[i][0], d01);
+    _mm256_stream_ps(dest[i][2], d23);
+  }
+
+  _mm_sfence();
+}
+
+/* the cofactor matrix of mat, as glm_mat4_inv_sse2 builds it, with the
+   products fused. returns the determinant in every lane */
+CGLM_INLINE
+__m128
+glm_mat4_cofactors_fma(mat4 mat, __m128 *v0, __m128 *v1, __m128 *v2,
+                       __m128 *v3) {
+  __m128 r0, r1, r2, r3,
+         t0, t1, t2, t3, t4, t5,
+         x0, x1, x2, x3, x4, x5, x6, x7;
+
+  /* 127 <- 0 */
+  r0 = glmm_load(mat[0]); /* d c b a */
+  r1 = glmm_load(mat[1]); /* h g f e */
+  r2 = glmm_load(mat[2]); /* l k j i */
+  r3 = glmm_load(mat[3]); /* p o n m */
+
+  x0 = _mm_shuffle_ps(r2, r3, _MM_SHUFFLE(3, 2, 3, 2));  /* p o l k */
+  x1 = glmm_shuff1(x0, 1, 3, 3, 3);                      /* l p p p */
+  x2 = glmm_shuff1(x0, 0, 2, 2, 2);                      /* k o o o */
+  x0 = _mm_shuffle_ps(r2, r1, _MM_SHUFFLE(3, 3, 3, 3));  /* h h l l */
+  x3 = _mm_shuffle_ps(r2, r1, _MM_SHUFFLE(2, 2, 2, 2));  /* g g k k */
+  x4 = _mm_shuffle_ps(r2, r3, _MM_SHUFFLE(2, 1, 2, 1));  /* o n k j */
+  x4 = glmm_shuff1(x4, 0, 2, 2, 2);                      /* j n n n */
+  x5 = _mm_shuffle_ps(r2, r1, _MM_SHUFFLE(1, 1, 1, 1));  /* f f j j */
+  x6 = _mm_shuffle_ps(r2, r1, _MM_SHUFFLE(0, 0, 0, 0));  /* e e i i */
+  x7 = glmm_shuff2(r3, r2, 0, 0, 0, 0, 2, 0, 0, 0);      /* i m m m */
+
+  /* see glm_mat4_inv_sse2 for the terms */
+  t0 = _mm_fmsub_ps(x3, x1, _mm_mul_ps(x2, x0));
+  t1 = _mm_fmsub_ps(x5, x1, _mm_mul_ps(x4, x0));
+  t2 = _mm_fmsub_ps(x5, x2, _mm_mul_ps(x4, x3));
+  t3 = _mm_fmsub_ps(x6, x1, _mm_mul_ps(x7, x0));
+  t4 = _mm_fmsub_ps(x6, x2, _mm_mul_ps(x7, x3));
+  t5 = _mm_fmsub_ps(x6, x4, _mm_mul_ps(x7, x5));
+
+  x0 = glmm_shuff2(r1, r0, 0, 0, 0, 0, 2, 2, 2, 0); /* a a a e */
+  x1 = glmm_shuff2(r1, r0, 1, 1, 1, 1, 2, 2, 2, 0); /* b b b f */
+  x2 = glmm_shuff2(r1, r0, 2, 2, 2, 2, 2, 2, 2, 0); /* c c c g */
+  x3 = glmm_shuff2(r1, r0, 3, 3, 3, 3, 2, 2, 2, 0); /* d d d h */
+
+  *v0 = _mm_fmadd_ps(x3, t2, _mm_fmsub_ps(x1, t0, _mm_mul_ps(x2, t1)));
+  *v0 = _mm_xor_ps(*v0, _mm_set_ps(-0.f, 0.f, -0.f, 0.f));
+
+  *v1 = _mm_fmadd_ps(x3, t4, _mm_fmsub_ps(x0, t0, _mm_mul_ps(x2, t3)));
+  *v1 = _mm_xor_ps(*v1, _mm_set_ps(0.f, -0.f, 0.f, -0.f));
+
+  *v2 = _mm_fmadd_ps(x3, t5, _mm_fmsub_ps(x0, t1, _mm_mul_ps(x1, t3)));
+  *v2 = _mm_xor_ps(*v2, _mm_set_ps(-0.f, 0.f, -0.f, 0.f));
+
+  *v3 = _mm_fmadd_ps(x2, t5, _mm_fmsub_ps(x0, t2, _mm_mul_ps(x1, t4)));
+  *v3 = _mm_xor_ps(*v3, _mm_set_ps(0.f, -0.f, 0.f, -0.f));
+
+  /* determinant */
+  x0 = _mm_shuffle_ps(*v0, *v1, _MM_SHUFFLE(0, 0, 0, 0));
+  x1 = _mm_shuffle_ps(*v2, *v3, _MM_SHUFFLE(0, 0, 0, 0));
+  x0 = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+
+  x0 = _mm_mul_ps(x0, r0);
+  x0 = _mm_add_ps(x0, glmm_shuff1(x0, 0, 1, 2, 3));
+  return _mm_add_ps(x0, glmm_shuff1(x0, 1, 0, 0, 1));
+}
+
+CGLM_INLINE
+float
+glm_mat4_det_fma(mat4 mat) {
+  __m128 r0, r1, r2, r3, x0, x1, x2;
+
+  /* 127 <- 0, [square] det(A) = det(At) */
+  r0 = glmm_load(mat[0]); /* d c b a */
+  r1 = glmm_load(mat[1]); /* h g f e */
+  r2 = glmm_load(mat[2]); /* l k j i */
+  r3 = glmm_load(mat[3]); /* p o n m */
+
+  /* t[1] t[2] t[3] t[4], see glm_mat4_det_sse2 */
+  x0 = _mm_fmsub_ps(glmm_shuff1(r2, 0, 0, 1, 1),
+                    glmm_shuff1(r3, 2, 3, 2, 3),
+                    _mm_mul_ps(glmm_shuff1(r3, 0, 0, 1, 1),
+                               glmm_shuff1(r2, 2, 3, 2, 3)));
+  /* t[0] t[0] t[5] t[5] */
+  x1 = _mm_fmsub_ps(glmm_shuff1(r2, 0, 0, 2, 2),
+                    glmm_shuff1(r3, 1, 1, 3, 3),
+                    _mm_mul_ps(glmm_shuff1(r3, 0, 0, 2, 2),
+                               glmm_shuff1(r2, 1, 1, 3, 3)));
+
+  x2 = _mm_fmsub_ps(glmm_shuff1(r1, 0, 0, 0, 1),
+                    _mm_shuffle_ps(x1, x0, _MM_SHUFFLE(1, 0, 0, 0)),
+                    _mm_mul_ps(glmm_shuff1(r1, 1, 1, 2, 2),
+                               glmm_shuff1(x0, 3, 2, 2, 0)));
+  x2 = _mm_fmadd_ps(glmm_shuff1(r1, 2, 3, 3, 3),
+                    _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 2, 3, 1)),
+                    x2);
+  x2 = _mm_xor_ps(x2, _mm_set_ps(-0.f, 0.f, -0.f, 0.f));
+
+  x0 = _mm_mul_ps(r0, x2);
+  x0 = _mm_add_ps(x0, glmm_shuff1(x0, 0, 1, 2, 3));
+  x0 = _mm_add_ps(x0, glmm_shuff1(x0, 1, 3, 3, 1));
+
+  return _mm_cvtss_f32(x0);
+}
+
+CGLM_INLINE
+void
+glm_mat4_inv_fast_fma(mat4 mat, mat4 dest) {
+  __m128 v0, v1, v2, v3, x0;
+
+  x0 = _mm_rcp_ps(glm_mat4_cofactors_fma(mat, &v0, &v1, &v2, &v3));
+
+  glmm_store(dest[0], _mm_mul_ps(v0, x0));
+  glmm_store(dest[1], _mm_mul_ps(v1, x0));
+  glmm_store(dest[2], _mm_mul_ps(v2, x0));
+  glmm_store(dest[3], _mm_mul_ps(v3, x0));
+}
+
+CGLM_INLINE
+void
+glm_mat4_inv_fma(mat4 mat, mat4 dest) {
+  __m128 v0, v1, v2, v3, x0;
+
+  x0 = glm_mat4_cofactors_fma(mat, &v0, &v1, &v2, &v3);
+  x0 = _mm_div_ps(_mm_set1_ps(1.0f), x0);
+
+  glmm_store(dest[0], _mm_mul_ps(v0, x0));
+  glmm_store(dest[1], _mm_mul_ps(v1, x0));
+  glmm_store(dest[2], _mm_mul_ps(v2, x0));
+  glmm_store(dest[3], _mm_mul_ps(v3, x0));
+}
+
+/*
+ * eight inverses at a time. src[e] holds element e (column-major, as in
+ * mat[e / 4][e % 4]) of eight matrices, one per lane, and dest is laid out
+ * the same way. this is the scalar glm_mat4_inv with one lane per matrix,
+ * so there is no shuffling at all. dest may be src
+ */
+CGLM_INLINE
+void
+glm_mat4_inv8_fma(__m256 src[16], __m256 dest[16]) {
+  __m256 t0, t1, t2, t3, t4, t5, c0, c1, c2, c3, det;
+  __m256 a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p;
+
+  a = src[0];  b = src[1];  c = src[2];  d = src[3];
+  e = src[4];  f = src[5];  g = src[6];  h = src[7];
+  i = src[8];  j = src[9];  k = src[10]; l = src[11];
+  m = src[12]; n = src[13]; o = src[14]; p = src[15];
+
+  t0 = _mm256_fmsub_ps(k, p, _mm256_mul_ps(o, l));
+  t1 = _mm256_fmsub_ps(j, p, _mm256_mul_ps(n, l));
+  t2 = _mm256_fmsub_ps(j, o, _mm256_mul_ps(n, k));
+  t3 = _mm256_fmsub_ps(i, p, _mm256_mul_ps(m, l));
+  t4 = _mm256_fmsub_ps(i, o, _mm256_mul_ps(m, k));
+  t5 = _mm256_fmsub_ps(i, n, _mm256_mul_ps(m, j));
+
+  /* first column of the cofactors, for the determinant. the negated
+     ones are written as b - a - c instead of -(a - b + c) */
+  c0 = _mm256_fmadd_ps(h, t2, _mm256_fmsub_ps(f, t0, _mm256_mul_ps(g, t1)));
+  c1 = _mm256_fnmadd_ps(h, t4, _mm256_fmsub_ps(g, t3, _mm256_mul_ps(e, t0)));
+  c2 = _mm256_fmadd_ps(h, t5, _mm256_fmsub_ps(e, t1, _mm256_mul_ps(f, t3)));
+  c3 = _mm256_fnmadd_ps(g, t5, _mm256_fmsub_ps(f, t4, _mm256_mul_ps(e, t2)));
+
+  det = _mm256_mul_ps(a, c0);
+  det = _mm256_fmadd_ps(b, c1, det);
+  det = _mm256_fmadd_ps(c, c2, det);
+  det = _mm256_fmadd_ps(d, c3, det);
+  det = _mm256_div_ps(_mm256_set1_ps(1.0f), det);
+
+  /* the rest is scaled as it is made, src is not read after this */
+  dest[0]  = _mm256_mul_ps(c0, det);
+  dest[4]  = _mm256_mul_ps(c1, det);
+  dest[8]  = _mm256_mul_ps(c2, det);
+  dest[12] = _mm256_mul_ps(c3, det);
+
+  c0 = _mm256_fnmadd_ps(d, t2, _mm256_fmsub_ps(c, t1, _mm256_mul_ps(b, t0)));
+  c1 = _mm256_fmadd_ps(d, t4, _mm256_fmsub_ps(a, t0, _mm256_mul_ps(c, t3)));
+  c2 = _mm256_fnmadd_ps(d, t5, _mm256_fmsub_ps(b, t3, _mm256_mul_ps(a, t1)));
+  c3 = _mm256_fmadd_ps(c, t5, _mm256_fmsub_ps(a, t2, _mm256_mul_ps(b, t4)));
+
+  dest[1]  = _mm256_mul_ps(c0, det);
+  dest[5]  = _mm256_mul_ps(c1, det);
+  dest[9]  = _mm256_mul_ps(c2, det);
+  dest[13] = _mm256_mul_ps(c3, det);
+
+  t0 = _mm256_fmsub_ps(g, p, _mm256_mul_ps(o, h));
+  t1 = _mm256_fmsub_ps(f, p, _mm256_mul_ps(n, h));
+  t2 = _mm256_fmsub_ps(f, o, _mm256_mul_ps(n, g));
+  t3 = _mm256_fmsub_ps(e, p, _mm256_mul_ps(m, h));
+  t4 = _mm256_fmsub_ps(e, o, _mm256_mul_ps(m, g));
+  t5 = _mm256_fmsub_ps(e, n, _mm256_mul_ps(m, f));
+
+  c0 = _mm256_fmadd_ps(d, t2, _mm256_fmsub_ps(b, t0, _mm256_mul_ps(c, t1)));
+  c1 = _mm256_fnmadd_ps(d, t4, _mm256_fmsub_ps(c, t3, _mm256_mul_ps(a, t0)));
+  c2 = _mm256_fmadd_ps(d, t5, _mm256_fmsub_ps(a, t1, _mm256_mul_ps(b, t3)));
+  c3 = _mm256_fnmadd_ps(c, t5, _mm256_fmsub_ps(b, t4, _mm256_mul_ps(a, t2)));
+
+  dest[2]  = _mm256_mul_ps(c0, det);
+  dest[6]  = _mm256_mul_ps(c1, det);
+  dest[10] = _mm256_mul_ps(c2, det);
+  dest[14] = _mm256_mul_ps(c3, det);
+
+  t0 = _mm256_fmsub_ps(g, l, _mm256_mul_ps(k, h));
+  t1 = _mm256_fmsub_ps(f, l, _mm256_mul_ps(j, h));
+  t2 = _mm256_fmsub_ps(f, k, _mm256_mul_ps(j, g));
+  t3 = _mm256_fmsub_ps(e, l, _mm256_mul_ps(i, h));
+  t4 = _mm256_fmsub_ps(e, k, _mm256_mul_ps(i, g));
+  t5 = _mm256_fmsub_ps(e, j, _mm256_mul_ps(i, f));
+
+  c0 = _mm256_fnmadd_ps(d, t2, _mm256_fmsub_ps(c, t1, _mm256_mul_ps(b, t0)));
+  c1 = _mm256_fmadd_ps(d, t4, _mm256_fmsub_ps(a, t0, _mm256_mul_ps(c, t3)));
+  c2 = _mm256_fnmadd_ps(d, t5, _mm256_fmsub_ps(b, t3, _mm256_mul_ps(a, t1)));
+  c3 = _mm256_fmadd_ps(c, t5, _mm256_fmsub_ps(a, t2, _mm256_mul_ps(b, t4)));
+
+  dest[3]  = _mm256_mul_ps(c0, det);
+  dest[7]  = _mm256_mul_ps(c1, det);
+  dest[11] = _mm256_mul_ps(c2, det);
+  dest[15] = _mm256_mul_ps(c3, det);
+}
+
+CGLM_INLINE
+void
+glm_mat4_inv_batch_soa_fma(float *src[16], float *dest[16], size_t count) {
+  CGLM_ALIGN_MAT mat4 t;
+  __m256 r[16];
+  float *s[16], *d[16];
+  size_t i;
+  int    x;
+
+  /* kept on the stack, as the vector stores could alias the arrays */
+  for (x = 0; x < 16; x++) {
+    s[x] = src[x];
+    d[x] = dest[x];
+  }
+
+  /* unrolled, so r stays in registers */
+  for (i = 0; i + 8 <= count; i += 8) {
+    r[0]  = _mm256_loadu_ps(s[0] + i);  r[1]  = _mm256_loadu_ps(s[1] + i);
+    r[2]  = _mm256_loadu_ps(s[2] + i);  r[3]  = _mm256_loadu_ps(s[3] + i);
+    r[4]  = _mm256_loadu_ps(s[4] + i);  r[5]  = _mm256_loadu_ps(s[5] + i);
+    r[6]  = _mm256_loadu_ps(s[6] + i);  r[7]  = _mm256_loadu_ps(s[7] + i);
+    r[8]  = _mm256_loadu_ps(s[8] + i);  r[9]  = _mm256_loadu_ps(s[9] + i);
+    r[10] = _mm256_loadu_ps(s[10] + i); r[11] = _mm256_loadu_ps(s[11] + i);
+    r[12] = _mm256_loadu_ps(s[12] + i); r[13] = _mm256_loadu_ps(s[13] + i);
+    r[14] = _mm256_loadu_ps(s[14] + i); r[15] = _mm256_loadu_ps(s[15] + i);
+
+    glm_mat4_inv8_fma(r, r);
+
+    _mm256_storeu_ps(d[0] + i, r[0]);   _mm256_storeu_ps(d[1] + i, r[1]);
+    _mm256_storeu_ps(d[2] + i, r[2]);   _mm256_storeu_ps(d[3] + i, r[3]);
+    _mm256_storeu_ps(d[4] + i, r[4]);   _mm256_storeu_ps(d[5] + i, r[5]);
+    _mm256_storeu_ps(d[6] + i, r[6]);   _mm256_storeu_ps(d[7] + i, r[7]);
+    _mm256_storeu_ps(d[8] + i, r[8]);   _mm256_storeu_ps(d[9] + i, r[9]);
+    _mm256_storeu_ps(d[10] + i, r[10]); _mm256_storeu_ps(d[11] + i, r[11]);
+    _mm256_storeu_ps(d[12] + i, r[12]); _mm256_storeu_ps(d[13] + i, r[13]);
+    _mm256_storeu_ps(d[14] + i, r[14]); _mm256_storeu_ps(d[15] + i, r[15]);
+  }
+
+  for (; i < count; i++) {
+    for (x = 0; x < 16; x++)
+      t[x / 4][x % 4] = s[x][i];
+
+    glm_mat4_inv_fma(t, t);
+
+    for (x = 0; x < 16; x++)
+      d[x][i] = t[x / 4][x % 4];
+  }
+}
+
+CGLM_INLINE
+void
+glm_mat4_inv_batch_fma(mat4 *mat, mat4 *dest, size_t count) {
+  __m256 r[16];
+  mat4  *m, *d;
+  size_t i;
+
+  /* eight matrices are two 8x8 blocks (columns 0-1 and 2-3), which
+     transpose into the layout glm_mat4_inv8_fma works on, and back */
+  for (i = 0; i + 8 <= count; i += 8) {
+    m = mat + i;
+    d = dest + i;
+
+    r[0]  = _mm256_loadu_ps(m[0][0]); r[8]  = _mm256_loadu_ps(m[0][2]);
+    r[1]  = _mm256_loadu_ps(m[1][0]); r[9]  = _mm256_loadu_ps(m[1][2]);
+    r[2]  = _mm256_loadu_ps(m[2][0]); r[10] = _mm256_loadu_ps(m[2][2]);
+    r[3]  = _mm256_loadu_ps(m[3][0]); r[11] = _mm256_loadu_ps(m[3][2]);
+    r[4]  = _mm256_loadu_ps(m[4][0]); r[12] = _mm256_loadu_ps(m[4][2]);
+    r[5]  = _mm256_loadu_ps(m[5][0]); r[13] = _mm256_loadu_ps(m[5][2]);
+    r[6]  = _mm256_loadu_ps(m[6][0]); r[14] = _mm256_loadu_ps(m[6][2]);
+    r[7]  = _mm256_loadu_ps(m[7][0]); r[15] = _mm256_loadu_ps(m[7][2]);
+
+    glm_mat4_transp8_avx(r);
+    glm_mat4_transp8_avx(r + 8);
+    glm_mat4_inv8_fma(r, r);
+    glm_mat4_transp8_avx(r);
+    glm_mat4_transp8_avx(r + 8);
+
+    _mm256_storeu_ps(d[0][0], r[0]); _mm256_storeu_ps(d[0][2], r[8]);
+    _mm256_storeu_ps(d[1][0], r[1]); _mm256_storeu_ps(d[1][2], r[9]);
+    _mm256_storeu_ps(d[2][0], r[2]); _mm256_storeu_ps(d[2][2], r[10]);
+    _mm256_storeu_ps(d[3][0], r[3]); _mm256_storeu_ps(d[3][2], r[11]);
+    _mm256_storeu_ps(d[4][0], r[4]); _mm256_storeu_ps(d[4][2], r[12]);
+    _mm256_storeu_ps(d[5][0], r[5]); _mm256_storeu_ps(d[5][2], r[13]);
+    _mm256_storeu_ps(d[6][0], r[6]); _mm256_storeu_ps(d[6][2], r[14]);
+    _mm256_storeu_ps(d[7][0], r[7]); _mm256_storeu_ps(d[7][2], r[15]);
+  }
+
+  for (; i < count; i++)
+    glm_mat4_inv_fma(mat[i], dest[i]);
+}
+
+#endif
+
 #endif
 #endif /* cglm_mat_simd_avx_h */
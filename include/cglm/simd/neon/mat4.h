@@ -53,5 +53,163 @@ glm_mat4_mul_neon(mat4 m1, mat4 m2, mat4 dest) {
   vst1q_f32(dest[3], d3);
 }
 
+/* batch transforms: one matrix, many vectors. dest may be the same as v */
+
+CGLM_INLINE
+void
+glm_mat4_mulv_batch_neon(mat4 m, vec4 *v, vec4 *dest, size_t count) {
+  float32x4_t c0, c1, c2, c3, x0, d0;
+  size_t i;
+
+  c0 = vld1q_f32(m[0]);
+  c1 = vld1q_f32(m[1]);
+  c2 = vld1q_f32(m[2]);
+  c3 = vld1q_f32(m[3]);
+
+  for (i = 0; i < count; i++) {
+    x0 = vld1q_f32(v[i]);
+    d0 = vmulq_lane_f32(c0, vget_low_f32(x0), 0);
+    d0 = vmlaq_lane_f32(d0, c1, vget_low_f32(x0), 1);
+    d0 = vmlaq_lane_f32(d0, c2, vget_high_f32(x0), 0);
+    d0 = vmlaq_lane_f32(d0, c3, vget_high_f32(x0), 1);
+    vst1q_f32(dest[i], d0);
+  }
+}
+
+CGLM_INLINE
+void
+glm_mat4_mulv3_batch_neon(mat4 m, vec3 *v, float last, vec3 *dest,
+                          size_t count) {
+  float32x4x3_t p, r;
+  float32x4_t   t0, t1, t2;
+  float        *src, *dst, vx, vy, vz;
+  size_t        i;
+
+  t0 = vdupq_n_f32(m[3][0] * last);
+  t1 = vdupq_n_f32(m[3][1] * last);
+  t2 = vdupq_n_f32(m[3][2] * last);
+
+  src = v[0];
+  dst = dest[0];
+
+  /* vld3 splits four vectors into x, y and z, and vst3 joins them back */
+  for (i = 0; i + 4 <= count; i += 4, src += 12, dst += 12) {
+    p = vld3q_f32(src);
+
+    r.val[0] = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(t0, p.val[0], m[0][0]),
+                                       p.val[1], m[1][0]),
+                           p.val[2], m[2][0]);
+    r.val[1] = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(t1, p.val[0], m[0][1]),
+                                       p.val[1], m[1][1]),
+                           p.val[2], m[2][1]);
+    r.val[2] = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(t2, p.val[0], m[0][2]),
+                                       p.val[1], m[1][2]),
+                           p.val[2], m[2][2]);
+
+    vst3q_f32(dst, r);
+  }
+
+  for (; i < count; i++, src += 3, dst += 3) {
+    vx = src[0]; vy = src[1]; vz = src[2];
+    dst[0] = m[0][0] * vx + m[1][0] * vy + m[2][0] * vz + m[3][0] * last;
+    dst[1] = m[0][1] * vx + m[1][1] * vy + m[2][1] * vz + m[3][1] * last;
+    dst[2] = m[0][2] * vx + m[1][2] * vy + m[2][2] * vz + m[3][2] * last;
+  }
+}
+
+CGLM_INLINE
+void
+glm_mat4_mulv_batch_soa_neon(mat4 m, float *src[4], float *dest[4],
+                             size_t count) {
+  float32x4_t x, y, z, w, r0, r1, r2, r3;
+  float       vx, vy, vz, vw;
+  float      *sx, *sy, *sz, *sw, *dx, *dy, *dz, *dw;
+  size_t      i;
+
+  /* kept in registers, as the vector stores could alias the arrays */
+  sx = src[0]; sy = src[1]; sz = src[2]; sw = src[3];
+  dx = dest[0]; dy = dest[1]; dz = dest[2]; dw = dest[3];
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    x = vld1q_f32(sx + i);
+    y = vld1q_f32(sy + i);
+    z = vld1q_f32(sz + i);
+    w = vld1q_f32(sw + i);
+
+    r0 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(x, m[0][0]),
+                                             y, m[1][0]),
+                                 z, m[2][0]),
+                     w, m[3][0]);
+    r1 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(x, m[0][1]),
+                                             y, m[1][1]),
+                                 z, m[2][1]),
+                     w, m[3][1]);
+    r2 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(x, m[0][2]),
+                                             y, m[1][2]),
+                                 z, m[2][2]),
+                     w, m[3][2]);
+    r3 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(vmulq_n_f32(x, m[0][3]),
+                                             y, m[1][3]),
+                                 z, m[2][3]),
+                     w, m[3][3]);
+
+    /* stored after every row is done, in case dest is src */
+    vst1q_f32(dx + i, r0);
+    vst1q_f32(dy + i, r1);
+    vst1q_f32(dz + i, r2);
+    vst1q_f32(dw + i, r3);
+  }
+
+  for (; i < count; i++) {
+    vx = sx[i]; vy = sy[i]; vz = sz[i]; vw = sw[i];
+    dx[i] = m[0][0] * vx + m[1][0] * vy + m[2][0] * vz + m[3][0] * vw;
+    dy[i] = m[0][1] * vx + m[1][1] * vy + m[2][1] * vz + m[3][1] * vw;
+    dz[i] = m[0][2] * vx + m[1][2] * vy + m[2][2] * vz + m[3][2] * vw;
+    dw[i] = m[0][3] * vx + m[1][3] * vy + m[2][3] * vz + m[3][3] * vw;
+  }
+}
+
+CGLM_INLINE
+void
+glm_mat4_mulv3_batch_soa_neon(mat4 m, float *src[3], float last,
+                              float *dest[3], size_t count) {
+  float32x4_t x, y, z, t0, t1, t2, r0, r1, r2;
+  float       vx, vy, vz;
+  float      *sx, *sy, *sz, *dx, *dy, *dz;
+  size_t      i;
+
+  t0 = vdupq_n_f32(m[3][0] * last);
+  t1 = vdupq_n_f32(m[3][1] * last);
+  t2 = vdupq_n_f32(m[3][2] * last);
+
+  /* kept in registers, as the vector stores could alias the arrays */
+  sx = src[0]; sy = src[1]; sz = src[2];
+  dx = dest[0]; dy = dest[1]; dz = dest[2];
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    x = vld1q_f32(sx + i);
+    y = vld1q_f32(sy + i);
+    z = vld1q_f32(sz + i);
+
+    r0 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(t0, x, m[0][0]), y, m[1][0]),
+                     z, m[2][0]);
+    r1 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(t1, x, m[0][1]), y, m[1][1]),
+                     z, m[2][1]);
+    r2 = vmlaq_n_f32(vmlaq_n_f32(vmlaq_n_f32(t2, x, m[0][2]), y, m[1][2]),
+                     z, m[2][2]);
+
+    vst1q_f32(dx + i, r0);
+    vst1q_f32(dy + i, r1);
+    vst1q_f32(dz + i, r2);
+  }
+
+  for (; i < count; i++) {
+    vx = sx[i]; vy = sy[i]; vz = sz[i];
+    dx[i] = m[0][0] * vx + m[1][0] * vy + m[2][0] * vz + m[3][0] * last;
+    dy[i] = m[0][1] * vx + m[1][1] * vy + m[2][1] * vz + m[3][1] * last;
+    dz[i] = m[0][2] * vx + m[1][2] * vy + m[2][2] * vz + m[3][2] * last;
+  }
+}
+
 #endif
 #endif /* cglm_mat4_neon_h */
@@ -401,5 +401,253 @@ glm_mat4_inv_sse2(mat4 mat, mat4 dest) {
   glmm_store(dest[3], _mm_mul_ps(v3, x0));
 }
 
+/*
+ * batch transforms: one matrix, many vectors.
+ * vectors are read and written unaligned, dest may be the same as v
+ */
+
+CGLM_INLINE
+void
+glm_mat4_mulv_batch_sse2(mat4 m, vec4 *v, vec4 *dest, size_t count) {
+  __m128 c0, c1, c2, c3, x0;
+  size_t i;
+
+  c0 = glmm_load(m[0]);
+  c1 = glmm_load(m[1]);
+  c2 = glmm_load(m[2]);
+  c3 = glmm_load(m[3]);
+
+  for (i = 0; i < count; i++) {
+    x0 = _mm_loadu_ps(v[i]);
+    _mm_storeu_ps(dest[i],
+                  _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, glmm_shuff1x(x0, 0)),
+                                        _mm_mul_ps(c1, glmm_shuff1x(x0, 1))),
+                             _mm_add_ps(_mm_mul_ps(c2, glmm_shuff1x(x0, 2)),
+                                        _mm_mul_ps(c3, glmm_shuff1x(x0, 3)))));
+  }
+}
+
+CGLM_INLINE
+void
+glm_mat4_mulv3_batch_sse2(mat4 m, vec3 *v, float last, vec3 *dest,
+                          size_t count) {
+  __m128 m00, m01, m02, m10, m11, m12, m20, m21, m22, t0, t1, t2;
+  __m128 a, b, c, x, y, z, s0, s1;
+  float *src, *dst;
+  size_t i;
+
+  m00 = _mm_set1_ps(m[0][0]); m01 = _mm_set1_ps(m[0][1]);
+  m02 = _mm_set1_ps(m[0][2]); m10 = _mm_set1_ps(m[1][0]);
+  m11 = _mm_set1_ps(m[1][1]); m12 = _mm_set1_ps(m[1][2]);
+  m20 = _mm_set1_ps(m[2][0]); m21 = _mm_set1_ps(m[2][1]);
+  m22 = _mm_set1_ps(m[2][2]);
+
+  /* the constant w only adds the translation, scaled */
+  t0 = _mm_set1_ps(m[3][0] * last);
+  t1 = _mm_set1_ps(m[3][1] * last);
+  t2 = _mm_set1_ps(m[3][2] * last);
+
+  src = v[0];
+  dst = dest[0];
+
+  /* four at a time, as x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3 */
+  for (i = 0; i + 4 <= count; i += 4, src += 12, dst += 12) {
+    a = _mm_loadu_ps(src);
+    b = _mm_loadu_ps(src + 4);
+    c = _mm_loadu_ps(src + 8);
+
+    s0 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 1, 3, 2)); /* x2 y2 x3 y3 */
+    s1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1)); /* y0 z0 y1 z1 */
+    x  = _mm_shuffle_ps(a,  s0, _MM_SHUFFLE(2, 0, 3, 0));
+    y  = _mm_shuffle_ps(s1, s0, _MM_SHUFFLE(3, 1, 2, 0));
+    z  = _mm_shuffle_ps(s1, c,  _MM_SHUFFLE(3, 0, 3, 1));
+
+    a = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)),
+                   _mm_add_ps(_mm_mul_ps(m20, z), t0));
+    b = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)),
+                   _mm_add_ps(_mm_mul_ps(m21, z), t1));
+    c = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)),
+                   _mm_add_ps(_mm_mul_ps(m22, z), t2));
+
+    /* and back */
+    s0 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 0, 0)); /* x0 x0 y0 y0 */
+    s1 = _mm_shuffle_ps(c, a, _MM_SHUFFLE(1, 1, 0, 0)); /* z0 z0 x1 x1 */
+    _mm_storeu_ps(dst, _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(2, 0, 2, 0)));
+
+    s0 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 1, 1)); /* y1 y1 z1 z1 */
+    s1 = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 2, 2, 2)); /* x2 x2 y2 y2 */
+    _mm_storeu_ps(dst + 4, _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(2, 0, 2, 0)));
+
+    s0 = _mm_shuffle_ps(c, a, _MM_SHUFFLE(3, 3, 2, 2)); /* z2 z2 x3 x3 */
+    s1 = _mm_shuffle_ps(b, c, _MM_SHUFFLE(3, 3, 3, 3)); /* y3 y3 z3 z3 */
+    _mm_storeu_ps(dst + 8, _mm_shuffle_ps(s0, s1, _MM_SHUFFLE(2, 0, 2, 0)));
+  }
+
+  for (; i < count; i++, src += 3, dst += 3) {
+    x = _mm_set_ss(src[0]);
+    y = _mm_set_ss(src[1]);
+    z = _mm_set_ss(src[2]);
+
+    a = _mm_add_ss(_mm_add_ss(_mm_mul_ss(m00, x), _mm_mul_ss(m10, y)),
+                   _mm_add_ss(_mm_mul_ss(m20, z), t0));
+    b = _mm_add_ss(_mm_add_ss(_mm_mul_ss(m01, x), _mm_mul_ss(m11, y)),
+                   _mm_add_ss(_mm_mul_ss(m21, z), t1));
+    c = _mm_add_ss(_mm_add_ss(_mm_mul_ss(m02, x), _mm_mul_ss(m12, y)),
+                   _mm_add_ss(_mm_mul_ss(m22, z), t2));
+
+    _mm_store_ss(&dst[0], a);
+    _mm_store_ss(&dst[1], b);
+    _mm_store_ss(&dst[2], c);
+  }
+}
+
+CGLM_INLINE
+void
+glm_mat4_mulv_batch_soa_sse2(mat4 m, float *src[4], float *dest[4],
+                             size_t count) {
+  __m128 m00, m01, m02, m03, m10, m11, m12, m13,
+         m20, m21, m22, m23, m30, m31, m32, m33;
+  __m128 x, y, z, w, r0, r1, r2, r3;
+  float  vx, vy, vz, vw;
+  float *sx, *sy, *sz, *sw, *dx, *dy, *dz, *dw;
+  size_t i;
+
+  m00 = _mm_set1_ps(m[0][0]); m01 = _mm_set1_ps(m[0][1]);
+  m02 = _mm_set1_ps(m[0][2]); m03 = _mm_set1_ps(m[0][3]);
+  m10 = _mm_set1_ps(m[1][0]); m11 = _mm_set1_ps(m[1][1]);
+  m12 = _mm_set1_ps(m[1][2]); m13 = _mm_set1_ps(m[1][3]);
+  m20 = _mm_set1_ps(m[2][0]); m21 = _mm_set1_ps(m[2][1]);
+  m22 = _mm_set1_ps(m[2][2]); m23 = _mm_set1_ps(m[2][3]);
+  m30 = _mm_set1_ps(m[3][0]); m31 = _mm_set1_ps(m[3][1]);
+  m32 = _mm_set1_ps(m[3][2]); m33 = _mm_set1_ps(m[3][3]);
+
+  /* kept in registers, as the vector stores could alias the arrays */
+  sx = src[0]; sy = src[1]; sz = src[2]; sw = src[3];
+  dx = dest[0]; dy = dest[1]; dz = dest[2]; dw = dest[3];
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    x = _mm_loadu_ps(sx + i);
+    y = _mm_loadu_ps(sy + i);
+    z = _mm_loadu_ps(sz + i);
+    w = _mm_loadu_ps(sw + i);
+
+    r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)),
+                    _mm_add_ps(_mm_mul_ps(m20, z), _mm_mul_ps(m30, w)));
+    r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)),
+                    _mm_add_ps(_mm_mul_ps(m21, z), _mm_mul_ps(m31, w)));
+    r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)),
+                    _mm_add_ps(_mm_mul_ps(m22, z), _mm_mul_ps(m32, w)));
+    r3 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m03, x), _mm_mul_ps(m13, y)),
+                    _mm_add_ps(_mm_mul_ps(m23, z), _mm_mul_ps(m33, w)));
+
+    /* stored after every row is done, in case dest is src */
+    _mm_storeu_ps(dx + i, r0);
+    _mm_storeu_ps(dy + i, r1);
+    _mm_storeu_ps(dz + i, r2);
+    _mm_storeu_ps(dw + i, r3);
+  }
+
+  for (; i < count; i++) {
+    vx = sx[i]; vy = sy[i]; vz = sz[i]; vw = sw[i];
+    dx[i] = m[0][0] * vx + m[1][0] * vy + m[2][0] * vz + m[3][0] * vw;
+    dy[i] = m[0][1] * vx + m[1][1] * vy + m[2][1] * vz + m[3][1] * vw;
+    dz[i] = m[0][2] * vx + m[1][2] * vy + m[2][2] * vz + m[3][2] * vw;
+    dw[i] = m[0][3] * vx + m[1][3] * vy + m[2][3] * vz + m[3][3] * vw;
+  }
+}
+
+CGLM_INLINE
+void
+glm_mat4_mulv3_batch_soa_sse2(mat4 m, float *src[3], float last,
+                              float *dest[3], size_t count) {
+  __m128 m00, m01, m02, m10, m11, m12, m20, m21, m22, t0, t1, t2;
+  __m128 x, y, z, r0, r1, r2;
+  float  vx, vy, vz;
+  float *sx, *sy, *sz, *dx, *dy, *dz;
+  size_t i;
+
+  m00 = _mm_set1_ps(m[0][0]); m01 = _mm_set1_ps(m[0][1]);
+  m02 = _mm_set1_ps(m[0][2]); m10 = _mm_set1_ps(m[1][0]);
+  m11 = _mm_set1_ps(m[1][1]); m12 = _mm_set1_ps(m[1][2]);
+  m20 = _mm_set1_ps(m[2][0]); m21 = _mm_set1_ps(m[2][1]);
+  m22 = _mm_set1_ps(m[2][2]);
+
+  t0 = _mm_set1_ps(m[3][0] * last);
+  t1 = _mm_set1_ps(m[3][1] * last);
+  t2 = _mm_set1_ps(m[3][2] * last);
+
+  /* kept in registers, as the vector stores could alias the arrays */
+  sx = src[0]; sy = src[1]; sz = src[2];
+  dx = dest[0]; dy = dest[1]; dz = dest[2];
+
+  for (i = 0; i + 4 <= count; i += 4) {
+    x = _mm_loadu_ps(sx + i);
+    y = _mm_loadu_ps(sy + i);
+    z = _mm_loadu_ps(sz + i);
+
+    r0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, x), _mm_mul_ps(m10, y)),
+                    _mm_add_ps(_mm_mul_ps(m20, z), t0));
+    r1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m01, x), _mm_mul_ps(m11, y)),
+                    _mm_add_ps(_mm_mul_ps(m21, z), t1));
+    r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m02, x), _mm_mul_ps(m12, y)),
+                    _mm_add_ps(_mm_mul_ps(m22, z), t2));
+
+    _mm_storeu_ps(dx + i, r0);
+    _mm_storeu_ps(dy + i, r1);
+    _mm_storeu_ps(dz + i, r2);
+  }
+
+  for (; i < count; i++) {
+    vx = sx[i]; vy = sy[i]; vz = sz[i];
+    dx[i] = m[0][0] * vx + m[1][0] * vy + m[2][0] * vz + m[3][0] * last;
+    dy[i] = m[0][1] * vx + m[1][1] * vy + m[2][1] * vz + m[3][1] * last;
+    dz[i] = m[0][2] * vx + m[1][2] * vy + m[2][2] * vz + m[3][2] * last;
+  }
+}
+
+/* dest[i] = a[i] * b[i], with non-temporal stores that skip the cache,
+   for outputs too big to stay in it. dest may be a or b */
+CGLM_INLINE
+void
+glm_mat4_mul_batch_stream_sse2(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+  __m128 l0, l1, l2, l3, r, d0, d1, d2, d3;
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    l0 = glmm_load(a[i][0]);
+    l1 = glmm_load(a[i][1]);
+    l2 = glmm_load(a[i][2]);
+    l3 = glmm_load(a[i][3]);
+
+    r  = glmm_load(b[i][0]);
+    d0 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(glmm_shuff1x(r, 0), l0),
+                               _mm_mul_ps(glmm_shuff1x(r, 1), l1)),
+                    _mm_add_ps(_mm_mul_ps(glmm_shuff1x(r, 2), l2),
+                               _mm_mul_ps(glmm_shuff1x(r, 3), l3)));
+    r  = glmm_load(b[i][1]);
+    d1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(glmm_shuff1x(r, 0), l0),
+                               _mm_mul_ps(glmm_shuff1x(r, 1), l1)),
+                    _mm_add_ps(_mm_mul_ps(glmm_shuff1x(r, 2), l2),
+                               _mm_mul_ps(glmm_shuff1x(r, 3), l3)));
+    r  = glmm_load(b[i][2]);
+    d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(glmm_shuff1x(r, 0), l0),
+                               _mm_mul_ps(glmm_shuff1x(r, 1), l1)),
+                    _mm_add_ps(_mm_mul_ps(glmm_shuff1x(r, 2), l2),
+                               _mm_mul_ps(glmm_shuff1x(r, 3), l3)));
+    r  = glmm_load(b[i][3]);
+    d3 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(glmm_shuff1x(r, 0), l0),
+                               _mm_mul_ps(glmm_shuff1x(r, 1), l1)),
+                    _mm_add_ps(_mm_mul_ps(glmm_shuff1x(r, 2), l2),
+                               _mm_mul_ps(glmm_shuff1x(r, 3), l3)));
+
+    _mm_stream_ps(dest[i][0], d0);
+    _mm_stream_ps(dest[i][1], d1);
+    _mm_stream_ps(dest[i][2], d2);
+    _mm_stream_ps(dest[i][3], d3);
+  }
+
+  _mm_sfence();
+}
+
 #endif
 #endif /* cglm_mat_sse_h */
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm_sphere_sse2_h
+#define cglm_sphere_sse2_h
+#if defined( __SSE__ ) || defined( __SSE2__ )
+
+#include "../../common.h"
+#include "../intrin.h"
+
+/*
+ * four spheres at a time, one per lane. a sphere is outside a plane
+ * when its center is further behind it than its radius:
+ *   dot(n, c) + w + r < 0
+ */
+CGLM_INLINE
+void
+glm_sphere_frustum_soa_sse2(float *s[4], vec4 planes[6], uint32_t *mask,
+                            size_t count) {
+  __m128 p[6][4], cx, cy, cz, r, d, out;
+  float *sx, *sy, *sz, *sr, *pl, dp;
+  uint32_t w;
+  size_t   i;
+  int      k;
+
+  for (k = 0; k < 6; k++) {
+    pl = planes[k];
+    p[k][0] = _mm_set1_ps(pl[0]);
+    p[k][1] = _mm_set1_ps(pl[1]);
+    p[k][2] = _mm_set1_ps(pl[2]);
+    p[k][3] = _mm_set1_ps(pl[3]);
+  }
+
+  /* kept in registers, as the mask stores could alias the arrays */
+  sx = s[0]; sy = s[1]; sz = s[2]; sr = s[3];
+
+  w = 0;
+  for (i = 0; i + 4 <= count; i += 4) {
+    cx = _mm_loadu_ps(sx + i);
+    cy = _mm_loadu_ps(sy + i);
+    cz = _mm_loadu_ps(sz + i);
+    r  = _mm_loadu_ps(sr + i);
+
+    out = _mm_setzero_ps();
+    for (k = 0; k < 6; k++) {
+      d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(p[k][0], cx),
+                                _mm_mul_ps(p[k][1], cy)),
+                     _mm_add_ps(_mm_mul_ps(p[k][2], cz), p[k][3]));
+      out = _mm_or_ps(out, _mm_cmplt_ps(_mm_add_ps(d, r), _mm_setzero_ps()));
+    }
+
+    w |= (uint32_t)(~_mm_movemask_ps(out) & 0xF) << (i & 31);
+
+    if (((i + 4) & 31) == 0) {
+      mask[i >> 5] = w;
+      w = 0;
+    }
+  }
+
+  for (; i < count; i++) {
+    for (k = 0; k < 6; k++) {
+      pl = planes[k];
+      dp = pl[0] * sx[i] + pl[1] * sy[i] + pl[2] * sz[i] + pl[3] + sr[i];
+
+      if (dp < 0.0f)
+        break;
+    }
+
+    w |= (uint32_t)(k == 6) << (i & 31);
+  }
+
+  if (count & 31)
+    mask[count >> 5] = w;
+}
+
+#endif
+#endif /* cglm_sphere_sse2_h */
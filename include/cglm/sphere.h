@@ -10,6 +10,15 @@
 
 #include "common.h"
 #include "mat4.h"
+#include "util.h"
+
+#ifdef CGLM_SSE_FP
+#  include "simd/sse2/sphere.h"
+#endif
+
+#ifdef CGLM_AVX_FP
+#  include "simd/avx/sphere.h"
+#endif
 
 /*
   Sphere Representation in cglm: [center.x, center.y, center.z, radii]
@@ -96,4 +105,100 @@ glm_sphere_point(vec4 s, vec3 point) {
   return glm_vec3_distance2(point, s) <= rr;
 }
 
+/*!
+ * @brief check if sphere intersects with frustum planes
+ *
+ * @param[in]   s       sphere
+ * @param[in]   planes  frustum planes, from glm_frustum_planes
+ */
+CGLM_INLINE
+bool
+glm_sphere_frustum(vec4 s, vec4 planes[6]) {
+  int i;
+
+  for (i = 0; i < 6; i++) {
+    if (glm_vec3_dot(planes[i], s) + planes[i][3] < -glm_sphere_radii(s))
+      return false;
+  }
+
+  return true;
+}
+
+/*!
+ * @brief frustum culling for many spheres, stored as structure of arrays
+ *
+ * s[0], s[1], s[2] and s[3] are the arrays of center x, y, z and radius,
+ * the components of the sphere representation above. four spheres
+ * (eight with AVX) are tested against the six planes at a time.
+ *
+ * sphere i is visible when bit (i & 31) of mask[i >> 5] is set. bits
+ * past count in the last word are cleared
+ *
+ * @param[in]  s      sphere arrays, x y z radius
+ * @param[in]  planes frustum planes, from glm_frustum_planes
+ * @param[out] mask   visibility, (count + 31) / 32 words
+ * @param[in]  count  number of spheres
+ */
+CGLM_INLINE
+void
+glm_sphere_frustum_soa(float *s[4], vec4 planes[6], uint32_t *mask,
+                       size_t count) {
+#if defined( __AVX__ )
+  glm_sphere_frustum_soa_avx(s, planes, mask, count);
+#elif defined( __SSE__ ) || defined( __SSE2__ )
+  glm_sphere_frustum_soa_sse2(s, planes, mask, count);
+#else
+  CGLM_ALIGN(16) vec4 v;
+  uint32_t w;
+  size_t   i;
+
+  w = 0;
+  for (i = 0; i < count; i++) {
+    v[0] = s[0][i]; v[1] = s[1][i]; v[2] = s[2][i]; v[3] = s[3][i];
+    w   |= (uint32_t)glm_sphere_frustum(v, planes) << (i & 31);
+
+    if (((i + 1) & 31) == 0) {
+      mask[i >> 5] = w;
+      w = 0;
+    }
+  }
+
+  if (count & 31)
+    mask[count >> 5] = w;
+#endif
+}
+
+/*!
+ * @brief same as glm_sphere_frustum_soa, but writes the indices of the
+ *        visible spheres instead of a bitmask
+ *
+ * @param[in]  s       sphere arrays, x y z radius
+ * @param[in]  planes  frustum planes, from glm_frustum_planes
+ * @param[out] indices visible spheres in increasing order, room for count
+ * @param[in]  count   number of spheres
+ *
+ * @return number of visible spheres
+ */
+CGLM_INLINE
+size_t
+glm_sphere_frustum_soa_index(float *s[4], vec4 planes[6], uint32_t *indices,
+                             size_t count) {
+  uint32_t mask[8];
+  float   *t[4];
+  size_t   i, k, n;
+
+  /* 256 spheres at a time, so the mask stays on the stack */
+  n = 0;
+  for (i = 0; i < count; i += k) {
+    k = GLM_MIN(count - i, 256);
+
+    t[0] = s[0] + i; t[1] = s[1] + i; t[2] = s[2] + i; t[3] = s[3] + i;
+
+    glm_sphere_frustum_soa(t, planes, mask, k);
+    n += glm_bitmask_index(mask, k, (uint32_t)i, indices + n);
+  }
+
+  return n;
+}
+
 #endif /* cglm_sphere_h */
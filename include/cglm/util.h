@@ -13,6 +13,7 @@
    CGLM_INLINE void  glm_make_rad(float *deg);
    CGLM_INLINE void  glm_make_deg(float *rad);
    CGLM_INLINE float glm_pow2(float x);
+   CGLM_INLINE size_t glm_bitmask_index(uint32_t *mask, size_t count, uint32_t base, uint32_t *dest);
  */
 
 #ifndef cglm_util_h
@@ -217,4 +218,37 @@ glm_percentc(float from, float to, float current) {
   return glm_clamp(glm_percent(from, to, current), 0.0f, 1.0f);
 }
 
+/*!
+ * @brief write the positions of the set bits in a bitmask, in order
+ *
+ * bit i is bit (i & 31) of mask[i >> 5]. every position is written and
+ * only the set ones are kept, so there is no branch per bit
+ *
+ * @param[in]  mask  bitmask, (count + 31) / 32 words
+ * @param[in]  count number of bits
+ * @param[in]  base  added to every position
+ * @param[out] dest  positions, must have room for count of them
+ *
+ * @return number of positions written
+ */
+CGLM_INLINE
+size_t
+glm_bitmask_index(uint32_t *mask, size_t count, uint32_t base,
+                  uint32_t *dest) {
+  size_t   i, n;
+  uint32_t w;
+
+  n = 0;
+  w = 0;
+  for (i = 0; i < count; i++) {
+    if ((i & 31) == 0)
+      w = mask[i >> 5];
+
+    dest[n] = base + (uint32_t)i;
+    n      += (w >> (i & 31)) & 1;
+  }
+
+  return n;
+}
+
 #endif /* cglm_util_h */
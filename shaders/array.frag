@@ -0,0 +1,27 @@
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+// Shared by every program, see FrameData in minimum.c
+layout(std140) uniform FrameData {
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_BackgroundColor;
+    float u_Time;
+};
+
+uniform sampler2DArray u_Texture;
+
+in vec3 v_TexCoord;
+in vec4 v_Color;
+
+float amount;
+
+
+void main(){
+
+    amount = texture( u_Texture, v_TexCoord ).r;
+    color = v_Color;
+    color = mix( v_Color, u_BackgroundColor, ( 1.0f - amount ) * 2.0f );
+}
@@ -0,0 +1,31 @@
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec4 vertColor;
+// Layer of the array texture in the third component
+layout(location = 2) in vec3 texCoord;
+
+// Shared by every program, see FrameData in minimum.c
+layout(std140) uniform FrameData {
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_BackgroundColor;
+    float u_Time;
+};
+
+// Of the object being drawn, see ObjectData in minimum.c
+layout(std140) uniform ObjectData {
+    mat4 u_Model;
+    vec4 u_Color;
+};
+
+out vec3 v_TexCoord;
+out vec4 v_Color;
+
+void main(){
+
+    gl_Position = u_ViewProjection * u_Model * position;
+    v_TexCoord = texCoord;
+    v_Color = vertColor * u_Color;
+}
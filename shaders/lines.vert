@@ -0,0 +1,21 @@
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec4 vertColor;
+
+// Shared by every program, see FrameData in minimum.c
+layout(std140) uniform FrameData {
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_BackgroundColor;
+    float u_Time;
+};
+
+out vec4 v_Color;
+
+void main(){
+
+    gl_Position = u_ViewProjection * position;
+    v_Color = vertColor;
+}
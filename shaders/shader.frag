@@ -2,7 +2,15 @@
 
 layout(location = 0) out vec4 color;
 
-uniform vec4 u_BackgroundColor;
+// Shared by every program, see FrameData in minimum.c
+layout(std140) uniform FrameData {
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_BackgroundColor;
+    float u_Time;
+};
+
 uniform sampler2D u_Texture;
 
 in vec2 v_TexCoord;
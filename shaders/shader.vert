@@ -4,14 +4,39 @@ layout(location = 0) in vec4 position;
 layout(location = 1) in vec4 vertColor;
 layout(location = 2) in vec2 texCoord;
 
-uniform mat4 u_MVP;
+#ifdef INSTANCED
+// Per instance attributes.
+// The matrix takes locations 3 to 6
+layout(location = 3) in mat4 i_Model;
+layout(location = 7) in vec4 i_Color;
+#endif
+
+// Shared by every program, see FrameData in minimum.c
+layout(std140) uniform FrameData {
+    mat4 u_View;
+    mat4 u_Projection;
+    mat4 u_ViewProjection;
+    vec4 u_BackgroundColor;
+    float u_Time;
+};
+
+// Of the object being drawn, see ObjectData in minimum.c
+layout(std140) uniform ObjectData {
+    mat4 u_Model;
+    vec4 u_Color;
+};
 
 out vec2 v_TexCoord;
 out vec4 v_Color;
 
 void main(){
 
-    gl_Position = u_MVP * position;
+#ifdef INSTANCED
+    gl_Position = u_ViewProjection * u_Model * i_Model * position;
+    v_Color = vertColor * u_Color * i_Color;
+#else
+    gl_Position = u_ViewProjection * u_Model * position;
+    v_Color = vertColor * u_Color;
+#endif
     v_TexCoord = texCoord;
-    v_Color = vertColor;
 }
@@ -7,6 +7,7 @@
 
 #include "../include/cglm/cglm.h"
 #include "../include/cglm/call.h"
+#include "simd.h"
 
 CGLM_EXPORT
 void
@@ -149,5 +150,5 @@ glmc_mul_rot(mat4 m1, mat4 m2, mat4 dest) {
 CGLM_EXPORT
 void
 glmc_inv_tr(mat4 mat) {
-  glm_inv_tr(mat);
+  glmc_simd->inv_tr(mat);
 }
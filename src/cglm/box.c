@@ -7,6 +7,7 @@
 
 #include "../include/cglm/cglm.h"
 #include "../include/cglm/call.h"
+#include "simd.h"
 
 CGLM_EXPORT
 void
@@ -41,6 +42,21 @@ glmc_aabb_frustum(vec3 box[2], vec4 planes[6]) {
   return glm_aabb_frustum(box, planes);
 }
 
+CGLM_EXPORT
+void
+glmc_aabb_frustum_soa(float *center[3], float *extent[3], vec4 planes[6],
+                      uint32_t *mask, size_t count) {
+  glmc_simd->aabb_frustum_soa(center, extent, planes, mask, count);
+}
+
+CGLM_EXPORT
+size_t
+glmc_aabb_frustum_soa_index(float *center[3], float *extent[3],
+                            vec4 planes[6], uint32_t *indices, size_t count) {
+  return glmc_simd->aabb_frustum_soa_index(center, extent, planes, indices,
+                                           count);
+}
+
 CGLM_EXPORT
 void
 glmc_aabb_invalidate(vec3 box[2]) {
@@ -6,6 +6,7 @@
 */
 
 #include "config.h"
+#include "simd.h"
 
 BOOL
 APIENTRY
@@ -14,6 +15,8 @@ DllMain(HMODULE hModule,
 	    LPVOID  lpReserved) {
 	switch (ul_reason_for_call) {
 	case DLL_PROCESS_ATTACH:
+		glmc_simd_init();
+		break;
 	case DLL_THREAD_ATTACH:
 	case DLL_THREAD_DETACH:
 	case DLL_PROCESS_DETACH:
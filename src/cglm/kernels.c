@@ -0,0 +1,180 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+/*
+ * Built once per instruction set, with its compiler flags and
+ * CGLM_KERNELS set to its name, into a glmc_simd_table_<name>.
+ * The inline functions pick their paths from those flags.
+ *
+ * Callers only guarantee the 16 byte alignment of SSE builds,
+ * so AVX builds need CGLM_ALL_UNALIGNED as well
+ */
+
+#include "simd.h"
+
+#ifndef CGLM_KERNELS
+#  error "CGLM_KERNELS must name the instruction set being built"
+#endif
+
+#if defined(__AVX__) && !defined(CGLM_ALL_UNALIGNED)
+#  error "AVX kernels must be built with CGLM_ALL_UNALIGNED"
+#endif
+
+#define GLMC_CONCAT_(a, b) a ## b
+#define GLMC_CONCAT(a, b)  GLMC_CONCAT_(a, b)
+
+#if defined(__AVX2__) && defined(__FMA__)
+#  define GLMC_KERNELS_LEVEL CGLM_SIMD_AVX2
+#elif defined(__AVX__)
+#  define GLMC_KERNELS_LEVEL CGLM_SIMD_AVX
+#elif defined(__SSE4_1__)
+#  define GLMC_KERNELS_LEVEL CGLM_SIMD_SSE41
+#elif defined(__SSE__) || defined(__SSE2__)
+#  define GLMC_KERNELS_LEVEL CGLM_SIMD_SSE2
+#elif defined(CGLM_NEON_FP)
+#  define GLMC_KERNELS_LEVEL CGLM_SIMD_NEON
+#else
+#  define GLMC_KERNELS_LEVEL CGLM_SIMD_SCALAR
+#endif
+
+static
+void
+mat4_mul(mat4 m1, mat4 m2, mat4 dest) {
+  glm_mat4_mul(m1, m2, dest);
+}
+
+static
+void
+mat4_mulv(mat4 m, vec4 v, vec4 dest) {
+  glm_mat4_mulv(m, v, dest);
+}
+
+static
+float
+mat4_det(mat4 mat) {
+  return glm_mat4_det(mat);
+}
+
+static
+void
+mat4_inv(mat4 mat, mat4 dest) {
+  glm_mat4_inv(mat, dest);
+}
+
+static
+void
+mat4_inv_fast(mat4 mat, mat4 dest) {
+  glm_mat4_inv_fast(mat, dest);
+}
+
+static
+void
+inv_tr(mat4 mat) {
+  glm_inv_tr(mat);
+}
+
+static
+void
+mat4_mul_batch(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+  glm_mat4_mul_batch(a, b, dest, count);
+}
+
+static
+void
+mat4_mul_batch_stream(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+  glm_mat4_mul_batch_stream(a, b, dest, count);
+}
+
+static
+void
+mat4_mulv_batch(mat4 m, vec4 *v, vec4 *dest, size_t count) {
+  glm_mat4_mulv_batch(m, v, dest, count);
+}
+
+static
+void
+mat4_mulv3_batch(mat4 m, vec3 *v, float last, vec3 *dest, size_t count) {
+  glm_mat4_mulv3_batch(m, v, last, dest, count);
+}
+
+static
+void
+mat4_mulv_batch_soa(mat4 m, float *src[4], float *dest[4], size_t count) {
+  glm_mat4_mulv_batch_soa(m, src, dest, count);
+}
+
+static
+void
+mat4_mulv3_batch_soa(mat4 m, float *src[3], float last, float *dest[3],
+                     size_t count) {
+  glm_mat4_mulv3_batch_soa(m, src, last, dest, count);
+}
+
+static
+void
+mat4_inv_batch(mat4 *mat, mat4 *dest, size_t count) {
+  glm_mat4_inv_batch(mat, dest, count);
+}
+
+static
+void
+mat4_inv_batch_soa(float *src[16], float *dest[16], size_t count) {
+  glm_mat4_inv_batch_soa(src, dest, count);
+}
+
+static
+void
+aabb_frustum_soa(float *center[3], float *extent[3], vec4 planes[6],
+                 uint32_t *mask, size_t count) {
+  glm_aabb_frustum_soa(center, extent, planes, mask, count);
+}
+
+static
+size_t
+aabb_frustum_soa_index(float *center[3], float *extent[3], vec4 planes[6],
+                       uint32_t *indices, size_t count) {
+  return glm_aabb_frustum_soa_index(center, extent, planes, indices, count);
+}
+
+static
+void
+sphere_frustum_soa(float *s[4], vec4 planes[6], uint32_t *mask,
+                   size_t count) {
+  glm_sphere_frustum_soa(s, planes, mask, count);
+}
+
+static
+size_t
+sphere_frustum_soa_index(float *s[4], vec4 planes[6], uint32_t *indices,
+                         size_t count) {
+  return glm_sphere_frustum_soa_index(s, planes, indices, count);
+}
+
+const glmc_simd_table GLMC_CONCAT(glmc_simd_table_, CGLM_KERNELS) = {
+  GLMC_KERNELS_LEVEL,
+
+  mat4_mul,
+  mat4_mulv,
+  mat4_det,
+  mat4_inv,
+  mat4_inv_fast,
+  inv_tr,
+
+  mat4_mul_batch,
+  mat4_mul_batch_stream,
+  mat4_mulv_batch,
+  mat4_mulv3_batch,
+  mat4_mulv_batch_soa,
+  mat4_mulv3_batch_soa,
+  mat4_inv_batch,
+  mat4_inv_batch_soa,
+
+  aabb_frustum_soa,
+  aabb_frustum_soa_index,
+  sphere_frustum_soa,
+  sphere_frustum_soa_index
+};
@@ -7,6 +7,7 @@
 
 #include "../include/cglm/cglm.h"
 #include "../include/cglm/call.h"
+#include "simd.h"
 
 CGLM_EXPORT
 void
@@ -53,7 +54,7 @@ glmc_mat4_ins3(mat3 mat, mat4 dest) {
 CGLM_EXPORT
 void
 glmc_mat4_mul(mat4 m1, mat4 m2, mat4 dest) {
-  glm_mat4_mul(m1, m2, dest);
+  glmc_simd->mat4_mul(m1, m2, dest);
 }
 
 CGLM_EXPORT
@@ -62,10 +63,22 @@ glmc_mat4_mulN(mat4 * __restrict matrices[], uint32_t len, mat4 dest) {
   glm_mat4_mulN(matrices, len, dest);
 }
 
+CGLM_EXPORT
+void
+glmc_mat4_mul_batch(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+  glmc_simd->mat4_mul_batch(a, b, dest, count);
+}
+
+CGLM_EXPORT
+void
+glmc_mat4_mul_batch_stream(mat4 *a, mat4 *b, mat4 *dest, size_t count) {
+  glmc_simd->mat4_mul_batch_stream(a, b, dest, count);
+}
+
 CGLM_EXPORT
 void
 glmc_mat4_mulv(mat4 m, vec4 v, vec4 dest) {
-  glm_mat4_mulv(m, v, dest);
+  glmc_simd->mat4_mulv(m, v, dest);
 }
 
 CGLM_EXPORT
@@ -74,6 +87,31 @@ glmc_mat4_mulv3(mat4 m, vec3 v, float last, vec3 dest) {
   glm_mat4_mulv3(m, v, last, dest);
 }
 
+CGLM_EXPORT
+void
+glmc_mat4_mulv_batch(mat4 m, vec4 *v, vec4 *dest, size_t count) {
+  glmc_simd->mat4_mulv_batch(m, v, dest, count);
+}
+
+CGLM_EXPORT
+void
+glmc_mat4_mulv3_batch(mat4 m, vec3 *v, float last, vec3 *dest, size_t count) {
+  glmc_simd->mat4_mulv3_batch(m, v, last, dest, count);
+}
+
+CGLM_EXPORT
+void
+glmc_mat4_mulv_batch_soa(mat4 m, float *src[4], float *dest[4], size_t count) {
+  glmc_simd->mat4_mulv_batch_soa(m, src, dest, count);
+}
+
+CGLM_EXPORT
+void
+glmc_mat4_mulv3_batch_soa(mat4 m, float *src[3], float last, float *dest[3],
+                          size_t count) {
+  glmc_simd->mat4_mulv3_batch_soa(m, src, last, dest, count);
+}
+
 CGLM_EXPORT
 float
 glmc_mat4_trace(mat4 m) {
@@ -119,25 +157,37 @@ glmc_mat4_scale(mat4 m, float s) {
 CGLM_EXPORT
 float
 glmc_mat4_det(mat4 mat) {
-  return glm_mat4_det(mat);
+  return glmc_simd->mat4_det(mat);
 }
 
 CGLM_EXPORT
 void
 glmc_mat4_inv(mat4 mat, mat4 dest) {
-  glm_mat4_inv(mat, dest);
+  glmc_simd->mat4_inv(mat, dest);
 }
 
 CGLM_EXPORT
 void
 glmc_mat4_inv_precise(mat4 mat, mat4 dest) {
-  glm_mat4_inv_precise(mat, dest);
+  glmc_simd->mat4_inv(mat, dest);
 }
 
 CGLM_EXPORT
 void
 glmc_mat4_inv_fast(mat4 mat, mat4 dest) {
-  glm_mat4_inv_fast(mat, dest);
+  glmc_simd->mat4_inv_fast(mat, dest);
+}
+
+CGLM_EXPORT
+void
+glmc_mat4_inv_batch(mat4 *mat, mat4 *dest, size_t count) {
+  glmc_simd->mat4_inv_batch(mat, dest, count);
+}
+
+CGLM_EXPORT
+void
+glmc_mat4_inv_batch_soa(float *src[16], float *dest[16], size_t count) {
+  glmc_simd->mat4_inv_batch_soa(src, dest, count);
 }
 
 CGLM_EXPORT
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#include "simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && defined(CGLM_SIMD_X86)
+#  include <intrin.h>
+#endif
+
+/*
+ * kernels built for this platform, best last. There are no SSE4.1
+ * or AVX-512 specific kernels, so those levels use the SSE2 and
+ * the AVX2 ones
+ */
+static const glmc_simd_table * const glmc_simd_tables[] = {
+#ifdef CGLM_SIMD_X86
+  &glmc_simd_table_scalar,
+  &glmc_simd_table_sse2,
+  &glmc_simd_table_avx,
+  &glmc_simd_table_avx2
+#else
+  &glmc_simd_table_generic
+#endif
+};
+
+#define GLMC_SIMD_TABLES (sizeof(glmc_simd_tables) / sizeof(glmc_simd_tables[0]))
+
+static const char * const glmc_simd_names[] = {
+  "scalar", "neon", "sse2", "sse4.1", "avx", "avx2", "avx512"
+};
+
+/* until glmc_simd_set runs, the kernels built with the library's own flags,
+   which are safe on any CPU the rest of the library runs on */
+#if !defined(CGLM_SIMD_X86)
+const glmc_simd_table *glmc_simd = &glmc_simd_table_generic;
+#elif defined(__SSE2__)
+const glmc_simd_table *glmc_simd = &glmc_simd_table_sse2;
+#else
+const glmc_simd_table *glmc_simd = &glmc_simd_table_scalar;
+#endif
+
+CGLM_EXPORT
+glmc_simd_level
+glmc_simd_cpu(void) {
+#if defined(CGLM_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+  /* these also check that the OS saves the AVX registers */
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx512f"))
+    return CGLM_SIMD_AVX512;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return CGLM_SIMD_AVX2;
+  if (__builtin_cpu_supports("avx"))
+    return CGLM_SIMD_AVX;
+  if (__builtin_cpu_supports("sse4.1"))
+    return CGLM_SIMD_SSE41;
+  if (__builtin_cpu_supports("sse2"))
+    return CGLM_SIMD_SSE2;
+
+  return CGLM_SIMD_SCALAR;
+#elif defined(CGLM_SIMD_X86) && defined(_MSC_VER)
+  int                info[4], maxLeaf;
+  unsigned long long xcr0;
+  int                ymm, zmm, avx2, avx512;
+
+  __cpuid(info, 0);
+  maxLeaf = info[0];
+
+  __cpuid(info, 1);
+
+  /* OSXSAVE, then which registers the OS saves */
+  xcr0 = (info[2] & (1 << 27)) ? _xgetbv(0) : 0;
+  ymm  = (xcr0 & 0x06) == 0x06;
+  zmm  = (xcr0 & 0xE6) == 0xE6;
+
+  if (!(info[3] & (1 << 26)))
+    return CGLM_SIMD_SCALAR;
+  if (!(info[2] & (1 << 19)))
+    return CGLM_SIMD_SSE2;
+  if (!(info[2] & (1 << 28)) || !ymm)
+    return CGLM_SIMD_SSE41;
+
+  avx2 = avx512 = 0;
+  if (maxLeaf >= 7) {
+    int fma = info[2] & (1 << 12);
+
+    __cpuidex(info, 7, 0);
+    avx2   = fma && (info[1] & (1 << 5));
+    avx512 = zmm && (info[1] & (1 << 16));
+  }
+
+  if (avx2 && avx512)
+    return CGLM_SIMD_AVX512;
+
+  return avx2 ? CGLM_SIMD_AVX2 : CGLM_SIMD_AVX;
+#elif defined(CGLM_NEON_FP)
+  return CGLM_SIMD_NEON;
+#else
+  return CGLM_SIMD_SCALAR;
+#endif
+}
+
+CGLM_EXPORT
+glmc_simd_level
+glmc_simd_get(void) {
+  return glmc_simd->level;
+}
+
+CGLM_EXPORT
+glmc_simd_level
+glmc_simd_set(glmc_simd_level level) {
+  glmc_simd_level cpu;
+  size_t          i;
+
+  cpu = glmc_simd_cpu();
+  if (level > cpu)
+    level = cpu;
+
+  /* the first table is the fallback, even past the level asked for */
+  glmc_simd = glmc_simd_tables[0];
+  for (i = 1; i < GLMC_SIMD_TABLES; i++)
+    if (glmc_simd_tables[i]->level <= level)
+      glmc_simd = glmc_simd_tables[i];
+
+  return glmc_simd->level;
+}
+
+CGLM_EXPORT
+const char *
+glmc_simd_name(glmc_simd_level level) {
+  if ((unsigned)level >= sizeof(glmc_simd_names) / sizeof(glmc_simd_names[0]))
+    return "unknown";
+
+  return glmc_simd_names[level];
+}
+
+/* the best level, or the one in CGLM_SIMD */
+static
+glmc_simd_level
+glmc_simd_requested(void) {
+  const char *name;
+  int         i;
+
+  name = getenv("CGLM_SIMD");
+  if (name)
+    for (i = CGLM_SIMD_AVX512; i >= CGLM_SIMD_SCALAR; i--)
+      if (strcmp(name, glmc_simd_names[i]) == 0)
+        return (glmc_simd_level)i;
+
+  return CGLM_SIMD_AVX512;
+}
+
+/* once at load time. Windows DLLs do it from DllMain */
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((constructor))
+#endif
+void
+glmc_simd_init(void) {
+  glmc_simd_set(glmc_simd_requested());
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c), Recep Aslantas.
+ *
+ * MIT License (MIT), http://opensource.org/licenses/MIT
+ * Full license can be found in the LICENSE file
+ */
+
+#ifndef cglm__simd__h_
+#define cglm__simd__h_
+
+#include "../include/cglm/cglm.h"
+#include "../include/cglm/call/simd.h"
+
+/* x86 builds have a kernels.c object for each of these,
+   others a single generic one built with the default flags */
+#if defined(__x86_64__) || defined(__i386__) \
+ || defined(_M_X64) || defined(_M_IX86)
+#  define CGLM_SIMD_X86 1
+#endif
+
+/* kernels built for one instruction set, by kernels.c */
+typedef struct glmc_simd_table {
+  glmc_simd_level level;
+
+  void  (*mat4_mul)(mat4 m1, mat4 m2, mat4 dest);
+  void  (*mat4_mulv)(mat4 m, vec4 v, vec4 dest);
+  float (*mat4_det)(mat4 mat);
+  void  (*mat4_inv)(mat4 mat, mat4 dest);
+  void  (*mat4_inv_fast)(mat4 mat, mat4 dest);
+  void  (*inv_tr)(mat4 mat);
+
+  void  (*mat4_mul_batch)(mat4 *a, mat4 *b, mat4 *dest, size_t count);
+  void  (*mat4_mul_batch_stream)(mat4 *a, mat4 *b, mat4 *dest,
+                                 size_t count);
+  void  (*mat4_mulv_batch)(mat4 m, vec4 *v, vec4 *dest, size_t count);
+  void  (*mat4_mulv3_batch)(mat4 m, vec3 *v, float last, vec3 *dest,
+                            size_t count);
+  void  (*mat4_mulv_batch_soa)(mat4 m, float *src[4], float *dest[4],
+                               size_t count);
+  void  (*mat4_mulv3_batch_soa)(mat4 m, float *src[3], float last,
+                                float *dest[3], size_t count);
+  void  (*mat4_inv_batch)(mat4 *mat, mat4 *dest, size_t count);
+  void  (*mat4_inv_batch_soa)(float *src[16], float *dest[16], size_t count);
+
+  void   (*aabb_frustum_soa)(float *center[3], float *extent[3],
+                             vec4 planes[6], uint32_t *mask, size_t count);
+  size_t (*aabb_frustum_soa_index)(float *center[3], float *extent[3],
+                                   vec4 planes[6], uint32_t *indices,
+                                   size_t count);
+  void   (*sphere_frustum_soa)(float *s[4], vec4 planes[6], uint32_t *mask,
+                               size_t count);
+  size_t (*sphere_frustum_soa_index)(float *s[4], vec4 planes[6],
+                                     uint32_t *indices, size_t count);
+} glmc_simd_table;
+
+#ifdef CGLM_SIMD_X86
+extern const glmc_simd_table glmc_simd_table_scalar;
+extern const glmc_simd_table glmc_simd_table_sse2;
+extern const glmc_simd_table glmc_simd_table_avx;
+extern const glmc_simd_table glmc_simd_table_avx2;
+#else
+extern const glmc_simd_table glmc_simd_table_generic;
+#endif
+
+/* the kernels in use, never NULL */
+extern const glmc_simd_table *glmc_simd;
+
+/* choose them, from the CPU and CGLM_SIMD */
+void
+glmc_simd_init(void);
+
+#endif /* cglm__simd__h_ */
@@ -7,6 +7,7 @@
 
 #include "../include/cglm/cglm.h"
 #include "../include/cglm/call.h"
+#include "simd.h"
 
 CGLM_EXPORT
 float
@@ -37,3 +38,23 @@ bool
 glmc_sphere_point(vec4 s, vec3 point) {
   return glm_sphere_point(s, point);
 }
+
+CGLM_EXPORT
+bool
+glmc_sphere_frustum(vec4 s, vec4 planes[6]) {
+  return glm_sphere_frustum(s, planes);
+}
+
+CGLM_EXPORT
+void
+glmc_sphere_frustum_soa(float *s[4], vec4 planes[6], uint32_t *mask,
+                        size_t count) {
+  glmc_simd->sphere_frustum_soa(s, planes, mask, count);
+}
+
+CGLM_EXPORT
+size_t
+glmc_sphere_frustum_soa_index(float *s[4], vec4 planes[6], uint32_t *indices,
+                              size_t count) {
+  return glmc_simd->sphere_frustum_soa_index(s, planes, indices, count);
+}
@@ -0,0 +1,677 @@
+/*
+
+Texture cooker.
+
+Converts an image into a KTX file with every mip level,
+block compressed so that it can go to OpenGL as is,
+without decoding at runtime:
+
+	bin/cooker [-bc1 | -bc3 | -bc7] [-nomips] input.png output.ktx
+
+BC1 for opaque images and BC3 for transparent ones, unless told otherwise.
+BC7 looks better but takes a lot longer to cook.
+
+*/
+
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+// Load image onto byte array
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+
+// Same values as in GL/glext.h,
+// so that the cooker doesn't need OpenGL
+#define GL_RGB 0x1907
+#define GL_RGBA 0x1908
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#define GL_COMPRESSED_RGBA_BPTC_UNORM_ARB 0x8E8C
+
+#define MAX_LEVELS 16
+
+
+typedef enum {
+	FORMAT_BC1,
+	FORMAT_BC3,
+	FORMAT_BC7
+} BlockFormat;
+
+typedef struct {
+	unsigned char* pixels;
+	int width, height;
+} Image;
+
+
+
+//
+// Mipmaps
+//
+
+// Half the size, averaging blocks of 2x2 pixels.
+// The half size rounds down, so with odd sizes the last row
+// or column is left out. A side of a single pixel is used twice
+Image downsample( Image source ){
+
+	Image half;
+	half.width = source.width > 1 ? source.width / 2 : 1;
+	half.height = source.height > 1 ? source.height / 2 : 1;
+	half.pixels = (unsigned char*) malloc( half.width * half.height * 4 );
+
+	for ( int y = 0; y < half.height; y++ ){
+
+		int y0 = 2 * y;
+		int y1 = 2 * y + 1 < source.height ? 2 * y + 1 : source.height - 1;
+
+		for ( int x = 0; x < half.width; x++ ){
+
+			int x0 = 2 * x;
+			int x1 = 2 * x + 1 < source.width ? 2 * x + 1 : source.width - 1;
+
+			for ( int c = 0; c < 4; c++ )
+				half.pixels[( y * half.width + x ) * 4 + c] = (
+					source.pixels[( y0 * source.width + x0 ) * 4 + c] +
+					source.pixels[( y0 * source.width + x1 ) * 4 + c] +
+					source.pixels[( y1 * source.width + x0 ) * 4 + c] +
+					source.pixels[( y1 * source.width + x1 ) * 4 + c] +
+					2
+				) >> 2;
+		}
+	}
+
+	return half;
+}
+
+
+
+//
+// Block encoding
+//
+
+// A block of 4x4 pixels. Past the edge of the image,
+// the last row and column are repeated
+void readBlock( Image image, int blockX, int blockY, unsigned char block[16][4] ){
+
+	for ( int y = 0; y < 4; y++ ){
+
+		int imageY = blockY * 4 + y;
+		if ( imageY >= image.height )
+			imageY = image.height - 1;
+
+		for ( int x = 0; x < 4; x++ ){
+
+			int imageX = blockX * 4 + x;
+			if ( imageX >= image.width )
+				imageX = image.width - 1;
+
+			memcpy( block[y * 4 + x], image.pixels + ( imageY * image.width + imageX ) * 4, 4 );
+		}
+	}
+}
+
+// Ends of the line that best fits the pixels of the block,
+// looking at the first channels only.
+// The line goes through the mean along the principal axis,
+// and the ends are the furthest pixels projected onto it
+void fitRange( unsigned char block[16][4], int channels, float start[4], float end[4] ){
+
+	float mean[4] = { 0, 0, 0, 0 };
+
+	for ( int i = 0; i < 16; i++ )
+		for ( int c = 0; c < channels; c++ )
+			mean[c] += block[i][c] / 16.0f;
+
+
+	// Covariance
+
+	float covariance[4][4] = {};
+
+	for ( int i = 0; i < 16; i++ )
+		for ( int a = 0; a < channels; a++ )
+			for ( int b = 0; b < channels; b++ )
+				covariance[a][b] += ( block[i][a] - mean[a] ) * ( block[i][b] - mean[b] );
+
+
+	// Principal axis, by power iteration
+
+	float axis[4] = { 1, 1, 1, 1 };
+
+	for ( int iteration = 0; iteration < 8; iteration++ ){
+
+		float next[4] = { 0, 0, 0, 0 };
+		float length = 0;
+
+		for ( int a = 0; a < channels; a++ ){
+			for ( int b = 0; b < channels; b++ )
+				next[a] += covariance[a][b] * axis[b];
+			if ( next[a] * next[a] > length )
+				length = next[a] * next[a];
+		}
+
+		// Every pixel is the same
+		if ( length == 0 )
+			break;
+
+		for ( int a = 0; a < channels; a++ )
+			axis[a] = next[a] / sqrtf( length );
+	}
+
+
+	// Range of the pixels along it
+
+	float axisLength = 0;
+	for ( int c = 0; c < channels; c++ )
+		axisLength += axis[c] * axis[c];
+
+	float minimum = 0, maximum = 0;
+
+	for ( int i = 0; i < 16; i++ ){
+
+		float t = 0;
+		for ( int c = 0; c < channels; c++ )
+			t += ( block[i][c] - mean[c] ) * axis[c];
+		t /= axisLength;
+
+		if ( t < minimum )
+			minimum = t;
+		if ( t > maximum )
+			maximum = t;
+	}
+
+	for ( int c = 0; c < channels; c++ ){
+		start[c] = mean[c] + axis[c] * minimum;
+		end[c] = mean[c] + axis[c] * maximum;
+
+		if ( start[c] < 0 ) start[c] = 0;
+		if ( start[c] > 255 ) start[c] = 255;
+		if ( end[c] < 0 ) end[c] = 0;
+		if ( end[c] > 255 ) end[c] = 255;
+	}
+}
+
+int colorDistance( const unsigned char* a, const int* b, int channels ){
+
+	int distance = 0;
+
+	for ( int c = 0; c < channels; c++ )
+		distance += ( a[c] - b[c] ) * ( a[c] - b[c] );
+
+	return distance;
+}
+
+uint16_t packRGB565( const float* color ){
+
+	int r = (int) ( color[0] * 31 / 255 + 0.5f );
+	int g = (int) ( color[1] * 63 / 255 + 0.5f );
+	int b = (int) ( color[2] * 31 / 255 + 0.5f );
+
+	return ( r << 11 ) | ( g << 5 ) | b;
+}
+
+void unpackRGB565( uint16_t packed, int* color ){
+
+	int r = ( packed >> 11 ) & 31;
+	int g = ( packed >> 5 ) & 63;
+	int b = packed & 31;
+
+	color[0] = ( r << 3 ) | ( r >> 2 );
+	color[1] = ( g << 2 ) | ( g >> 4 );
+	color[2] = ( b << 3 ) | ( b >> 2 );
+}
+
+// 8 bytes: two RGB565 endpoints and 2 bit indices
+// into them and the two colors in between
+void encodeBC1( unsigned char block[16][4], unsigned char* out ){
+
+	float start[4], end[4];
+	fitRange( block, 3, start, end );
+
+	uint16_t color0 = packRGB565( end );
+	uint16_t color1 = packRGB565( start );
+
+	// color0 > color1 selects four colors rather than three and transparent
+	if ( color0 < color1 ){
+		uint16_t swap = color0;
+		color0 = color1;
+		color1 = swap;
+	}
+
+	int palette[4][3];
+	unpackRGB565( color0, palette[0] );
+	unpackRGB565( color1, palette[1] );
+
+	for ( int c = 0; c < 3; c++ ){
+		palette[2][c] = ( 2 * palette[0][c] + palette[1][c] ) / 3;
+		palette[3][c] = ( palette[0][c] + 2 * palette[1][c] ) / 3;
+	}
+
+	uint32_t indices = 0;
+
+	if ( color0 != color1 ){
+		for ( int i = 0; i < 16; i++ ){
+
+			int best = 0;
+			int bestDistance = colorDistance( block[i], palette[0], 3 );
+
+			for ( int p = 1; p < 4; p++ ){
+				int distance = colorDistance( block[i], palette[p], 3 );
+				if ( distance < bestDistance ){
+					best = p;
+					bestDistance = distance;
+				}
+			}
+
+			indices |= best << ( 2 * i );
+		}
+	}
+
+	out[0] = color0 & 0xFF;
+	out[1] = color0 >> 8;
+	out[2] = color1 & 0xFF;
+	out[3] = color1 >> 8;
+	for ( int i = 0; i < 4; i++ )
+		out[4 + i] = ( indices >> ( 8 * i ) ) & 0xFF;
+}
+
+// 8 bytes: two alpha endpoints and 3 bit indices
+// into them and the six values in between
+void encodeAlpha( unsigned char block[16][4], unsigned char* out ){
+
+	int alpha0 = 0, alpha1 = 255;
+
+	for ( int i = 0; i < 16; i++ ){
+		if ( block[i][3] > alpha0 )
+			alpha0 = block[i][3];
+		if ( block[i][3] < alpha1 )
+			alpha1 = block[i][3];
+	}
+
+	int palette[8];
+	palette[0] = alpha0;
+	palette[1] = alpha1;
+	for ( int p = 2; p < 8; p++ )
+		palette[p] = ( ( 8 - p ) * alpha0 + ( p - 1 ) * alpha1 ) / 7;
+
+	uint64_t indices = 0;
+
+	if ( alpha0 != alpha1 ){
+		for ( int i = 0; i < 16; i++ ){
+
+			int best = 0;
+			int bestDistance = abs( block[i][3] - palette[0] );
+
+			for ( int p = 1; p < 8; p++ ){
+				int distance = abs( block[i][3] - palette[p] );
+				if ( distance < bestDistance ){
+					best = p;
+					bestDistance = distance;
+				}
+			}
+
+			indices |= (uint64_t) best << ( 3 * i );
+		}
+	}
+
+	out[0] = alpha0;
+	out[1] = alpha1;
+	for ( int i = 0; i < 6; i++ )
+		out[2 + i] = ( indices >> ( 8 * i ) ) & 0xFF;
+}
+
+// 16 bytes: alpha, then color as in BC1
+void encodeBC3( unsigned char block[16][4], unsigned char* out ){
+
+	encodeAlpha( block, out );
+	encodeBC1( block, out + 8 );
+}
+
+
+// Writes fields of a 128 bit block, lowest bits first
+typedef struct {
+	unsigned char* out;
+	int position;
+} BitWriter;
+
+void writeBits( BitWriter * writer, unsigned int value, int bits ){
+
+	for ( int i = 0; i < bits; i++, writer->position++ )
+		if ( value & ( 1 << i ) )
+			writer->out[writer->position / 8] |= 1 << ( writer->position % 8 );
+}
+
+// Seven bits per channel and a bit shared by all four,
+// choosing the shared bit that is closest
+void quantizeBC7Endpoint( const float* color, int* quantized, int* pBit ){
+
+	int bestError = -1;
+
+	for ( int p = 0; p < 2; p++ ){
+
+		int values[4];
+		int error = 0;
+
+		for ( int c = 0; c < 4; c++ ){
+
+			int value = (int) ( ( color[c] - p ) / 2 + 0.5f );
+			if ( value < 0 ) value = 0;
+			if ( value > 127 ) value = 127;
+
+			int reconstructed = ( value << 1 ) | p;
+			error += ( reconstructed - color[c] ) * ( reconstructed - color[c] );
+			values[c] = value;
+		}
+
+		if ( bestError < 0 || error < bestError ){
+			bestError = error;
+			memcpy( quantized, values, sizeof( values ) );
+			*pBit = p;
+		}
+	}
+}
+
+// 16 bytes in mode 6: a single pair of RGBA endpoints
+// and 4 bit indices into the sixteen colors between them
+void encodeBC7( unsigned char block[16][4], unsigned char* out ){
+
+	static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	float start[4], end[4];
+	fitRange( block, 4, start, end );
+
+	int endpoints[2][4], pBits[2];
+	quantizeBC7Endpoint( start, endpoints[0], &pBits[0] );
+	quantizeBC7Endpoint( end, endpoints[1], &pBits[1] );
+
+
+	// Pick the closest color for each pixel
+
+	int palette[16][4];
+
+	for ( int p = 0; p < 16; p++ ){
+		for ( int c = 0; c < 4; c++ ){
+			int color0 = ( endpoints[0][c] << 1 ) | pBits[0];
+			int color1 = ( endpoints[1][c] << 1 ) | pBits[1];
+			palette[p][c] = ( ( 64 - weights[p] ) * color0 + weights[p] * color1 + 32 ) >> 6;
+		}
+	}
+
+	int indices[16];
+
+	for ( int i = 0; i < 16; i++ ){
+
+		indices[i] = 0;
+		int bestDistance = colorDistance( block[i], palette[0], 4 );
+
+		for ( int p = 1; p < 16; p++ ){
+			int distance = colorDistance( block[i], palette[p], 4 );
+			if ( distance < bestDistance ){
+				indices[i] = p;
+				bestDistance = distance;
+			}
+		}
+	}
+
+
+	// The first index is stored without its top bit,
+	// so it has to be below 8. Swapping the endpoints flips them all
+
+	if ( indices[0] >= 8 ){
+
+		for ( int c = 0; c < 4; c++ ){
+			int swap = endpoints[0][c];
+			endpoints[0][c] = endpoints[1][c];
+			endpoints[1][c] = swap;
+		}
+
+		int swap = pBits[0];
+		pBits[0] = pBits[1];
+		pBits[1] = swap;
+
+		for ( int i = 0; i < 16; i++ )
+			indices[i] = 15 - indices[i];
+	}
+
+
+	memset( out, 0, 16 );
+	BitWriter writer = { out, 0 };
+
+	// Mode 6, as a 1 after six 0
+	writeBits( &writer, 1 << 6, 7 );
+
+	for ( int c = 0; c < 4; c++ ){
+		writeBits( &writer, endpoints[0][c], 7 );
+		writeBits( &writer, endpoints[1][c], 7 );
+	}
+
+	writeBits( &writer, pBits[0], 1 );
+	writeBits( &writer, pBits[1], 1 );
+
+	writeBits( &writer, indices[0], 3 );
+	for ( int i = 1; i < 16; i++ )
+		writeBits( &writer, indices[i], 4 );
+}
+
+// Every block of the image, left to right and bottom to top
+unsigned char* encode( Image image, BlockFormat format, unsigned int * size ){
+
+	int blocksWide = ( image.width + 3 ) / 4;
+	int blocksHigh = ( image.height + 3 ) / 4;
+	int blockSize = format == FORMAT_BC1 ? 8 : 16;
+
+	*size = blocksWide * blocksHigh * blockSize;
+	unsigned char* blocks = (unsigned char*) malloc( *size );
+	unsigned char* out = blocks;
+
+	unsigned char block[16][4];
+
+	for ( int y = 0; y < blocksHigh; y++ ){
+		for ( int x = 0; x < blocksWide; x++ ){
+
+			readBlock( image, x, y, block );
+
+			switch ( format ){
+				case FORMAT_BC1: encodeBC1( block, out ); break;
+				case FORMAT_BC3: encodeBC3( block, out ); break;
+				case FORMAT_BC7: encodeBC7( block, out ); break;
+			}
+
+			out += blockSize;
+		}
+	}
+
+	return blocks;
+}
+
+
+
+//
+// KTX
+//
+
+// KTX 1.1 header, after the identifier
+typedef struct {
+	uint32_t endianness;
+	uint32_t glType;
+	uint32_t glTypeSize;
+	uint32_t glFormat;
+	uint32_t glInternalFormat;
+	uint32_t glBaseInternalFormat;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t numberOfArrayElements;
+	uint32_t numberOfFaces;
+	uint32_t numberOfMipmapLevels;
+	uint32_t bytesOfKeyValueData;
+} KtxHeader;
+
+static const unsigned char ktxIdentifier[12] = {
+	0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'
+};
+
+// Rows go from the bottom up, as images are flipped when loaded.
+// Key and value, each ending in a 0
+static const char ktxOrientation[] = "KTXorientation\0S=r,T=u";
+
+bool writeKtx( const char* filePath, Image* levels, int levelCount, BlockFormat format ){
+
+	FILE * f = fopen( filePath, "wb" );
+
+	if ( !f )
+		return false;
+
+	KtxHeader header;
+	memset( &header, 0, sizeof( header ) );
+
+	header.endianness = 0x04030201;
+	// Compressed, so no type or format
+	header.glTypeSize = 1;
+	header.glInternalFormat =
+		format == FORMAT_BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT :
+		format == FORMAT_BC3 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT :
+		GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+	header.glBaseInternalFormat = format == FORMAT_BC1 ? GL_RGB : GL_RGBA;
+	header.pixelWidth = levels[0].width;
+	header.pixelHeight = levels[0].height;
+	header.numberOfFaces = 1;
+	header.numberOfMipmapLevels = levelCount;
+
+	// Its size, then the pair, padded to 4 bytes
+	uint32_t keyAndValueByteSize = sizeof( ktxOrientation );
+	uint32_t padding = 3 - ( keyAndValueByteSize + 3 ) % 4;
+	const unsigned char zeroes[3] = { 0, 0, 0 };
+	header.bytesOfKeyValueData = sizeof( keyAndValueByteSize ) + keyAndValueByteSize + padding;
+
+	fwrite( ktxIdentifier, 1, sizeof( ktxIdentifier ), f );
+	fwrite( &header, 1, sizeof( header ), f );
+	fwrite( &keyAndValueByteSize, 1, sizeof( keyAndValueByteSize ), f );
+	fwrite( ktxOrientation, 1, keyAndValueByteSize, f );
+	fwrite( zeroes, 1, padding, f );
+
+	// Each level is its size, then its blocks.
+	// Blocks are 8 or 16 bytes, so no padding is needed
+	for ( int level = 0; level < levelCount; level++ ){
+
+		unsigned int size;
+		unsigned char* blocks = encode( levels[level], format, &size );
+
+		uint32_t imageSize = size;
+		fwrite( &imageSize, 1, sizeof( imageSize ), f );
+		fwrite( blocks, 1, size, f );
+
+		free( blocks );
+	}
+
+	bool written = !ferror( f );
+	fclose( f );
+
+	return written;
+}
+
+
+
+//
+// Main
+//
+
+void usage(){
+
+	printf( "Usage: cooker [-bc1 | -bc3 | -bc7] [-nomips] input output.ktx\n" );
+}
+
+int main( int argc, char** argv ){
+
+	const char* input = NULL;
+	const char* output = NULL;
+	int format = -1;
+	bool mipmaps = true;
+
+	for ( int i = 1; i < argc; i++ ){
+
+		if ( !strcmp( argv[i], "-bc1" ) )
+			format = FORMAT_BC1;
+		else if ( !strcmp( argv[i], "-bc3" ) )
+			format = FORMAT_BC3;
+		else if ( !strcmp( argv[i], "-bc7" ) )
+			format = FORMAT_BC7;
+		else if ( !strcmp( argv[i], "-nomips" ) )
+			mipmaps = false;
+		else if ( input == NULL )
+			input = argv[i];
+		else if ( output == NULL )
+			output = argv[i];
+		else{
+			usage();
+			return 1;
+		}
+	}
+
+	if ( input == NULL || output == NULL ){
+		usage();
+		return 1;
+	}
+
+
+	// Bottom row first, as OpenGL expects it
+	// and as the runtime loads other images
+
+	stbi_set_flip_vertically_on_load( true );
+
+	Image levels[MAX_LEVELS];
+	int channels;
+
+	levels[0].pixels = stbi_load( input, &levels[0].width, &levels[0].height, &channels, 4 );
+
+	if ( levels[0].pixels == NULL ){
+		printf( "Could not load %s: %s\n", input, stbi_failure_reason() );
+		return 1;
+	}
+
+
+	// Without a format given, BC1 unless some pixel is transparent
+
+	if ( format < 0 ){
+
+		format = FORMAT_BC1;
+
+		for ( int i = 0; i < levels[0].width * levels[0].height; i++ )
+			if ( levels[0].pixels[i * 4 + 3] != 255 ){
+				format = FORMAT_BC3;
+				break;
+			}
+	}
+
+
+	int levelCount = 1;
+
+	while ( mipmaps && levelCount < MAX_LEVELS &&
+		( levels[levelCount - 1].width > 1 || levels[levelCount - 1].height > 1 ) ){
+
+		levels[levelCount] = downsample( levels[levelCount - 1] );
+		levelCount++;
+	}
+
+	if ( !writeKtx( output, levels, levelCount, (BlockFormat) format ) ){
+		printf( "Could not write %s\n", output );
+		return 1;
+	}
+
+	printf(
+		"%s: %dx%d, %d levels, %s\n",
+		output,
+		levels[0].width, levels[0].height,
+		levelCount,
+		format == FORMAT_BC1 ? "BC1" : format == FORMAT_BC3 ? "BC3" : "BC7"
+	);
+
+	stbi_image_free( levels[0].pixels );
+	for ( int level = 1; level < levelCount; level++ )
+		free( levels[level].pixels );
+
+	return 0;
+}
@@ -33,10 +33,22 @@ Iiiiin the future! Unrealistic plans of future additions:
 #endif
 
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
 #include <ctype.h>
 #include <unistd.h>
+#include <pthread.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 // OpenGL and windowing
 #include <GL/glew.h>
@@ -55,10 +67,67 @@ Iiiiin the future! Unrealistic plans of future additions:
 
 
 // Primitive error handling
+//
+// GLCall can work in three ways, selectable at runtime
+// with the MINIMUM_GL_ERRORS environment variable
+// ("immediate", "deferred" or "debug"):
+//
+//	immediate:	glGetError before and after every call.
+//				Slow, since it makes the driver sync each time,
+//				but it points exactly at the failing call.
+//	deferred:	every call only records where it was made
+//				in a ring buffer, and errors are checked once per frame.
+//				When an error shows up, the recorded calls are printed
+//				and we switch to immediate mode to pinpoint the culprit.
+//	debug:		like deferred, but errors are reported right away
+//				through a KHR_debug callback, if the context supports it.
+//
+// The default is chosen at build time with GL_ERROR_MODE_DEFAULT,
+// and defining GL_ERROR_CHECKS_DISABLED removes all checks.
+
+#define GL_ERRORS_IMMEDIATE 0
+#define GL_ERRORS_DEFERRED 1
+#define GL_ERRORS_DEBUG 2
+
+#ifndef GL_ERROR_MODE_DEFAULT
+#define GL_ERROR_MODE_DEFAULT GL_ERRORS_DEFERRED
+#endif
+
+// Must be a power of two
+#define GL_CALL_RING_SIZE 64
+
+#ifdef GL_ERROR_CHECKS_DISABLED
+
+#define GLCall(x) do { x; } while ( 0 )
+
+#else
+
+// A single statement, so it is safe as the body of an if or a loop
+#define GLCall(x) do {\
+		if ( glErrorMode == GL_ERRORS_IMMEDIATE )\
+			GLClearError();\
+		else\
+			GLRecordCall( #x, __FILE__, __LINE__ );\
+		x;\
+		if ( glErrorMode == GL_ERRORS_IMMEDIATE )\
+			GLLogCall( #x, __FILE__, __LINE__ );\
+	} while ( 0 )
+
+#endif
+
 
-#define GLCall(x) GLClearError();\
-	x;\
-	GLLogCall( #x, __FILE__, __LINE__ )
+// Where a GL call was made from
+typedef struct {
+	const char* functionName;
+	const char* fileName;
+	int line;
+} GLCallSite;
+
+static int glErrorMode = GL_ERROR_MODE_DEFAULT;
+
+// Last calls made, for the deferred and debug modes
+static GLCallSite glCallRing[GL_CALL_RING_SIZE];
+static unsigned int glCallCount = 0;
 
 // Clear error stack
 static void GLClearError(){
@@ -83,9 +152,313 @@ static bool GLLogCall( const char* functionName, const char* fileName, int line
 	return true;
 }
 
+// Remember the call that is about to be made.
+// Cheap enough to be done for every call
+static inline void GLRecordCall( const char* functionName, const char* fileName, int line ){
+
+	GLCallSite * site = &glCallRing[glCallCount & ( GL_CALL_RING_SIZE - 1 )];
+
+	site->functionName = functionName;
+	site->fileName = fileName;
+	site->line = line;
+	glCallCount++;
+}
+
+// Print the calls recorded since the last check, most recent last
+static void GLPrintRecordedCalls( unsigned int since ){
+
+	unsigned int first = since;
+
+	if ( glCallCount - first > GL_CALL_RING_SIZE ){
+		printf( "\t(%u older calls not recorded)\n", glCallCount - first - GL_CALL_RING_SIZE );
+		first = glCallCount - GL_CALL_RING_SIZE;
+	}
+
+	for ( unsigned int i = first; i < glCallCount; i++ ){
+		GLCallSite * site = &glCallRing[i & ( GL_CALL_RING_SIZE - 1 )];
+		printf( "\t%s\n\t\tat line %d in file %s\n", site->functionName, site->line, site->fileName );
+	}
+}
+
+// Called by the driver while the failing call is still running,
+// so the last recorded call is the one that caused the error
+static void GLAPIENTRY GLDebugCallback(
+	GLenum source, GLenum type, GLuint id, GLenum severity,
+	GLsizei length, const GLchar* message, const void* userParam ){
+
+	if ( type != GL_DEBUG_TYPE_ERROR )
+		return;
+
+	printf( "OpenGL error: %s\n", message );
+
+	if ( glCallCount > 0 ){
+		GLCallSite * site = &glCallRing[( glCallCount - 1 ) & ( GL_CALL_RING_SIZE - 1 )];
+		printf( "\t%s\n\tat line %d\n\tin file %s\n", site->functionName, site->line, site->fileName );
+	}
+
+	exit( -1 );
+}
+
+// Choose the error mode.
+// Done before creating the window, which needs to know
+// whether it has to be a debug context
+static void GLReadErrorMode(){
+
+	const char* mode = getenv( "MINIMUM_GL_ERRORS" );
+
+	if ( mode != NULL ){
+		if ( strcmp( mode, "immediate" ) == 0 )
+			glErrorMode = GL_ERRORS_IMMEDIATE;
+		else if ( strcmp( mode, "deferred" ) == 0 )
+			glErrorMode = GL_ERRORS_DEFERRED;
+		else if ( strcmp( mode, "debug" ) == 0 )
+			glErrorMode = GL_ERRORS_DEBUG;
+		else
+			printf( "Unknown error mode %s, using the default one.\n", mode );
+	}
+}
+
+// Set up the chosen error mode, once the context has been created
+static void GLInitErrorChecking(){
+
+	if ( glErrorMode == GL_ERRORS_DEBUG ){
+		if ( GLEW_KHR_debug ){
+			glEnable( GL_DEBUG_OUTPUT );
+			// Make the callback run inside the failing call
+			glEnable( GL_DEBUG_OUTPUT_SYNCHRONOUS );
+			glDebugMessageCallback( GLDebugCallback, NULL );
+		}
+		else {
+			printf( "KHR_debug is not available, checking errors once per frame.\n" );
+			glErrorMode = GL_ERRORS_DEFERRED;
+		}
+	}
+
+	GLClearError();
+}
+
+// Check for errors made since the last frame.
+// Only does something in deferred mode
+static void GLCheckFrameErrors(){
+
+	static unsigned int lastCheckedCall = 0;
+
+	if ( glErrorMode == GL_ERRORS_DEFERRED ){
+
+		GLenum error = glGetError();
+
+		if ( error != GL_NO_ERROR ){
+			printf( "OpenGL error %d in one of these calls:\n", error );
+			GLPrintRecordedCalls( lastCheckedCall );
+
+			// Check every call from now on, to find the exact one
+			GLClearError();
+			glErrorMode = GL_ERRORS_IMMEDIATE;
+			printf( "Switching to immediate error checking.\n" );
+		}
+	}
+
+	lastCheckedCall = glCallCount;
+}
+
+
+// Read only view of a whole file.
+// Mapped into memory where possible, so that nothing is copied,
+// and read into a buffer where it isn't.
+// Not null terminated
+typedef struct {
+	const unsigned char* data;
+	size_t size;
+	// Whether data is mapped, or a buffer to free
+	bool mapped;
+} FileView;
+
+// False if the file can't be read
+bool mapFile( FileView * view, const char* filePath );
+
+void unmapFile( FileView * view );
+
+// FNV-1a, 64 bits to make collisions between files unlikely.
+// Several buffers can be hashed together, passing on the hash
+#define HASH_SEED 14695981039346656037ull
+uint64_t hashBytes( const void* bytes, size_t size, uint64_t hash = HASH_SEED );
+
+
 
-// Store a text file into a string
-char* readFile( char* filePath );
+//
+// GL state cache
+//
+// Remembers what is bound, so that binding
+// the same object again doesn't reach the driver.
+// Every bind in the program has to go through here
+// for the cache to stay right
+//
+
+#define STATE_CACHE_TEXTURE_UNITS 32
+#define STATE_CACHE_UNIFORM_BINDINGS 8
+
+// Stands for a binding we don't know
+#define STATE_CACHE_UNKNOWN 0xFFFFFFFF
+
+// Buffer targets and texture targets being tracked
+static const GLenum stateCacheBufferTargets[] = {
+	GL_ARRAY_BUFFER,
+	GL_ELEMENT_ARRAY_BUFFER,
+	GL_UNIFORM_BUFFER,
+	GL_PIXEL_UNPACK_BUFFER,
+	GL_DRAW_INDIRECT_BUFFER,
+	GL_COPY_READ_BUFFER,
+	GL_COPY_WRITE_BUFFER
+};
+#define STATE_CACHE_BUFFER_TARGETS 7
+
+static const GLenum stateCacheTextureTargets[] = {
+	GL_TEXTURE_2D,
+	GL_TEXTURE_2D_ARRAY
+};
+#define STATE_CACHE_TEXTURE_TARGETS 2
+
+// Calls that reached the driver and calls that were dropped
+typedef struct {
+	unsigned int issued;
+	unsigned int saved;
+} StateCacheStats;
+
+// A range bound to an indexed binding point
+typedef struct {
+	GLuint buffer;
+	GLintptr offset;
+	GLsizeiptr size;
+} StateCacheBufferRange;
+
+typedef struct {
+	GLuint program;
+	GLuint vertexArray;
+	GLuint buffers[STATE_CACHE_BUFFER_TARGETS];
+	StateCacheBufferRange uniformBindings[STATE_CACHE_UNIFORM_BINDINGS];
+	GLuint activeTextureUnit;
+	GLuint textures[STATE_CACHE_TEXTURE_UNITS][STATE_CACHE_TEXTURE_TARGETS];
+	StateCacheStats frame;
+} StateCache;
+
+void stateUseProgram( GLuint program );
+
+void stateBindVertexArray( GLuint vertexArray );
+
+void stateBindBuffer( GLenum target, GLuint buffer );
+
+// Part of a buffer to an indexed binding point of GL_UNIFORM_BUFFER.
+// It is also left bound to the target itself
+void stateBindBufferRange( GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size );
+
+// Bind to the given slot, or to the active one
+void stateBindTexture( GLuint slot, GLenum target, GLuint texture );
+void stateBindTexture( GLenum target, GLuint texture );
+
+// Objects about to be deleted, which GL unbinds by itself
+void stateForgetBuffer( GLuint buffer );
+void stateForgetTexture( GLuint texture );
+
+// Get the stats of the frame that just finished,
+// and start counting again
+StateCacheStats nextStateCacheFrame();
+
+
+
+//
+// Profiler
+//
+// CPU scopes are timed with the monotonic clock, and can be nested.
+// GPU scopes are timed with GL_TIME_ELAPSED queries, which can't,
+// so only one GPU scope can be open at a time, and only once per frame.
+// Each GPU scope has a query for every frame in flight, and its result
+// is read when the query comes round again, PROFILER_QUERY_BUFFERS frames later,
+// so that reading it doesn't stall. Results still not ready then are waited for,
+// as they are the slowest frames, which percentiles can't leave out.
+//
+// Times of the last PROFILER_HISTORY frames are kept for percentiles,
+// and the last PROFILER_TRACE_EVENTS scopes for a Chrome trace,
+// to be opened in chrome://tracing or ui.perfetto.dev
+//
+
+#define PROFILER_MAX_SCOPES 32
+#define PROFILER_QUERY_BUFFERS 4
+// Must be powers of two
+#define PROFILER_HISTORY 512
+#define PROFILER_TRACE_EVENTS 16384
+
+typedef struct {
+	const char* name;
+	bool gpu;
+
+	// CPU only: time spent in the scope this frame,
+	// as it may be entered more than once
+	uint64_t start;
+	uint64_t frameTime;
+	bool entered;
+
+	// GPU only: a query for each frame in flight,
+	// and when it was issued
+	GLuint queries[PROFILER_QUERY_BUFFERS];
+	uint64_t queryStarts[PROFILER_QUERY_BUFFERS];
+	bool queryIssued[PROFILER_QUERY_BUFFERS];
+
+	// Milliseconds of the last frames
+	float history[PROFILER_HISTORY];
+	unsigned int historyCount;
+} ProfilerScope;
+
+// A scope as it ran, in nanoseconds since the profiler started
+typedef struct {
+	unsigned int scope;
+	uint64_t start;
+	uint64_t duration;
+} ProfilerEvent;
+
+typedef struct {
+	ProfilerScope scopes[PROFILER_MAX_SCOPES];
+	unsigned int scopeCount;
+
+	unsigned int frame;
+	// -1 when there is none
+	int openGpuScope;
+	// GPU results that weren't ready when read
+	unsigned int lateQueries;
+
+	uint64_t startTime;
+	// Ring of the last events
+	ProfilerEvent * events;
+	unsigned int eventCount;
+} Profiler;
+
+// Of a scope over the last frames, in milliseconds
+typedef struct {
+	float p50;
+	float p95;
+	float p99;
+	float max;
+} ProfilerStats;
+
+void init( Profiler * profiler );
+
+// Returns the index to begin and end the scope with
+unsigned int addScope( Profiler * profiler, const char* name, bool gpu = false );
+
+void begin( Profiler * profiler, unsigned int scope );
+void end( Profiler * profiler, unsigned int scope );
+
+// Keep the times of the frame that just finished,
+// and read the GPU times that have come back.
+// Called once per frame, outside of every scope
+void nextFrame( Profiler * profiler );
+
+ProfilerStats getStats( Profiler * profiler, unsigned int scope );
+
+void printStats( Profiler * profiler );
+
+// Write the recorded events in Chrome's trace event format.
+// False if the file can't be written
+bool exportTrace( Profiler * profiler, const char* path );
 
 
 
@@ -93,11 +466,93 @@ char* readFile( char* filePath );
 // Renderer objects
 //
 
+// Buffer for data written again every frame.
+//
+// With the fenced modes, it is a ring of STREAM_RING_REGIONS regions,
+// one for each frame the GPU may still be working on.
+// The region of a frame is fenced when the frame ends,
+// and that fence is waited on before writing it again,
+// so writes never have to wait for the driver otherwise.
+// The other modes use a single region,
+// and are there mostly to compare against
+
+#define STREAM_RING_REGIONS 3
+
+typedef enum {
+	// glBufferSubData from client memory
+	STREAM_SUB_DATA,
+	// New storage for the buffer every frame, then glBufferSubData
+	STREAM_ORPHAN,
+	// glMapBufferRange with no implicit sync, guarded by fences
+	STREAM_MAP_UNSYNCHRONIZED,
+	// Mapped only once, with glBufferStorage, guarded by fences.
+	// Needs ARB_buffer_storage, falls back to the previous one
+	STREAM_PERSISTENT
+} StreamMode;
+
+typedef struct {
+	GLuint rendererId;
+	GLenum target;
+	StreamMode mode;
+	unsigned int regionSize;
+	unsigned int alignment;
+
+	// Region being written this frame,
+	// and how much of it has been handed out
+	unsigned int region;
+	unsigned int used;
+	GLsync fences[STREAM_RING_REGIONS];
+
+	// Where writes go before reaching the buffer,
+	// for the modes that don't map it
+	char* staging;
+	// The whole buffer, for the persistent mode
+	char* persistentData;
+
+	// Write in progress
+	unsigned int writeOffset;
+	unsigned int writeSize;
+} BufferRing;
+
+void init( BufferRing * ring, GLenum target, unsigned int regionSize, StreamMode mode, unsigned int alignment = 16 );
+
+// Get memory to write size bytes into.
+// offset gets where they will be in the buffer.
+// Returns NULL if this frame's region is full
+void* beginWrite( BufferRing * ring, unsigned int size, unsigned int * offset );
+void endWrite( BufferRing * ring );
+
+// Whether size more bytes fit in this frame's region
+bool hasRoom( BufferRing * ring, unsigned int size );
+
+// The frame using the current region has been submitted
+void nextFrame( BufferRing * ring );
+
+// Delete the buffer, once the GPU is done with it
+void destroy( BufferRing * ring );
+
+
 typedef struct {
 	GLuint rendererId;
+	unsigned int size;
+	// Only for streaming buffers
+	BufferRing * ring;
 } VertexBuffer;
 
-void init( VertexBuffer * vertexBuffer, unsigned int size, const void* data );
+void init( VertexBuffer * vertexBuffer, unsigned int size, const void* data, GLenum usage = GL_STATIC_DRAW );
+
+// Streaming vertex buffer,
+// with room for regionSize bytes every frame
+void init( VertexBuffer * vertexBuffer, unsigned int regionSize, StreamMode mode );
+
+// Replace part of the data of a non streaming buffer
+void update( VertexBuffer * vertexBuffer, unsigned int offset, unsigned int size, const void* data );
+
+// Same as for BufferRing, for streaming vertex buffers.
+// Draws using the written vertices start at offset / stride
+void* beginWrite( VertexBuffer * vertexBuffer, unsigned int size, unsigned int * offset );
+void endWrite( VertexBuffer * vertexBuffer );
+void nextFrame( VertexBuffer * vertexBuffer );
 
 void bind( VertexBuffer * vertexBuffer );
 void unbind(  VertexBuffer * vertexBuffer  );
@@ -106,6 +561,7 @@ void unbind(  VertexBuffer * vertexBuffer  );
 typedef struct {
 	GLuint rendererId;
 	unsigned int size;
+	unsigned int count;
 } IndexBuffer;
 
 void init( IndexBuffer * indexBuffer, unsigned int size, const GLuint* data );
@@ -124,15 +580,20 @@ typedef struct {
 } VertexBufferLayoutElement;
 
 
-// Which elements are stored in each position of a vertex buffer
+// Which elements are stored in each position of a vertex buffer.
+// Elements with more than 4 components, like matrices,
+// take one attribute location for every 4 of them
 typedef struct {
 	VertexBufferLayoutElement * elements;
 	unsigned int elementCount;
 	unsigned int reservedElements;
 	unsigned int stride;
+	// 0 to advance once per vertex,
+	// n to advance once every n instances
+	GLuint divisor;
 } VertexBufferLayout;
 
-void init( VertexBufferLayout * vertexBufferLayout );
+void init( VertexBufferLayout * vertexBufferLayout, GLuint divisor = 0 );
 
 void push( VertexBufferLayout * vertexBufferLayout, unsigned int count, GLenum type );
 
@@ -144,6 +605,8 @@ typedef struct {
 	VertexBuffer * vertexBuffers;
 	unsigned int vertexBufferCount;
 	unsigned int reservedVertexBuffers;
+	// Next attribute location to be used
+	unsigned int attributeCount;
 } VertexArray;
 
 void init( VertexArray * vertexArray );
@@ -152,17 +615,140 @@ void bind( VertexArray * vertexArray );
 
 void unbind( VertexArray * vertexArray );
 
+// Each pushed buffer takes the attribute locations
+// right after the ones of the previous buffer
 void push( VertexArray * vertexArray, VertexBuffer * buffer, VertexBufferLayout * layout );
 
 
+// Range of free space in an arena buffer
+typedef struct {
+	unsigned int offset;
+	unsigned int size;
+} ArenaRange;
+
+// Free space of an arena buffer, sorted by offset
+typedef struct {
+	ArenaRange * ranges;
+	unsigned int rangeCount;
+	unsigned int reservedRanges;
+	unsigned int capacity;
+} ArenaFreeList;
+
+// A mesh stored in an arena.
+// Counted in vertices and indices, not in bytes
+typedef struct {
+	unsigned int firstVertex;
+	unsigned int vertexCount;
+	unsigned int firstIndex;
+	unsigned int indexCount;
+} ArenaMesh;
+
+// Big vertex and index buffers shared by many meshes
+// with the same vertex layout, so that the renderer
+// can draw all of them in a single call.
+// Mesh indices start at 0 for their own first vertex
+typedef struct {
+	VertexArray * vertexArray;
+	VertexBuffer * vertexBuffer;
+	IndexBuffer * indexBuffer;
+	VertexBufferLayout * layout;
+
+	ArenaFreeList freeVertices;
+	ArenaFreeList freeIndices;
+
+	ArenaMesh ** meshes;
+	unsigned int meshCount;
+	unsigned int reservedMeshes;
+} MeshArena;
+
+void init( MeshArena * arena, VertexBufferLayout * layout, unsigned int vertexCapacity, unsigned int indexCapacity );
+
+// Copy a mesh into the arena.
+// Returns NULL if it doesn't fit even after compacting
+ArenaMesh * add(
+	MeshArena * arena,
+	const void* vertices,
+	unsigned int vertexCount,
+	const GLuint* indices,
+	unsigned int indexCount
+);
+
+void release( MeshArena * arena, ArenaMesh * mesh );
+
+// Move every mesh to the start of the buffers,
+// joining all the free space in a single range
+void compact( MeshArena * arena );
+
+
+// Active uniform of a shader program.
+// Keeps the last value written to it,
+// so that writes which change nothing can be skipped
+typedef struct {
+	char* name;
+	GLint location;
+	GLenum type;
+	GLint size;
+	bool hasValue;
+	union {
+		GLint i[4];
+		GLfloat f[16];
+	} value;
+} ShaderUniform;
+
 // Shader object
 typedef struct {
 	GLuint rendererId;
+
+	// Uniform table, built once the program is linked
+	ShaderUniform * uniforms;
+	unsigned int uniformCount;
+	// Hash table of indices into uniforms, by name
+	int * uniformSlots;
+	unsigned int uniformSlotCount;
+	// Indices into uniforms, by location
+	int * uniformsByLocation;
+	GLint uniformLocationCount;
+
+	// Compiling and linking in the background.
+	// Checked, and the uniform table built, on first use
+	bool pending;
+	GLuint pendingShaders[2];
+	char* pendingNames[2];
+	// Where to save the binary once linked, empty if nowhere
+	char cachePath[64];
 } Shader;
 
-void init( Shader * shader, char* vertShaderFileName, char* fragShaderFileName );
+// Linked programs are kept in SHADER_CACHE_FOLDER,
+// and loaded from there while the sources and the driver stay the same.
+//
+// Otherwise compiling and linking are only started,
+// so that many programs compile at once, in the driver's threads
+// where KHR_parallel_shader_compile is supported, while other things load.
+// The first bind() or uniform call waits for it to finish.
+//
+// Each of the defines is added as "#define <define>" after #version
+void init(
+	Shader * shader,
+	char* vertShaderFileName, char* fragShaderFileName,
+	const char* const* defines = NULL, unsigned int defineCount = 0
+);
+
+// Whether the program is done compiling, without waiting for it.
+// Always true without KHR_parallel_shader_compile.
+// The renderer skips draws with programs that aren't, for that frame
+bool isReady( Shader * shader );
+
+// Wait for the program, and check it
+void finishCompiling( Shader * shader );
 
-GLuint compileShader( Shader * shader, GLuint type, char* filePath );
+// Compile right away. name is only for error messages
+GLuint compileShader( Shader * shader, GLuint type, const GLchar* source, GLint length, const char* name );
+
+// Walk the active uniforms of the linked program
+void buildUniformTable( Shader * shader );
+
+ShaderUniform * findUniform( Shader * shader, const char* name );
+ShaderUniform * findUniform( Shader * shader, GLint location );
 
 void setUniform1i( Shader * shader, GLint location, GLint value );
 
@@ -177,158 +763,881 @@ void bind( Shader * shader );
 void unbind( Shader * shader );
 
 
-// Finally, the actual renderer object.
-// Currently empty, but it's ready to be expanded
-// and used in the project as if it were already
-typedef struct {
-
-} Renderer;
+// A shader with optional features, turned on by #define keywords,
+// so that each program only has the code it needs instead of branches.
+// Each combination is compiled the first time it's asked for,
+// and shared by everyone asking for it afterwards
 
-void init( Renderer * renderer );
+#define SHADER_MAX_KEYWORDS 32
 
-void draw( Renderer * renderer, VertexArray * vertexArray, IndexBuffer * indexBuffer, Shader * shader );
+typedef struct {
+	uint32_t keywordMask;
+	Shader * shader;
+} ShaderVariant;
 
+typedef struct {
+	char* vertShaderFileName;
+	char* fragShaderFileName;
+	const char* keywords[SHADER_MAX_KEYWORDS];
+	unsigned int keywordCount;
+	// Only a few per shader, so searched in order
+	ShaderVariant * variants;
+	unsigned int variantCount;
+	unsigned int reservedVariants;
+} ShaderVariants;
+
+void init(
+	ShaderVariants * variants,
+	char* vertShaderFileName, char* fragShaderFileName,
+	const char* const* keywords, unsigned int keywordCount
+);
+
+// Bit of the keyword in masks, 0 if it isn't one of them
+uint32_t keywordBit( ShaderVariants * variants, const char* keyword );
+
+// The shader with the keywords whose bits are set in the mask.
+// Bits with no keyword are reported and left out
+Shader * getVariant( ShaderVariants * variants, uint32_t keywordMask );
 
 
 //
 // Textures
 //
 
+// Where the smaller levels come from
+typedef enum {
+	MIPMAPS_NONE,
+	// glGenerateMipmap once the image is uploaded
+	MIPMAPS_GPU,
+	// Box filtered on the CPU, by the loader threads when loading in the background
+	MIPMAPS_CPU
+} MipmapSource;
+
+// How a texture is sampled
+typedef struct {
+	MipmapSource mipmaps;
+	// Blend between the two nearest levels, rather than picking one
+	bool trilinear;
+	// 1 to turn it off. Clamped to what the driver supports
+	float anisotropy;
+} TextureOptions;
+
+const TextureOptions defaultTextureOptions = { MIPMAPS_GPU, true, 8.0f };
+
+// 32768 pixels wide at most
+#define TEXTURE_MAX_LEVELS 16
+#define TEXTURE_MAX_SIZE ( 1 << ( TEXTURE_MAX_LEVELS - 1 ) )
+
 typedef struct {
 	GLuint rendererId;
+	// GL_TEXTURE_2D, or GL_TEXTURE_2D_ARRAY for atlases with layers
+	GLenum target;
 	int width, height, bpp;
+	int levels;
+	// GL_RGBA8, or the block compressed format of a cooked texture
+	GLenum format;
+	TextureOptions options;
+	// False while a placeholder is shown instead
+	bool loaded;
 } Texture;
 
-void init( Texture * texture, const char* filePath );
+// Images are decoded into RGBA8. KTX files made by bin/cooker
+// are block compressed, and go to OpenGL as they are,
+// with the levels they were cooked with
+void init( Texture * texture, const char* filePath, TextureOptions options = defaultTextureOptions );
+
+// Sampler state from the options, for a texture with the given levels
+void setOptions( Texture * texture, TextureOptions options );
+
+
+// A KTX file written by the cooker, pointing into its contents
+typedef struct {
+	GLenum format;
+	int width, height;
+	int levelCount;
+	const unsigned char* levels[TEXTURE_MAX_LEVELS];
+	GLsizei levelSizes[TEXTURE_MAX_LEVELS];
+} CompressedImage;
+
+// False unless it's a KTX file with a 2D block compressed image
+bool parseKtx( const unsigned char* file, long size, CompressedImage * image );
+
+// Whether the driver can sample BC1, BC3 or BC7 blocks
+bool compressedFormatSupported( GLenum format );
 
 void bind( Texture * texture, GLuint slot = 0 );
 
 void unbind( Texture * texture );
 
 
+// Pixel buffers to upload textures through,
+// so that glTexSubImage2D doesn't have to copy from client memory
+// before returning, and the transfer happens asynchronously.
+// Each buffer is fenced once its upload is issued,
+// and only written again when the GPU is done with it
 
-//
-// Axes object and methods to render them
-// (doesn't use modern OpenGL)
-//
+#define PIXEL_BUFFER_COUNT 4
 
 typedef struct {
-	float axisSize;
-	float vertexArray[18];
-	float colorArray[18];
-} Axes;
+	GLuint rendererIds[PIXEL_BUFFER_COUNT];
+	GLsync fences[PIXEL_BUFFER_COUNT];
+	unsigned int next;
+	unsigned int size;
+} PixelBufferPool;
+
+void init( PixelBufferPool * pool, unsigned int bufferSize );
+
+// Upload the first rows of an RGBA rectangle of a texture,
+// as many as fit in a single pixel buffer.
+// Rows wider than a buffer go straight from client memory, all at once.
+// Returns how many, or 0 if no buffer is free and wait is false
+int uploadRows(
+	PixelBufferPool * pool,
+	GLuint textureId,
+	int level,
+	int x, int y,
+	int width, int height,
+	const unsigned char* pixels,
+	bool wait
+);
+
+// Replace a sub rectangle of a texture, through the pool.
+// pixels is the RGBA data of the rectangle only
+void update( Texture * texture, PixelBufferPool * pool, int x, int y, int width, int height, const unsigned char* pixels );
+
+
+// Background texture loading.
+//
+// Worker threads read and decode the images,
+// and hand them to the GL thread through a lock free list.
+// The GL thread uploads them in processUploads(),
+// stopping once the time budget for the frame is spent.
+// Until then, textures show a shared placeholder
 
-void init( Axes * axes );
-void createArrayData( Axes * axes);
+#define TEXTURE_LOADER_MAX_THREADS 4
 
-void draw( Axes * axes );
-// Draw with glBegin and glEnd
-void drawAxesLegacy( Axes * axes );
-// Draw with glDrawArrays
-void drawAxesModern( Axes * axes );
+typedef struct TextureLoadJob {
+	Texture * texture;
+	char* filePath;
+	// Decoded image, NULL if it couldn't be loaded
+	unsigned char* pixels;
+	int width, height, bpp;
+	// The image and its smaller versions, when built on the CPU.
+	// Level 0 is pixels
+	unsigned char* levelPixels[TEXTURE_MAX_LEVELS];
+	int levelCount;
+	// Cooked files are kept mapped, with levelCount 0 if it isn't one
+	FileView file;
+	CompressedImage compressed;
+	// Texture being filled, a few rows at a time.
+	// Replaces the placeholder once complete
+	GLuint rendererId;
+	int uploadedLevel;
+	int uploadedRows;
+	struct TextureLoadJob * next;
+} TextureLoadJob;
 
-void changeAxisSize( Axes * axes, float newSize );
+typedef struct {
+	pthread_t threads[TEXTURE_LOADER_MAX_THREADS];
+	unsigned int threadCount;
 
+	// Jobs waiting for a worker
+	TextureLoadJob * pendingJobs;
+	TextureLoadJob * lastPendingJob;
+	pthread_mutex_t mutex;
+	pthread_cond_t jobAvailable;
+	bool stopping;
 
+	// Decoded jobs, pushed by the workers, newest first
+	TextureLoadJob * decodedJobs;
+	// Taken from decodedJobs by the GL thread, oldest first
+	TextureLoadJob * uploadJobs;
 
-//
-// Triangle object
-//
+	GLuint placeholderId;
+	PixelBufferPool * pixelBuffers;
+	double budgetMilliseconds;
+} TextureLoader;
 
-typedef struct {
-	VertexArray * vertexArray;
-	IndexBuffer * indexBuffer;
-	Shader * shader;
-	Texture * texture;
-	GLint u_Texture;
-	int vertexCount;
-	int indexCount;
-} Triangle;
+void init( TextureLoader * loader, double budgetMilliseconds );
 
-void init( Triangle * triangle, Shader * shader );
+// Load the texture in the background.
+// It can be used right away, showing the placeholder
+void init( Texture * texture, const char* filePath, TextureLoader * loader, TextureOptions options = defaultTextureOptions );
 
-void draw( Triangle * triangle, Renderer * renderer );
+// Upload decoded images, within the budget.
+// Big images take several frames, going through
+// pixel buffers a few rows at a time.
+// Called once per frame from the GL thread
+void processUploads( TextureLoader * loader );
 
+// Wait for the workers to finish
+void stop( TextureLoader * loader );
 
 
+// Many small images packed into one texture,
+// so that the objects using them can be drawn without switching textures.
 //
-// Scene handling
-//
+// Images are placed with a skyline: the top edge of what has been placed
+// so far, as horizontal segments, with each image going
+// where it leaves that edge the lowest.
+// With GL_TEXTURE_2D_ARRAY there is a skyline per layer, and a layer
+// is only started when an image fits in none of the previous ones
 
+// A horizontal segment of the skyline
 typedef struct {
+	int x, y, width;
+} SkylineNode;
 
-	// Objects in the scene
-	Axes * axes;
-	Triangle * triangle;
-	// .
+typedef struct {
+	SkylineNode * nodes;
+	unsigned int nodeCount;
+	unsigned int reservedNodes;
+} Skyline;
 
-	float cameraAngleX;
-	float cameraAngleY;
+// Where an image ended up
+typedef struct {
+	int layer;
+	int x, y, width, height;
+	// Texture coordinates of the bottom left and top right corners,
+	// at the centers of the corner texels, so that linear filtering
+	// never reaches the padding around it
+	GLfloat u0, v0, u1, v1;
+} AtlasRegion;
 
-	float cursorSpeed;
-	double prevCursorX;
-	double prevCursorY;
+typedef struct {
+	// Usable as any texture, by draw() and bind()
+	Texture texture;
+	int layerCount;
+	// Empty pixels around each image, so that filtering doesn't
+	// pick up its neighbours.
+	// There are no mipmaps, as they would blend them anyway
+	int padding;
+	Skyline * layers;
+} TextureAtlas;
+
+void init( TextureAtlas * atlas, int width, int height, GLenum target = GL_TEXTURE_2D, int layerCount = 1 );
+
+// Pack an RGBA image into the atlas and upload it.
+// False if there is no room left
+bool add( TextureAtlas * atlas, const unsigned char* pixels, int width, int height, AtlasRegion * region );
+
+// Same, loading the image from a file
+bool add( TextureAtlas * atlas, const char* filePath, AtlasRegion * region );
+
+// Only make room for an image, to be filled in later
+bool reserve( TextureAtlas * atlas, int width, int height, AtlasRegion * region );
+
+// Copy the first level of a loaded texture into a reserved region
+// of the same size. It is read back from video memory,
+// so this is for load time, not every frame
+void fill( TextureAtlas * atlas, AtlasRegion * region, Texture * source );
+
+// Turn texture coordinates over the whole image into ones
+// over its region of the atlas. stride and offset are in floats,
+// as in the vertex buffer layout.
+// With three components the third one gets the layer,
+// for shaders sampling array textures
+void remapTexCoords(
+	AtlasRegion * region,
+	GLfloat * vertices,
+	unsigned int vertexCount,
+	unsigned int stride,
+	unsigned int offset,
+	unsigned int components = 2
+);
+
+
+// Textures shared by everything loading the same file.
+//
+// Files are looked up by path, and then by a hash of their contents,
+// so that copies of the same image at different paths share a texture too.
+// A hash match is only taken once the path, or else the contents, are
+// the same as those of the file the texture was loaded from.
+// Files are assumed not to change while running.
+// Released textures stay in video memory, and are only deleted,
+// least recently used first, once the budget is exceeded.
+// With a loader, textures load in the background, and count
+// against the budget once they have
+
+#define TEXTURE_MANAGER_BUCKETS 256
+
+// Contents hash of each path seen so far
+typedef struct TexturePath {
+	char* path;
+	uint64_t hash;
+	struct TexturePath * next;
+} TexturePath;
+
+typedef struct TextureEntry {
+	// First, so that the texture handed out leads back to its entry
+	Texture texture;
+	// Of the contents and the options it was loaded with
+	uint64_t hash;
+	// File it was loaded from, and options asked for,
+	// as setOptions() may change those of the texture
+	char* path;
+	TextureOptions options;
+	// False for files that couldn't be read,
+	// each of which gets a placeholder of its own, deleted once released
+	bool shared;
+	unsigned int references;
+	size_t bytes;
+	struct TextureEntry * next;
+	// Unreferenced entries, least recently released first
+	struct TextureEntry * older;
+	struct TextureEntry * newer;
+} TextureEntry;
 
-	GLfloat observerDistance;
-	GLfloat observerAngleX;
-	GLfloat observerAngleY;
+typedef struct {
+	unsigned int hits;
+	// Found by contents, at a path not seen before
+	unsigned int contentHits;
+	unsigned int misses;
+	unsigned int evictions;
+	size_t residentBytes;
+} TextureManagerStats;
 
-	GLfloat width, height, frontPlane, backPlane;
+typedef struct {
+	TexturePath * paths[TEXTURE_MANAGER_BUCKETS];
+	TextureEntry * entries[TEXTURE_MANAGER_BUCKETS];
+	TextureEntry * oldestReleased;
+	TextureEntry * newestReleased;
+	size_t budgetBytes;
+	TextureLoader * loader;
+	TextureManagerStats stats;
+} TextureManager;
 
-} Scene;
+// Without a loader, textures are loaded right away
+void init( TextureManager * manager, size_t budgetBytes, TextureLoader * loader = NULL );
 
-void initScene( Scene * scene, int screenWidth, int screenHeight, Shader * shader );
+// The texture of a file with the given options,
+// loading it if it isn't resident.
+// Every acquire needs a release
+Texture * acquire( TextureManager * manager, const char* filePath, TextureOptions options = defaultTextureOptions );
 
-void drawScene( Scene * scene, Renderer * renderer );
-void drawObjects( Scene * scene, Renderer * renderer );
+void release( TextureManager * manager, Texture * texture );
 
-void changeProjection( Scene * scene );
-void changeObserver( Scene * scene );
-void reshapeScene( Scene * scene, int newWidth, int newHeight );
+void printStats( TextureManager * manager );
 
-int keyPress( Scene * scene, unsigned char key, int x, int y );
-void specialKeyPress( Scene * scene, int key, int x, int y );
-void idleAnimation( Scene * scene );
 
 
 //
-// Input handling
+// Uniform blocks shared by every program, in std140 layout.
+//
+// The per frame block is written once per frame,
+// and the per object block once per object, into the renderer's
+// uniform ring, and bound with glBindBufferRange.
+// Programs find them at these binding points
 //
 
-void update( Scene * scene, GLFWwindow * window );
+#define UNIFORM_BLOCK_FRAME 0
+#define UNIFORM_BLOCK_OBJECT 1
 
+// Same layout as the FrameData block in the shaders
+typedef struct {
+	mat4 view;
+	mat4 projection;
+	mat4 viewProjection;
+	vec4 backgroundColor;
+	float time;
+	float padding[3];
+} FrameData;
+
+// Same layout as the ObjectData block in the shaders
+typedef struct {
+	mat4 model;
+	vec4 color;
+} ObjectData;
 
+static_assert( offsetof( FrameData, backgroundColor ) == 192 && offsetof( FrameData, time ) == 208, "FrameData doesn't match std140" );
+static_assert( offsetof( ObjectData, color ) == 64, "ObjectData doesn't match std140" );
 
-//
-// Other methods to manipulate the scene
-//
+// Point the blocks of a linked program at their binding points
+void bindUniformBlocks( Shader * shader );
 
-void changeWindowSize( int newWidth, int newHeight );
 
-void normalKeys( unsigned char key, int x, int y );
 
-void specialKeys( int key, int x, int y );
+//
+// Finally, the actual renderer object.
+//
+// Draws are not issued right away, but queued with a sort key
+// and issued all together in flush(), sorted so that opaque draws
+// sharing a shader, texture and vertex array stay together.
+// Translucent draws come after them, back to front,
+// as blending needs what is behind them drawn first.
+// Uniforms set while queueing apply to the whole queue
+//
 
+// Bits of the sort key, from the most significant ones.
+// Opaque draws: layer, shader, texture, vertex array, depth.
+// Translucent draws: layer, depth from the back, and zeroes,
+// so the sort, which is stable, keeps the order they were queued in
+// when at the same depth
+#define SORT_KEY_LAYER_BITS 1
+#define SORT_KEY_SHADER_BITS 15
+#define SORT_KEY_TEXTURE_BITS 16
+#define SORT_KEY_VERTEX_ARRAY_BITS 16
+#define SORT_KEY_DEPTH_BITS 16
+
+static_assert(
+	SORT_KEY_LAYER_BITS + SORT_KEY_SHADER_BITS + SORT_KEY_TEXTURE_BITS +
+	SORT_KEY_VERTEX_ARRAY_BITS + SORT_KEY_DEPTH_BITS == 64,
+	"The sort key must fill 64 bits"
+);
+
+// A draw waiting to be issued
+typedef struct {
+	uint64_t key;
+	VertexArray * vertexArray;
+	IndexBuffer * indexBuffer;
+	Shader * shader;
+	Texture * texture;
+	// 0 when not instanced
+	unsigned int instanceCount;
+	// Only for meshes in an arena
+	ArenaMesh * mesh;
+	// Only for draws without indices
+	GLenum primitive;
+	GLint first;
+	GLsizei count;
+	// Of its ObjectData in the uniform ring
+	unsigned int objectOffset;
+} DrawCommand;
+
+// Layout expected by glMultiDrawElementsIndirect
+typedef struct {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+} DrawElementsIndirectCommand;
 
-// GLFW input handling
+// Most draws of arena meshes merged in a single call
+#define RENDERER_INDIRECT_COMMANDS 4096
 
-void keyCallback( GLFWwindow* window, int key, int scanCode, int action, int modifierBits );
+// Sort key and position of a queued draw
+typedef struct {
+	uint64_t key;
+	unsigned int command;
+} DrawSortItem;
 
-void charCallback( GLFWwindow* window, unsigned int codePoint );
+typedef struct {
+	DrawCommand * commands;
+	unsigned int commandCount;
+	unsigned int reservedCommands;
+
+	// Sorting space, twice as big as the commands
+	DrawSortItem * sortItems;
+
+	// Draws of arena meshes being merged.
+	// Through an indirect buffer when multi draw indirect
+	// is supported, with glMultiDrawElementsBaseVertex otherwise
+	DrawElementsIndirectCommand * batch;
+	GLsizei * batchCounts;
+	void ** batchIndices;
+	GLint * batchBaseVertices;
+	BufferRing * indirectBuffer;
+
+	// FrameData and ObjectData of the frame,
+	// at offsets aligned as GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT asks
+	BufferRing * uniformBuffer;
+	unsigned int frameOffset;
+	unsigned int objectOffset;
+	// Written again when the ring fills up and draws are flushed early
+	FrameData frame;
+
+	// Of the draws being queued
+	bool translucent;
+} Renderer;
 
-void charModsCallback( GLFWwindow* window, unsigned int codePoint, int modifierBits );
+// Room for the uniforms of a frame, about a thousand objects
+// before the draws are flushed early
+#define RENDERER_UNIFORM_BUFFER_SIZE ( 256 * 1024 )
 
-void cursorPosCallback( GLFWwindow* window, double xPos, double yPos );
+void init( Renderer * renderer );
 
-void mouseButtonCallback( GLFWwindow* window, int button, int action, int modifierBits );
+// Write the data of the frame, once per frame before queueing draws.
+// Also goes back to the default object data:
+// an identity model and a white color, and to opaque draws
+void setFrameData( Renderer * renderer, FrameData * frame );
+
+// Model and color of the draws queued after it.
+// If the frame's uniform space is full, the draws queued so far
+// are flushed first, and the frame goes on in the next region
+void setObjectData( Renderer * renderer, mat4 model, vec4 color );
+
+// Whether the draws queued after it blend with what is behind them.
+// Those are issued after the opaque ones, back to front
+void setTranslucent( Renderer * renderer, bool translucent );
+
+// Queue a draw.
+// Depth goes from 0 (front) to 1 (back). Opaque draws
+// with everything else in common are issued front to back
+void draw(
+	Renderer * renderer,
+	VertexArray * vertexArray,
+	IndexBuffer * indexBuffer,
+	Shader * shader,
+	Texture * texture = NULL,
+	float depth = 0
+);
+
+// Queue a single draw of many instances of a mesh.
+// The vertex array must have the per instance attributes
+void drawInstanced(
+	Renderer * renderer,
+	VertexArray * vertexArray,
+	IndexBuffer * indexBuffer,
+	Shader * shader,
+	unsigned int instanceCount,
+	Texture * texture = NULL,
+	float depth = 0
+);
+
+// Queue a draw of a mesh in an arena.
+// Consecutive draws of the same arena, shader and texture
+// are merged in a single call
+void draw(
+	Renderer * renderer,
+	MeshArena * arena,
+	ArenaMesh * mesh,
+	Shader * shader,
+	Texture * texture = NULL,
+	float depth = 0
+);
+
+// Queue a draw without indices
+void drawArrays(
+	Renderer * renderer,
+	VertexArray * vertexArray,
+	Shader * shader,
+	GLenum primitive,
+	GLint first,
+	GLsizei count,
+	Texture * texture = NULL,
+	float depth = 0
+);
+
+// Sort and issue every queued draw,
+// except those whose program is still compiling.
+// Meant to be called once per frame, and called earlier
+// by setObjectData if the frame's uniforms don't fit
+void flush( Renderer * renderer );
 
-void scrollCallBack( GLFWwindow* window, double xOffset, double yOffset );
 
 
+//
+// Axes object and methods to render them.
+// Uploaded once, and drawn with a single glDrawArrays
+//
 
-// Main scene object
+typedef struct {
+	float axisSize;
+	float vertexArray[18];
+	float colorArray[18];
+
+	VertexArray * vertexArrayObject;
+	VertexBuffer * positionBuffer;
+	VertexBuffer * colorBuffer;
+	Shader * shader;
+} Axes;
+
+void init( Axes * axes, Shader * shader );
+void createArrayData( Axes * axes);
+
+void draw( Axes * axes, Renderer * renderer );
+
+void changeAxisSize( Axes * axes, float newSize );
+
+
+
+//
+// Debug lines.
+// Lines added during the frame are drawn all together
+// with a single call, from a streaming vertex buffer
+//
+
+typedef struct {
+	GLfloat position[3];
+	GLfloat color[4];
+} DebugLineVertex;
+
+typedef struct {
+	VertexArray * vertexArray;
+	VertexBuffer * vertexBuffer;
+	Shader * shader;
+
+	// Lines added this frame
+	DebugLineVertex * vertices;
+	unsigned int vertexCount;
+	unsigned int maxVertices;
+} DebugLines;
+
+void init( DebugLines * lines, Shader * shader, unsigned int maxLines );
+
+void addLine( DebugLines * lines, vec3 from, vec3 to, vec4 color );
+
+// Axis aligned box, as { min, max }
+void addBox( DebugLines * lines, vec3 box[2], vec4 color );
+
+// Square grid on the XY plane, centered on the origin
+void addGrid( DebugLines * lines, float halfSize, unsigned int divisions, vec4 color );
+
+// One line of the given length from each position, along its normal
+void addNormals( DebugLines * lines, vec3 * positions, vec3 * normals, unsigned int count, float length, vec4 color );
+
+// Bars of the p50 (green) and p99 (red) times of each profiler scope,
+// one under the other from the top left corner given.
+// A unit long is a frame at 60 Hz, marked by a white line
+void addProfilerBars( DebugLines * lines, Profiler * profiler, float left, float top );
+
+// Queue the lines added this frame, and start again
+void draw( DebugLines * lines, Renderer * renderer );
+
+
+
+//
+// Triangle object.
+// Drawn from a mesh arena, as two meshes merged in a single call.
+// Its own buffers are the mesh of the instanced copies
+//
+
+typedef struct {
+	VertexArray * vertexArray;
+	VertexBuffer * vertexBuffer;
+	VertexBufferLayout * vertexBufferLayout;
+	IndexBuffer * indexBuffer;
+	Shader * shader;
+	Texture * texture;
+	GLint u_Texture;
+	int vertexCount;
+	int indexCount;
+
+	MeshArena * arena;
+	// The triangle, and the tip on top of it.
+	// NULL while not in the arena
+	ArenaMesh * body;
+	ArenaMesh * tip;
+
+	// Around Z, turned with A and D.
+	// Goes to the shaders as the object data of its draws
+	float angle;
+	vec4 color;
+} Triangle;
+
+// The texture comes from the manager, shared with whoever else loads it
+void init( Triangle * triangle, Shader * shader, TextureManager * textures );
+
+// Copy the mesh into an arena with the vertex layout of the triangle
+void addMeshes( Triangle * triangle, MeshArena * arena );
+
+// Take the tip out of the arena, or put it back.
+// Toggled with T
+void toggleTip( Triangle * triangle );
+
+void modelMatrix( Triangle * triangle, mat4 model );
+
+void draw( Triangle * triangle, Renderer * renderer );
+
+
+
+//
+// Many copies of the triangle mesh,
+// drawn with a single instanced draw call
+//
+
+#define TRIANGLE_INSTANCES 100000
+
+// Data of each copy
+typedef struct {
+	mat4 model;
+	vec4 color;
+} TriangleInstance;
+
+typedef struct {
+	Triangle * triangle;
+	// Attributes of the triangle mesh plus the per instance ones
+	VertexArray * vertexArray;
+	VertexBuffer * instanceBuffer;
+	Shader * shader;
+	unsigned int instanceCount;
+} TriangleInstances;
+
+void init( TriangleInstances * instances, Triangle * triangle, Shader * shader, unsigned int instanceCount );
+
+void draw( TriangleInstances * instances, Renderer * renderer );
+
+
+
+//
+// Sprites.
+// Images packed into the layers of an array texture,
+// and drawn together in a single call
+//
+
+#define SPRITE_COUNT 4
+
+typedef struct {
+	TextureAtlas * atlas;
+	AtlasRegion regions[SPRITE_COUNT];
+	unsigned int spriteCount;
+
+	// Image of the first sprite, shared through the manager
+	// so that the file is only decoded once.
+	// Copied into its region once loaded, and released
+	TextureManager * textures;
+	Texture * source;
+
+	// A quad per sprite
+	VertexArray * vertexArray;
+	VertexBuffer * vertexBuffer;
+	IndexBuffer * indexBuffer;
+	Shader * shader;
+} Sprites;
+
+// shader samples a sampler2DArray
+void init( Sprites * sprites, Shader * shader, TextureManager * textures );
+
+// Fill in the image of the first sprite once it has loaded
+void update( Sprites * sprites );
+
+void draw( Sprites * sprites, Renderer * renderer );
+
+
+
+//
+// Scene handling
+//
+
+typedef struct {
+
+	// Objects in the scene
+	Axes * axes;
+	// Meshes of the triangle, which don't change
+	MeshArena * staticMeshes;
+	Triangle * triangle;
+	TriangleInstances * triangleInstances;
+	DebugLines * debugLines;
+	// Fixed on screen, over everything else
+	DebugLines * overlayLines;
+	Sprites * sprites;
+	// .
+
+	TextureLoader * textureLoader;
+	// Textures loaded from files, through the loader
+	TextureManager * textures;
+
+	// Toggled with I
+	bool showInstances;
+	// Toggled with G
+	bool showDebugLines;
+
+	float cameraAngleX;
+	float cameraAngleY;
+
+	float cursorSpeed;
+	double prevCursorX;
+	double prevCursorY;
+
+	GLfloat observerDistance;
+	GLfloat observerAngleX;
+	GLfloat observerAngleY;
+
+	GLfloat width, height, frontPlane, backPlane;
+
+} Scene;
+
+void initScene(
+	Scene * scene,
+	int screenWidth, int screenHeight,
+	Shader * shader, Shader * instancedShader, Shader * lineShader, Shader * arrayShader
+);
+
+void drawScene( Scene * scene, Renderer * renderer );
+void drawObjects( Scene * scene, Renderer * renderer );
+
+// The overlay lines, after the scene has been flushed,
+// with only the projection of frame so the camera doesn't move them
+void drawOverlay( Scene * scene, Renderer * renderer, FrameData * frame );
+
+void changeProjection( Scene * scene );
+void changeObserver( Scene * scene );
+void reshapeScene( Scene * scene, int newWidth, int newHeight );
+
+int keyPress( Scene * scene, unsigned char key, int x, int y );
+void specialKeyPress( Scene * scene, int key, int x, int y );
+void idleAnimation( Scene * scene );
+
+
+//
+// Input handling
+//
+
+void update( Scene * scene, GLFWwindow * window );
+
+
+
+//
+// Other methods to manipulate the scene
+//
+
+void changeWindowSize( int newWidth, int newHeight );
+
+void normalKeys( unsigned char key, int x, int y );
+
+void specialKeys( int key, int x, int y );
+
+
+// GLFW input handling
+
+void keyCallback( GLFWwindow* window, int key, int scanCode, int action, int modifierBits );
+
+void charCallback( GLFWwindow* window, unsigned int codePoint );
+
+void charModsCallback( GLFWwindow* window, unsigned int codePoint, int modifierBits );
+
+void cursorPosCallback( GLFWwindow* window, double xPos, double yPos );
+
+void mouseButtonCallback( GLFWwindow* window, int button, int action, int modifierBits );
+
+void scrollCallBack( GLFWwindow* window, double xOffset, double yOffset );
+
+
+
+// Main scene object
 Scene * scene;
 
+// Print per frame statistics once per second,
+// and show them as bars. Toggled with F1
+bool showFrameStats = false;
+
+// Set with F2, to write the profiler's trace
+bool saveTrace = false;
+
+
+
+//
+// Benchmarks
+//
+// Run instead of the scene with "minimum --bench <name>".
+// They print their results and exit
+//
+//	streaming:	the StreamModes of BufferRing, with the GPU reading what is written
+//	sampling:	GPU time of drawing a large texture small, with and without mipmaps
+//	errors:		CPU time of a frame of draws with immediate and deferred GLCall checks
+//
+
+// False if there is no benchmark with that name.
+// shader is the scene's one, without instancing
+bool runBenchmark( const char* name, Renderer * renderer, Shader * shader );
+
+void benchmarkStreaming();
+
+void benchmarkSampling( Renderer * renderer, Shader * shader );
+
+void benchmarkErrorChecks( Renderer * renderer, Shader * shader );
+
 
 
 int main( int argc, char ** argv ){
@@ -340,17 +1649,38 @@ int main( int argc, char ** argv ){
 
 	char* vertShaderFileName = "shader.vert";
 	char* fragShaderFileName = "shader.frag";
+	// Instanced or not, in the same shader
+	const char* shaderKeywords[] = { "INSTANCED" };
+	char* lineVertShaderFileName = "lines.vert";
+	char* lineFragShaderFileName = "lines.frag";
+	char* arrayVertShaderFileName = "array.vert";
+	char* arrayFragShaderFileName = "array.frag";
 
-	Shader * shader = (Shader*) malloc( sizeof( Shader ) );
+	ShaderVariants * shaderVariants = (ShaderVariants*) malloc( sizeof( ShaderVariants ) );
+	Shader * lineShader = (Shader*) malloc( sizeof( Shader ) );
+	Shader * arrayShader = (Shader*) malloc( sizeof( Shader ) );
 
 	Renderer * renderer = (Renderer*) malloc( sizeof( Renderer ) );
 
+	Profiler * profiler = (Profiler*) malloc( sizeof( Profiler ) );
+
 	mat4 viewMatrix, projectionMatrix, mvpMatrix;
 	vec3 xAxis = { 1.0, 0.0, 0.0 },
 		yAxis = { 0.0, 1.0, 0.0 },
 		zAxis = { 0.0, 0.0, 1.0 };
 	float cameraAngleX = 0, cameraAngleY = 0;
 
+	const char* benchmark = NULL;
+	for ( int i = 1; i + 1 < argc; i++ )
+		if ( strcmp( argv[i], "--bench" ) == 0 )
+			benchmark = argv[i + 1];
+
+	// OpenGL expects textures to start at the bottom left,
+	// not the top left as they are saved in massive storage.
+	// A global in stb_image, not thread safe, so it's set
+	// before any texture loads and never changed
+	stbi_set_flip_vertically_on_load( true );
+
 
 	// Initialize GLFW
 
@@ -365,6 +1695,10 @@ int main( int argc, char ** argv ){
     glfwWindowHint( GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE );
     glfwWindowHint( GLFW_RESIZABLE, GL_FALSE );
 
+	GLReadErrorMode();
+	if ( glErrorMode == GL_ERRORS_DEBUG )
+		glfwWindowHint( GLFW_OPENGL_DEBUG_CONTEXT, GL_TRUE );
+
     GLFWwindow* window = glfwCreateWindow(
         screenWidthRaw,
         screenHeightRaw,
@@ -399,6 +1733,8 @@ int main( int argc, char ** argv ){
         return -1;
     }
 
+	GLInitErrorChecking();
+
 
 	// Set callback functions that will handle input events
 	glfwSetKeyCallback( window, keyCallback );
@@ -409,22 +1745,56 @@ int main( int argc, char ** argv ){
 	glfwSetInputMode( window, GLFW_STICKY_KEYS, 1 );
 
 
-	// Create and compile the shader programs
-	init( shader, vertShaderFileName, fragShaderFileName );
-	bind( shader );
-
-	// Get the location of uniform variables and assign them
-	GLint u_BackgroundColor = getUniformLocation( shader, "u_BackgroundColor" );
-	setUniform4f( shader, u_BackgroundColor, 0.2, 0.3, 0.4, 1.0 );
+	// Create and start compiling the shader programs,
+	// or load them from the cache of a previous run.
+	// They compile while the scene loads, until first used
+	double shaderStartTime = glfwGetTime();
+	init( shaderVariants, vertShaderFileName, fragShaderFileName, shaderKeywords, 1 );
+	Shader * shader = getVariant( shaderVariants, 0 );
+	Shader * instancedShader = getVariant( shaderVariants, keywordBit( shaderVariants, "INSTANCED" ) );
+	init( lineShader, lineVertShaderFileName, lineFragShaderFileName );
+	init( arrayShader, arrayVertShaderFileName, arrayFragShaderFileName );
+	double shaderTime = glfwGetTime() - shaderStartTime;
 
 
 	// Initialize the renderer
 	init( renderer );
 
 
+	// Measured without vsync, on their own
+	if ( benchmark != NULL ){
+		glfwSwapInterval( 0 );
+
+		int result = 0;
+		if ( !runBenchmark( benchmark, renderer, shader ) ){
+			printf( "Unknown benchmark %s.\n", benchmark );
+			result = -1;
+		}
+
+		glfwTerminate();
+		return result;
+	}
+
+
+	// Parts of the frame being timed
+	init( profiler );
+	unsigned int frameScope = addScope( profiler, "Frame" );
+	unsigned int pollScope = addScope( profiler, "Poll events" );
+	unsigned int updateScope = addScope( profiler, "Update" );
+	unsigned int drawScope = addScope( profiler, "Draw scene" );
+	unsigned int swapScope = addScope( profiler, "Swap buffers" );
+	unsigned int gpuDrawScope = addScope( profiler, "GPU draw scene", true );
+
+
 	// Initialize all the objects in the scene
 	scene = (Scene*) malloc( sizeof( Scene ) );
-	initScene( scene, screenWidth, screenHeight, shader );
+	initScene( scene, screenWidth, screenHeight, shader, instancedShader, lineShader, arrayShader );
+
+
+	// Uniforms shared by every program, set every frame
+	FrameData frameData;
+	vec4 backgroundColor = { 0.2, 0.3, 0.4, 1.0 };
+	glm_vec4_copy( backgroundColor, frameData.backgroundColor );
 
 
 	// Set the projection matrix for orthogonal view
@@ -439,28 +1809,92 @@ int main( int argc, char ** argv ){
 	);
 
 
+	// Since glfwInit()
+	printf( "Started in %.1f ms, %.1f ms of it starting shaders\n", glfwGetTime() * 1000, shaderTime * 1000 );
+
+	double lastStatsTime = glfwGetTime();
+
+
 	// Main loop of events
 
     while ( !glfwWindowShouldClose( window ) ){
 
+			begin( profiler, frameScope );
+
+			begin( profiler, pollScope );
             glfwPollEvents();
+			end( profiler, pollScope );
 
 			glm_rotate_make( viewMatrix, scene->cameraAngleX, xAxis );
 			glm_rotate( viewMatrix, scene->cameraAngleY, yAxis );
 			glm_mat4_mul( projectionMatrix, viewMatrix, mvpMatrix );
-			GLint u_MVP = getUniformLocation( shader, "u_MVP" );
-			setUniformMatrix4fv( shader, u_MVP, mvpMatrix );
+
+			glm_mat4_copy( viewMatrix, frameData.view );
+			glm_mat4_copy( projectionMatrix, frameData.projection );
+			glm_mat4_copy( mvpMatrix, frameData.viewProjection );
+			frameData.time = glfwGetTime();
+			setFrameData( renderer, &frameData );
 
 			glClear( GL_COLOR_BUFFER_BIT );
 
+			begin( profiler, updateScope );
 			update( scene, window );
+			processUploads( scene->textureLoader );
+			update( scene->sprites );
+			end( profiler, updateScope );
 
-			drawScene( scene, renderer );
+			if ( showFrameStats )
+				addProfilerBars( scene->overlayLines, profiler, -aspectRatio + 0.05, 0.95 );
 
+			begin( profiler, drawScope );
+			begin( profiler, gpuDrawScope );
+			drawScene( scene, renderer );
+			drawOverlay( scene, renderer, &frameData );
+			end( profiler, gpuDrawScope );
+			end( profiler, drawScope );
+
+			GLCheckFrameErrors();
+
+			StateCacheStats stateStats = nextStateCacheFrame();
+			if ( glfwGetTime() - lastStatsTime >= 1.0 ){
+
+				ProfilerStats frameStats = getStats( profiler, frameScope );
+				char title[128];
+				snprintf(
+					title, sizeof( title ),
+					"Minimum OpenGL program - %.2f ms, p99 %.2f ms",
+					frameStats.p50, frameStats.p99
+				);
+				glfwSetWindowTitle( window, title );
+
+				if ( showFrameStats ){
+					printf(
+						"State changes: %u issued, %u saved\n",
+						stateStats.issued,
+						stateStats.saved
+					);
+					printStats( profiler );
+					printStats( scene->textures );
+				}
+				lastStatsTime = glfwGetTime();
+			}
+
+			begin( profiler, swapScope );
             glfwSwapBuffers( window );
+			end( profiler, swapScope );
+
+			end( profiler, frameScope );
+			nextFrame( profiler );
+
+			if ( saveTrace ){
+				exportTrace( profiler, "trace.json" );
+				saveTrace = false;
+			}
     }
 
 
+	stop( scene->textureLoader );
+
     glfwTerminate();
 
 	return 0;
@@ -470,582 +1904,4441 @@ int main( int argc, char ** argv ){
 
 // Reading files
 
-char* readFile( char* filePath ){
+// Whole file into a buffer, for files that can't be mapped.
+// Read in chunks, as some don't know their size beforehand
+static bool readFile( FileView * view, const char* filePath ){
 
-	char* buffer = 0;
-	long fileLength;
-	FILE * f = fopen( filePath, "r" );
+	FILE * f = fopen( filePath, "rb" );
 
-	if ( f ){
+	if ( !f )
+		return false;
 
-		fseek( f, 0, SEEK_END );
-		fileLength = ftell( f );
-		fseek( f, 0, SEEK_SET );
+	size_t capacity = 4096;
+	size_t size = 0;
+	unsigned char* buffer = (unsigned char*) malloc( capacity );
 
-		buffer = (char*) malloc( fileLength * sizeof( char ) );
+	while ( true ){
 
-		if ( buffer ){
-			fread( buffer, 1, fileLength - 1, f );
-			buffer[fileLength-1] = '\0';
-		}
+		size += fread( buffer + size, 1, capacity - size, f );
 
-		fclose( f );
+		if ( size < capacity )
+			break;
 
-		if ( !buffer )
-			printf( "Could not read data from file %s\n", filePath );
+		capacity *= 2;
+		buffer = (unsigned char*) realloc( buffer, capacity );
+	}
+
+	bool failed = ferror( f );
+	fclose( f );
 
-		//else printf( "\nRead file:\n\n%s\n\n", buffer );
+	if ( failed ){
+		free( buffer );
+		return false;
 	}
-	else
-		printf( "Could not open file %s\n", filePath );
 
-	return buffer;
+	view->data = buffer;
+	view->size = size;
+	view->mapped = false;
+
+	return true;
 }
 
+bool mapFile( FileView * view, const char* filePath ){
 
+	view->data = NULL;
+	view->size = 0;
+	view->mapped = false;
 
-//
-// Renderer
-//
+#ifndef _WIN32
 
-void init( VertexBuffer * vertexBuffer, unsigned int size, const void* data ){
+	int descriptor = open( filePath, O_RDONLY );
 
-	// Create the vertex buffer and store its index
-	GLCall(glGenBuffers( 1, &vertexBuffer->rendererId ));
+	if ( descriptor < 0 ){
+		printf( "Could not open file %s\n", filePath );
+		return false;
+	}
 
-	// Set the created object as selected
-	GLCall(glBindBuffer( GL_ARRAY_BUFFER, vertexBuffer->rendererId ));
+	struct stat status;
 
-	// Upload data to the selected buffer
-	GLCall(glBufferData( GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW ));
-}
+	// Only regular files that aren't empty can be mapped
+	if ( fstat( descriptor, &status ) == 0 && S_ISREG( status.st_mode ) && status.st_size > 0 ){
 
+		void* data = mmap( NULL, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0 );
 
-void bind( VertexBuffer * vertexBuffer ){
+		if ( data != MAP_FAILED ){
 
-	GLCall(glBindBuffer( GL_ARRAY_BUFFER, vertexBuffer->rendererId ));
-}
+			// Read front to back by every loader
+			madvise( data, status.st_size, MADV_SEQUENTIAL );
 
-void unbind(  VertexBuffer * vertexBuffer  ){
+			view->data = (const unsigned char*) data;
+			view->size = status.st_size;
+			view->mapped = true;
+		}
+	}
 
-	GLCall(glBindBuffer( GL_ARRAY_BUFFER, 0 ));
-}
+	// The mapping stays valid without it
+	close( descriptor );
 
+	if ( view->mapped )
+		return true;
 
-void init( IndexBuffer * indexBuffer, unsigned int size, const GLuint* data ){
+#endif
 
-	indexBuffer->size = size;
+	if ( !readFile( view, filePath ) ){
+		printf( "Could not read data from file %s\n", filePath );
+		return false;
+	}
 
-	// Create the index buffer and store its index
-	GLCall(glGenBuffers( 1, &indexBuffer->rendererId ));
+	return true;
+}
 
-	// Set the created object as selected
-	GLCall(glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, indexBuffer->rendererId ));
+void unmapFile( FileView * view ){
 
-	// Upload data to the selected buffer
-	GLCall(glBufferData( GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW ));
+	if ( view->data == NULL )
+		return;
+
+#ifndef _WIN32
+	if ( view->mapped )
+		munmap( (void*) view->data, view->size );
+	else
+#endif
+		free( (void*) view->data );
+
+	view->data = NULL;
+	view->size = 0;
 }
 
+uint64_t hashBytes( const void* bytes, size_t size, uint64_t hash ){
 
-void bind( IndexBuffer * indexBuffer ){
+	const unsigned char* data = (const unsigned char*) bytes;
+
+	for ( size_t i = 0; i < size; i++ ){
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
 
-	GLCall(glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, indexBuffer->rendererId ));
+	return hash;
 }
 
-void unbind(  IndexBuffer * indexBuffer  ){
 
-	GLCall(glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 ));
-}
 
+//
+// GL state cache
+//
 
-void init( VertexBufferLayout * vertexBufferLayout ){
+// Every context starts with nothing bound
+static StateCache glState = {};
 
-	vertexBufferLayout->reservedElements = 1;
 
-	vertexBufferLayout->elements = (VertexBufferLayoutElement*)
-		malloc(
-			sizeof( VertexBufferLayoutElement ) * vertexBufferLayout->reservedElements
-		);
+static int bufferTargetIndex( GLenum target ){
 
-	vertexBufferLayout->elementCount = 0;
-	vertexBufferLayout->stride = 0;
+	for ( int i = 0; i < STATE_CACHE_BUFFER_TARGETS; i++ )
+		if ( stateCacheBufferTargets[i] == target )
+			return i;
+
+	return -1;
 }
 
-void push( VertexBufferLayout * vertexBufferLayout, unsigned int count, GLenum type ){
+static int textureTargetIndex( GLenum target ){
 
-	// Reserve more space
+	for ( int i = 0; i < STATE_CACHE_TEXTURE_TARGETS; i++ )
+		if ( stateCacheTextureTargets[i] == target )
+			return i;
 
-	if ( vertexBufferLayout->elementCount == vertexBufferLayout->reservedElements ){
+	return -1;
+}
 
-		VertexBufferLayoutElement * tmp = (VertexBufferLayoutElement*)
-			malloc(
-				sizeof( VertexBufferLayoutElement ) * vertexBufferLayout->reservedElements * 2
-			);
 
-		for ( int i = 0; i < vertexBufferLayout->reservedElements; i++ )
-			tmp[i] = vertexBufferLayout->elements[i];
+void stateUseProgram( GLuint program ){
 
-		free( vertexBufferLayout->elements );
+	if ( glState.program == program ){
+		glState.frame.saved++;
+		return;
+	}
 
-		vertexBufferLayout->elements = tmp;
-		vertexBufferLayout->reservedElements *= 2;
+	GLCall(glUseProgram( program ));
+	glState.program = program;
+	glState.frame.issued++;
+}
+
+void stateBindVertexArray( GLuint vertexArray ){
+
+	if ( glState.vertexArray == vertexArray ){
+		glState.frame.saved++;
+		return;
 	}
 
+	GLCall(glBindVertexArray( vertexArray ));
+	glState.vertexArray = vertexArray;
+	glState.frame.issued++;
 
-	// Push the new element
+	// The element array binding is part of the vertex array state
+	glState.buffers[bufferTargetIndex( GL_ELEMENT_ARRAY_BUFFER )] = STATE_CACHE_UNKNOWN;
+}
 
-	unsigned int typeSize =
-		type == GL_FLOAT ?
-			sizeof( GLfloat ) :
-		type == GL_UNSIGNED_INT ?
-			sizeof( GLuint ) :
-		sizeof( GLubyte );
+void stateBindBuffer( GLenum target, GLuint buffer ){
 
-	VertexBufferLayoutElement newElement = (VertexBufferLayoutElement) {
-		.type = type,
-		.count = count,
-		.normalized = GL_FALSE,
-		.typeSize = typeSize
-	};
-	vertexBufferLayout->elements[vertexBufferLayout->elementCount] = newElement;
-	vertexBufferLayout->elementCount++;
+	int index = bufferTargetIndex( target );
 
+	if ( index != -1 && glState.buffers[index] == buffer ){
+		glState.frame.saved++;
+		return;
+	}
 
-	// Update the whole size of each vertex
+	GLCall(glBindBuffer( target, buffer ));
+	glState.frame.issued++;
 
-	vertexBufferLayout->stride += typeSize * count;
+	if ( index != -1 )
+		glState.buffers[index] = buffer;
 }
 
+void stateBindTexture( GLuint slot, GLenum target, GLuint texture ){
 
-void init( VertexArray * vertexArray ){
+	if ( glState.activeTextureUnit != slot ){
+		GLCall(glActiveTexture( GL_TEXTURE0 + slot ));
+		glState.activeTextureUnit = slot;
+		glState.frame.issued++;
+	}
 
-	vertexArray->reservedVertexBuffers = 1;
-	vertexArray->vertexBuffers = (VertexBuffer*)
-		malloc( sizeof( VertexBuffer ) * vertexArray->reservedVertexBuffers );
-	vertexArray->vertexBufferCount = 0;
+	stateBindTexture( target, texture );
+}
 
-	// Create the vertex array and store its index
-	GLCall(glGenVertexArrays( 1, &vertexArray->rendererId ));
+void stateBindTexture( GLenum target, GLuint texture ){
+
+	GLuint slot = glState.activeTextureUnit;
+	int index = textureTargetIndex( target );
+	bool tracked = index != -1 && slot < STATE_CACHE_TEXTURE_UNITS;
+
+	if ( tracked && glState.textures[slot][index] == texture ){
+		glState.frame.saved++;
+		return;
+	}
+
+	GLCall(glBindTexture( target, texture ));
+	glState.frame.issued++;
+
+	if ( tracked )
+		glState.textures[slot][index] = texture;
 }
 
-void bind( VertexArray * vertexArray ){
+void stateBindBufferRange( GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size ){
+
+	StateCacheBufferRange * range =
+		target == GL_UNIFORM_BUFFER && index < STATE_CACHE_UNIFORM_BINDINGS ?
+		&glState.uniformBindings[index] : NULL;
+
+	if ( range != NULL && range->buffer == buffer && range->offset == offset && range->size == size ){
+		glState.frame.saved++;
+		return;
+	}
+
+	GLCall(glBindBufferRange( target, index, buffer, offset, size ));
+	glState.frame.issued++;
+
+	if ( range != NULL )
+		*range = (StateCacheBufferRange) { buffer, offset, size };
 
-	GLCall(glBindVertexArray( vertexArray->rendererId ));
+	int targetIndex = bufferTargetIndex( target );
+	if ( targetIndex != -1 )
+		glState.buffers[targetIndex] = buffer;
 }
 
-void unbind( VertexArray * vertexArray ){
+void stateForgetBuffer( GLuint buffer ){
+
+	for ( int i = 0; i < STATE_CACHE_BUFFER_TARGETS; i++ )
+		if ( glState.buffers[i] == buffer )
+			glState.buffers[i] = 0;
 
-	GLCall(glBindVertexArray( 0 ));
+	for ( int i = 0; i < STATE_CACHE_UNIFORM_BINDINGS; i++ )
+		if ( glState.uniformBindings[i].buffer == buffer )
+			glState.uniformBindings[i] = (StateCacheBufferRange) {};
 }
 
-void push( VertexArray * vertexArray, VertexBuffer * buffer, VertexBufferLayout * layout ){
+void stateForgetTexture( GLuint texture ){
 
-	unsigned int offset = 0;
-	VertexBufferLayoutElement element;
+	for ( int slot = 0; slot < STATE_CACHE_TEXTURE_UNITS; slot++ )
+		for ( int i = 0; i < STATE_CACHE_TEXTURE_TARGETS; i++ )
+			if ( glState.textures[slot][i] == texture )
+				glState.textures[slot][i] = 0;
+}
 
-	// Set the current array and buffer as selected
-	bind( vertexArray );
-	bind( buffer );
+StateCacheStats nextStateCacheFrame(){
 
-	for ( int i = 0; i < layout->elementCount; i++ ){
+	StateCacheStats stats = glState.frame;
 
-		element = layout->elements[i];
-		GLCall(glEnableVertexAttribArray( i ));
-		GLCall(glVertexAttribPointer(
-			i,
-			element.count,
-			element.type,
-			element.normalized,
-			layout->stride,
-			(const void *) offset
-		));
+	glState.frame = (StateCacheStats) {};
 
-		offset += element.count * element.typeSize;
-	}
+	return stats;
 }
 
 
-void init( Shader * shader, char* vertShaderFileName, char* fragShaderFileName ){
 
-	char* shaderFolder = "shaders/";
-	char* filePath =
-		(char*) malloc(
-			(
-				strlen( shaderFolder ) +
-				( strlen( vertShaderFileName ) > strlen( fragShaderFileName ) ?
-					strlen( vertShaderFileName ) :
-					strlen( fragShaderFileName ) )
-				+ 1 // for the '\0'
-			) *
-			sizeof( char ) // which is 1 Byte, but still, for clarity
-		);
-	GLuint program, vertShaderId, fragShaderId;
+//
+// Profiler
+//
 
-	// Get a new shader program
-	GLCall(shader->rendererId = glCreateProgram());
+// Nanoseconds from an arbitrary point, never going back
+static uint64_t nowNanoseconds(){
 
-	// Read and compile the vertex shader
-	strcpy( filePath, shaderFolder );
-	strcat( filePath, vertShaderFileName );
-	vertShaderId = compileShader( shader, GL_VERTEX_SHADER, filePath );
+#ifdef _WIN32
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
 
-	// Read and compile the fragment shader
-	strcpy( filePath, shaderFolder );
-	strcat( filePath, fragShaderFileName );
-	fragShaderId = compileShader( shader, GL_FRAGMENT_SHADER, filePath );
+	if ( frequency.QuadPart == 0 )
+		QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &counter );
 
-	// Link the shaders inside the program
-	GLCall(glAttachShader( shader->rendererId, vertShaderId ));
-	GLCall(glAttachShader( shader->rendererId, fragShaderId ));
-	GLCall(glLinkProgram( shader->rendererId ));
-	GLCall(glValidateProgram( shader->rendererId ));
+	uint64_t seconds = counter.QuadPart / frequency.QuadPart;
+	uint64_t rest = counter.QuadPart % frequency.QuadPart;
 
-	// We can delete the shaders,
-	// since they're already linked to our program
-	GLCall(glDeleteShader( vertShaderId ));
-	GLCall(glDeleteShader( fragShaderId ));
+	return seconds * 1000000000ull + rest * 1000000000ull / frequency.QuadPart;
+#else
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
 
-	free( filePath );
+	return (uint64_t) now.tv_sec * 1000000000ull + now.tv_nsec;
+#endif
 }
 
-GLuint compileShader( Shader * shader, GLuint type, char* filePath ){
+void init( Profiler * profiler ){
 
-	char* shaderSource = readFile( filePath );
-	//printf( "%s\n", shaderSource );
+	profiler->scopeCount = 0;
+	profiler->frame = 0;
+	profiler->openGpuScope = -1;
+	profiler->lateQueries = 0;
 
-	GLuint shaderId = glCreateShader( type );
-	GLCall(glShaderSource( shaderId, 1, &shaderSource, NULL )); // NULL seguro?
-	GLCall(glCompileShader( shaderId ));
+	profiler->startTime = nowNanoseconds();
+	profiler->events = (ProfilerEvent*) malloc( PROFILER_TRACE_EVENTS * sizeof( ProfilerEvent ) );
+	profiler->eventCount = 0;
+}
 
-	// Error handling
-	int result;
-	GLCall(glGetShaderiv( shaderId, GL_COMPILE_STATUS, &result ));
-	if ( result == GL_FALSE ){
-		int length;
-		glGetShaderiv( shaderId, GL_INFO_LOG_LENGTH, &length );
-		char* message = (char*) malloc( length * sizeof( char ) );
-		glGetShaderInfoLog( shaderId, length, &length, message );
-		printf(
-			"Failed to compile %s shader \"%s\":\n%s\n",
-			type == GL_VERTEX_SHADER ? "vertex" : "fragment",
-			filePath,
-			message
-		);
-		glDeleteShader( shaderId );
-		free( message );
-		return 0;
+unsigned int addScope( Profiler * profiler, const char* name, bool gpu ){
+
+	if ( profiler->scopeCount == PROFILER_MAX_SCOPES ){
+		printf( "Too many profiler scopes, %s is left out.\n", name );
+		exit( 1 );
 	}
 
-	return shaderId;
+	unsigned int index = profiler->scopeCount++;
+	ProfilerScope * scope = &profiler->scopes[index];
+
+	memset( scope, 0, sizeof( ProfilerScope ) );
+	scope->name = name;
+	scope->gpu = gpu;
+
+	if ( gpu ){
+		GLCall( glGenQueries( PROFILER_QUERY_BUFFERS, scope->queries ) );
+	}
+
+	return index;
 }
 
-void setUniform1i( Shader * shader, GLint location, GLint value ){
+static void addEvent( Profiler * profiler, unsigned int scope, uint64_t start, uint64_t duration ){
 
-	bind( shader );
-	GLCall(glUniform1i( location, value ));
+	ProfilerEvent * event = &profiler->events[profiler->eventCount++ & ( PROFILER_TRACE_EVENTS - 1 )];
+
+	event->scope = scope;
+	event->start = start - profiler->startTime;
+	event->duration = duration;
 }
 
-void setUniform4f( Shader * shader, GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3 ){
+static void addSample( ProfilerScope * scope, uint64_t nanoseconds ){
 
-	bind( shader );
-	GLCall(glUniform4f( location, v0, v1, v2, v3 ));
+	scope->history[scope->historyCount++ & ( PROFILER_HISTORY - 1 )] = nanoseconds / 1000000.0f;
 }
 
-void setUniformMatrix4fv( Shader * shader, GLint location, mat4 matrix ){
+void begin( Profiler * profiler, unsigned int scope ){
 
-	bind( shader );
-	GLCall(glUniformMatrix4fv(
-		location,
-		1, // We're only passing 1 matrix
-		GL_FALSE, // No need to transpose
-		(GLfloat *) matrix
-	));
+	ProfilerScope * s = &profiler->scopes[scope];
+
+	if ( !s->gpu ){
+		s->start = nowNanoseconds();
+		return;
+	}
+
+	unsigned int buffer = profiler->frame % PROFILER_QUERY_BUFFERS;
+
+	if ( profiler->openGpuScope != -1 || s->queryIssued[buffer] ){
+		printf( "GPU scope %s nested or entered twice in a frame.\n", s->name );
+		return;
+	}
+
+	GLCall( glBeginQuery( GL_TIME_ELAPSED, s->queries[buffer] ) );
+	s->queryStarts[buffer] = nowNanoseconds();
+	profiler->openGpuScope = scope;
 }
 
-GLint getUniformLocation( Shader * shader, char* name ){
+void end( Profiler * profiler, unsigned int scope ){
 
-	GLCall(GLint location = glGetUniformLocation( shader->rendererId, name ));
+	ProfilerScope * s = &profiler->scopes[scope];
 
-	if ( location == -1 )
-		printf( "Uniform %s has not been found.\n", name );
+	if ( !s->gpu ){
 
-	return location;
+		uint64_t now = nowNanoseconds();
+
+		s->frameTime += now - s->start;
+		s->entered = true;
+		addEvent( profiler, scope, s->start, now - s->start );
+		return;
+	}
+
+	if ( profiler->openGpuScope != (int) scope )
+		return;
+
+	GLCall( glEndQuery( GL_TIME_ELAPSED ) );
+	s->queryIssued[profiler->frame % PROFILER_QUERY_BUFFERS] = true;
+	profiler->openGpuScope = -1;
 }
 
-void bind( Shader * shader ){
+void nextFrame( Profiler * profiler ){
+
+	// Buffer the next frame will issue its queries into
+	unsigned int buffer = ( profiler->frame + 1 ) % PROFILER_QUERY_BUFFERS;
+
+	for ( unsigned int i = 0; i < profiler->scopeCount; i++ ){
+
+		ProfilerScope * scope = &profiler->scopes[i];
+
+		if ( !scope->gpu ){
 
-	GLCall(glUseProgram( shader->rendererId ));
+			if ( scope->entered )
+				addSample( scope, scope->frameTime );
+
+			scope->frameTime = 0;
+			scope->entered = false;
+			continue;
+		}
+
+		if ( !scope->queryIssued[buffer] )
+			continue;
+
+		GLuint available = GL_FALSE;
+		GLCall( glGetQueryObjectuiv( scope->queries[buffer], GL_QUERY_RESULT_AVAILABLE, &available ) );
+
+		// The query is needed again next frame, so it waits
+		if ( !available )
+			profiler->lateQueries++;
+
+		GLuint64 elapsed;
+		GLCall( glGetQueryObjectui64v( scope->queries[buffer], GL_QUERY_RESULT, &elapsed ) );
+
+		addSample( scope, elapsed );
+		// The GPU start time isn't known, only how long it took,
+		// so it goes in the trace as if it started when issued
+		addEvent( profiler, i, scope->queryStarts[buffer], elapsed );
+
+		scope->queryIssued[buffer] = false;
+	}
+
+	profiler->frame++;
 }
 
-void unbind( Shader * shader ){
+static int compareFloats( const void* a, const void* b ){
+
+	float x = *(const float*) a;
+	float y = *(const float*) b;
 
-	GLCall(glUseProgram( 0 ));
+	return ( x > y ) - ( x < y );
 }
 
+ProfilerStats getStats( Profiler * profiler, unsigned int scope ){
 
-void init( Renderer * renderer ){
+	ProfilerScope * s = &profiler->scopes[scope];
+	ProfilerStats stats = {};
+
+	unsigned int count = s->historyCount < PROFILER_HISTORY ? s->historyCount : PROFILER_HISTORY;
+
+	if ( count == 0 )
+		return stats;
+
+	float sorted[PROFILER_HISTORY];
+	memcpy( sorted, s->history, count * sizeof( float ) );
+	qsort( sorted, count, sizeof( float ), compareFloats );
 
+	stats.p50 = sorted[( count - 1 ) * 50 / 100];
+	stats.p95 = sorted[( count - 1 ) * 95 / 100];
+	stats.p99 = sorted[( count - 1 ) * 99 / 100];
+	stats.max = sorted[count - 1];
+
+	return stats;
 }
 
-void draw( Renderer * renderer, VertexArray * vertexArray, IndexBuffer * indexBuffer, Shader * shader ){
+void printStats( Profiler * profiler ){
 
-	GLCall(glDrawElements(
-		GL_TRIANGLES,
-		indexBuffer->size,
-		GL_UNSIGNED_INT,
-		NULL
-	));
+	printf( "%-16s %8s %8s %8s %8s  (ms, last %d frames)\n", "Scope", "p50", "p95", "p99", "max", PROFILER_HISTORY );
+
+	for ( unsigned int i = 0; i < profiler->scopeCount; i++ ){
+
+		ProfilerStats stats = getStats( profiler, i );
+
+		printf(
+			"%-16s %8.3f %8.3f %8.3f %8.3f\n",
+			profiler->scopes[i].name,
+			stats.p50, stats.p95, stats.p99, stats.max
+		);
+	}
+
+	if ( profiler->lateQueries > 0 )
+		printf( "%u GPU timings weren't ready in time, and were waited for\n", profiler->lateQueries );
 }
 
+bool exportTrace( Profiler * profiler, const char* path ){
+
+	FILE * f = fopen( path, "w" );
+
+	if ( !f ){
+		printf( "Couldn't write the trace to %s.\n", path );
+		return false;
+	}
+
+	// CPU scopes in a thread, GPU scopes in another
+	fprintf( f, "{\"traceEvents\":[\n" );
+	fprintf( f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n" );
+	fprintf( f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}" );
+
+	unsigned int first = profiler->eventCount > PROFILER_TRACE_EVENTS ? profiler->eventCount - PROFILER_TRACE_EVENTS : 0;
 
+	for ( unsigned int i = first; i != profiler->eventCount; i++ ){
+
+		ProfilerEvent * event = &profiler->events[i & ( PROFILER_TRACE_EVENTS - 1 )];
+		ProfilerScope * scope = &profiler->scopes[event->scope];
+
+		// Timestamps in microseconds.
+		// Scope names are string literals with nothing to escape
+		fprintf(
+			f,
+			",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+			scope->name,
+			scope->gpu ? "gpu" : "cpu",
+			scope->gpu ? 2 : 1,
+			event->start / 1000.0,
+			event->duration / 1000.0
+		);
+	}
+
+	fprintf( f, "\n]}\n" );
+
+	bool failed = ferror( f );
+	fclose( f );
+
+	if ( !failed )
+		printf( "Trace of the last %u scopes written to %s\n", profiler->eventCount - first, path );
+
+	return !failed;
+}
 
 
 
 //
-// Textures
+// Renderer
+//
+
+void init( BufferRing * ring, GLenum target, unsigned int regionSize, StreamMode mode, unsigned int alignment ){
+
+	if ( mode == STREAM_PERSISTENT && !GLEW_ARB_buffer_storage ){
+		printf( "ARB_buffer_storage is not available, mapping the buffer every frame.\n" );
+		mode = STREAM_MAP_UNSYNCHRONIZED;
+	}
+
+	ring[0] = (BufferRing) {};
+	ring->target = target;
+	ring->mode = mode;
+	ring->regionSize = regionSize;
+	ring->alignment = alignment;
+
+	bool fenced = mode == STREAM_MAP_UNSYNCHRONIZED || mode == STREAM_PERSISTENT;
+	unsigned int bufferSize = fenced ? regionSize * STREAM_RING_REGIONS : regionSize;
+
+	GLCall(glGenBuffers( 1, &ring->rendererId ));
+	stateBindBuffer( target, ring->rendererId );
+
+	if ( mode == STREAM_PERSISTENT ){
+
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		GLCall(glBufferStorage( target, bufferSize, NULL, flags ));
+		GLCall(ring->persistentData = (char*) glMapBufferRange( target, 0, bufferSize, flags ));
+	}
+	else {
+		GLCall(glBufferData( target, bufferSize, NULL, GL_STREAM_DRAW ));
+	}
+
+	if ( !fenced )
+		ring->staging = (char*) malloc( regionSize );
+}
+
+// Make sure the GPU is done with the current region
+static void waitForRegion( BufferRing * ring ){
+
+	GLsync fence = ring->fences[ring->region];
+
+	if ( fence == 0 )
+		return;
+
+	// Only waits if the GPU is more than
+	// STREAM_RING_REGIONS - 1 frames behind
+	GLenum result = GL_TIMEOUT_EXPIRED;
+	while ( result == GL_TIMEOUT_EXPIRED ){
+		GLCall(result = glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000 ));
+	}
+
+	GLCall(glDeleteSync( fence ));
+	ring->fences[ring->region] = 0;
+}
+
+void* beginWrite( BufferRing * ring, unsigned int size, unsigned int * offset ){
+
+	unsigned int start = ( ring->used + ring->alignment - 1 ) & ~( ring->alignment - 1 );
+
+	if ( start + size > ring->regionSize ){
+		printf( "Streaming buffer full, %u bytes dropped.\n", size );
+		return NULL;
+	}
+
+	// First write of the frame
+	if ( ring->used == 0 ){
+		if ( ring->mode == STREAM_ORPHAN ){
+			stateBindBuffer( ring->target, ring->rendererId );
+			GLCall(glBufferData( ring->target, ring->regionSize, NULL, GL_STREAM_DRAW ));
+		}
+		else
+			waitForRegion( ring );
+	}
+
+	ring->used = start + size;
+	ring->writeSize = size;
+
+	switch ( ring->mode ){
+
+		case STREAM_SUB_DATA:
+		case STREAM_ORPHAN:
+			ring->writeOffset = *offset = start;
+			return ring->staging + start;
+
+		case STREAM_MAP_UNSYNCHRONIZED: {
+			void* data;
+
+			ring->writeOffset = *offset = ring->region * ring->regionSize + start;
+
+			stateBindBuffer( ring->target, ring->rendererId );
+			GLCall(data = glMapBufferRange(
+				ring->target,
+				ring->writeOffset,
+				size,
+				GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT
+			));
+
+			return data;
+		}
+
+		case STREAM_PERSISTENT:
+			ring->writeOffset = *offset = ring->region * ring->regionSize + start;
+			return ring->persistentData + ring->writeOffset;
+	}
+
+	return NULL;
+}
+
+bool hasRoom( BufferRing * ring, unsigned int size ){
+
+	unsigned int start = ( ring->used + ring->alignment - 1 ) & ~( ring->alignment - 1 );
+
+	return start + size <= ring->regionSize;
+}
+
+void endWrite( BufferRing * ring ){
+
+	switch ( ring->mode ){
+
+		case STREAM_SUB_DATA:
+		case STREAM_ORPHAN:
+			stateBindBuffer( ring->target, ring->rendererId );
+			GLCall(glBufferSubData(
+				ring->target,
+				ring->writeOffset,
+				ring->writeSize,
+				ring->staging + ring->writeOffset
+			));
+			break;
+
+		case STREAM_MAP_UNSYNCHRONIZED:
+			stateBindBuffer( ring->target, ring->rendererId );
+			GLCall(glUnmapBuffer( ring->target ));
+			break;
+
+		case STREAM_PERSISTENT:
+			// Coherent mapping, nothing to flush
+			break;
+	}
+}
+
+void nextFrame( BufferRing * ring ){
+
+	bool fenced = ring->mode == STREAM_MAP_UNSYNCHRONIZED || ring->mode == STREAM_PERSISTENT;
+
+	if ( fenced && ring->used > 0 ){
+		GLCall(ring->fences[ring->region] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 ));
+		ring->region = ( ring->region + 1 ) % STREAM_RING_REGIONS;
+	}
+
+	ring->used = 0;
+}
+
+void destroy( BufferRing * ring ){
+
+	for ( int i = 0; i < STREAM_RING_REGIONS; i++ )
+		if ( ring->fences[i] != 0 ){
+			GLCall(glDeleteSync( ring->fences[i] ));
+		}
+
+	if ( ring->persistentData != NULL ){
+		stateBindBuffer( ring->target, ring->rendererId );
+		GLCall(glUnmapBuffer( ring->target ));
+	}
+
+	stateForgetBuffer( ring->rendererId );
+	GLCall(glDeleteBuffers( 1, &ring->rendererId ));
+
+	free( ring->staging );
+	ring[0] = (BufferRing) {};
+}
+
+
+void init( VertexBuffer * vertexBuffer, unsigned int size, const void* data, GLenum usage ){
+
+	vertexBuffer->size = size;
+	vertexBuffer->ring = NULL;
+
+	// Create the vertex buffer and store its index
+	GLCall(glGenBuffers( 1, &vertexBuffer->rendererId ));
+
+	// Set the created object as selected
+	stateBindBuffer( GL_ARRAY_BUFFER, vertexBuffer->rendererId );
+
+	// Upload data to the selected buffer
+	GLCall(glBufferData( GL_ARRAY_BUFFER, size, data, usage ));
+}
+
+void init( VertexBuffer * vertexBuffer, unsigned int regionSize, StreamMode mode ){
+
+	vertexBuffer->size = regionSize;
+	vertexBuffer->ring = (BufferRing*) malloc( sizeof( BufferRing ) );
+
+	init( vertexBuffer->ring, GL_ARRAY_BUFFER, regionSize, mode );
+
+	vertexBuffer->rendererId = vertexBuffer->ring->rendererId;
+}
+
+void update( VertexBuffer * vertexBuffer, unsigned int offset, unsigned int size, const void* data ){
+
+	bind( vertexBuffer );
+	GLCall(glBufferSubData( GL_ARRAY_BUFFER, offset, size, data ));
+}
+
+void* beginWrite( VertexBuffer * vertexBuffer, unsigned int size, unsigned int * offset ){
+
+	return beginWrite( vertexBuffer->ring, size, offset );
+}
+
+void endWrite( VertexBuffer * vertexBuffer ){
+
+	endWrite( vertexBuffer->ring );
+}
+
+void nextFrame( VertexBuffer * vertexBuffer ){
+
+	nextFrame( vertexBuffer->ring );
+}
+
+
+void bind( VertexBuffer * vertexBuffer ){
+
+	stateBindBuffer( GL_ARRAY_BUFFER, vertexBuffer->rendererId );
+}
+
+void unbind(  VertexBuffer * vertexBuffer  ){
+
+	stateBindBuffer( GL_ARRAY_BUFFER, 0 );
+}
+
+
+void init( IndexBuffer * indexBuffer, unsigned int size, const GLuint* data ){
+
+	indexBuffer->size = size;
+	indexBuffer->count = size / sizeof( GLuint );
+
+	// Create the index buffer and store its index
+	GLCall(glGenBuffers( 1, &indexBuffer->rendererId ));
+
+	// Set the created object as selected
+	stateBindBuffer( GL_ELEMENT_ARRAY_BUFFER, indexBuffer->rendererId );
+
+	// Upload data to the selected buffer
+	GLCall(glBufferData( GL_ELEMENT_ARRAY_BUFFER, size, data, GL_STATIC_DRAW ));
+}
+
+
+void bind( IndexBuffer * indexBuffer ){
+
+	stateBindBuffer( GL_ELEMENT_ARRAY_BUFFER, indexBuffer->rendererId );
+}
+
+void unbind(  IndexBuffer * indexBuffer  ){
+
+	stateBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+}
+
+
+void init( VertexBufferLayout * vertexBufferLayout, GLuint divisor ){
+
+	vertexBufferLayout->reservedElements = 1;
+	vertexBufferLayout->divisor = divisor;
+
+	vertexBufferLayout->elements = (VertexBufferLayoutElement*)
+		malloc(
+			sizeof( VertexBufferLayoutElement ) * vertexBufferLayout->reservedElements
+		);
+
+	vertexBufferLayout->elementCount = 0;
+	vertexBufferLayout->stride = 0;
+}
+
+void push( VertexBufferLayout * vertexBufferLayout, unsigned int count, GLenum type ){
+
+	// Reserve more space
+
+	if ( vertexBufferLayout->elementCount == vertexBufferLayout->reservedElements ){
+
+		VertexBufferLayoutElement * tmp = (VertexBufferLayoutElement*)
+			malloc(
+				sizeof( VertexBufferLayoutElement ) * vertexBufferLayout->reservedElements * 2
+			);
+
+		for ( int i = 0; i < vertexBufferLayout->reservedElements; i++ )
+			tmp[i] = vertexBufferLayout->elements[i];
+
+		free( vertexBufferLayout->elements );
+
+		vertexBufferLayout->elements = tmp;
+		vertexBufferLayout->reservedElements *= 2;
+	}
+
+
+	// Push the new element
+
+	unsigned int typeSize =
+		type == GL_FLOAT ?
+			sizeof( GLfloat ) :
+		type == GL_UNSIGNED_INT ?
+			sizeof( GLuint ) :
+		sizeof( GLubyte );
+
+	VertexBufferLayoutElement newElement = (VertexBufferLayoutElement) {
+		.type = type,
+		.count = count,
+		.normalized = GL_FALSE,
+		.typeSize = typeSize
+	};
+	vertexBufferLayout->elements[vertexBufferLayout->elementCount] = newElement;
+	vertexBufferLayout->elementCount++;
+
+
+	// Update the whole size of each vertex
+
+	vertexBufferLayout->stride += typeSize * count;
+}
+
+
+void init( VertexArray * vertexArray ){
+
+	vertexArray->reservedVertexBuffers = 1;
+	vertexArray->vertexBuffers = (VertexBuffer*)
+		malloc( sizeof( VertexBuffer ) * vertexArray->reservedVertexBuffers );
+	vertexArray->vertexBufferCount = 0;
+	vertexArray->attributeCount = 0;
+
+	// Create the vertex array and store its index
+	GLCall(glGenVertexArrays( 1, &vertexArray->rendererId ));
+}
+
+void bind( VertexArray * vertexArray ){
+
+	stateBindVertexArray( vertexArray->rendererId );
+}
+
+void unbind( VertexArray * vertexArray ){
+
+	stateBindVertexArray( 0 );
+}
+
+void push( VertexArray * vertexArray, VertexBuffer * buffer, VertexBufferLayout * layout ){
+
+	unsigned int offset = 0;
+	VertexBufferLayoutElement element;
+
+	// Set the current array and buffer as selected
+	bind( vertexArray );
+	bind( buffer );
+
+	for ( int i = 0; i < layout->elementCount; i++ ){
+
+		element = layout->elements[i];
+
+		// One location for every 4 components
+		for ( int component = 0; component < element.count; component += 4 ){
+
+			GLuint location = vertexArray->attributeCount++;
+
+			GLCall(glEnableVertexAttribArray( location ));
+			GLCall(glVertexAttribPointer(
+				location,
+				element.count - component < 4 ? element.count - component : 4,
+				element.type,
+				element.normalized,
+				layout->stride,
+				(const void *) ( offset + component * element.typeSize )
+			));
+			GLCall(glVertexAttribDivisor( location, layout->divisor ));
+		}
+
+		offset += element.count * element.typeSize;
+	}
+}
+
+
+static void init( ArenaFreeList * freeList, unsigned int capacity ){
+
+	freeList->reservedRanges = 4;
+	freeList->ranges = (ArenaRange*)
+		malloc( sizeof( ArenaRange ) * freeList->reservedRanges );
+
+	freeList->ranges[0] = (ArenaRange) { 0, capacity };
+	freeList->rangeCount = 1;
+	freeList->capacity = capacity;
+}
+
+// First fit
+static bool allocate( ArenaFreeList * freeList, unsigned int size, unsigned int * offset ){
+
+	for ( int i = 0; i < freeList->rangeCount; i++ ){
+
+		ArenaRange * range = &freeList->ranges[i];
+
+		if ( range->size < size )
+			continue;
+
+		*offset = range->offset;
+		range->offset += size;
+		range->size -= size;
+
+		if ( range->size == 0 ){
+			freeList->rangeCount--;
+			memmove( range, range + 1, sizeof( ArenaRange ) * ( freeList->rangeCount - i ) );
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+// Give a range back, joining it with its neighbours
+static void deallocate( ArenaFreeList * freeList, unsigned int offset, unsigned int size ){
+
+	if ( size == 0 )
+		return;
+
+	int i = 0;
+	while ( i < freeList->rangeCount && freeList->ranges[i].offset < offset )
+		i++;
+
+	bool joinsPrevious =
+		i > 0 &&
+		freeList->ranges[i - 1].offset + freeList->ranges[i - 1].size == offset;
+	bool joinsNext =
+		i < freeList->rangeCount &&
+		offset + size == freeList->ranges[i].offset;
+
+	if ( joinsPrevious && joinsNext ){
+		freeList->ranges[i - 1].size += size + freeList->ranges[i].size;
+		freeList->rangeCount--;
+		memmove(
+			&freeList->ranges[i],
+			&freeList->ranges[i + 1],
+			sizeof( ArenaRange ) * ( freeList->rangeCount - i )
+		);
+	}
+	else if ( joinsPrevious )
+		freeList->ranges[i - 1].size += size;
+	else if ( joinsNext ){
+		freeList->ranges[i].offset = offset;
+		freeList->ranges[i].size += size;
+	}
+	else {
+
+		if ( freeList->rangeCount == freeList->reservedRanges ){
+			freeList->reservedRanges *= 2;
+			freeList->ranges = (ArenaRange*) realloc(
+				freeList->ranges,
+				sizeof( ArenaRange ) * freeList->reservedRanges
+			);
+		}
+
+		memmove(
+			&freeList->ranges[i + 1],
+			&freeList->ranges[i],
+			sizeof( ArenaRange ) * ( freeList->rangeCount - i )
+		);
+		freeList->ranges[i] = (ArenaRange) { offset, size };
+		freeList->rangeCount++;
+	}
+}
+
+
+void init( MeshArena * arena, VertexBufferLayout * layout, unsigned int vertexCapacity, unsigned int indexCapacity ){
+
+	arena->layout = layout;
+
+	arena->vertexArray = (VertexArray*) malloc( sizeof( VertexArray ) );
+	init( arena->vertexArray );
+	bind( arena->vertexArray );
+
+	// Bound while the vertex array is,
+	// so that it gets stored in it
+	arena->indexBuffer = (IndexBuffer*) malloc( sizeof( IndexBuffer ) );
+	init( arena->indexBuffer, indexCapacity * sizeof( GLuint ), NULL );
+
+	arena->vertexBuffer = (VertexBuffer*) malloc( sizeof( VertexBuffer ) );
+	init( arena->vertexBuffer, vertexCapacity * layout->stride, NULL, GL_DYNAMIC_DRAW );
+
+	push( arena->vertexArray, arena->vertexBuffer, layout );
+
+	init( &arena->freeVertices, vertexCapacity );
+	init( &arena->freeIndices, indexCapacity );
+
+	arena->reservedMeshes = 16;
+	arena->meshCount = 0;
+	arena->meshes = (ArenaMesh**) malloc( sizeof( ArenaMesh* ) * arena->reservedMeshes );
+}
+
+ArenaMesh * add(
+	MeshArena * arena,
+	const void* vertices,
+	unsigned int vertexCount,
+	const GLuint* indices,
+	unsigned int indexCount ){
+
+	ArenaMesh * mesh = (ArenaMesh*) malloc( sizeof( ArenaMesh ) );
+
+	mesh->vertexCount = vertexCount;
+	mesh->indexCount = indexCount;
+
+
+	// Find room for it, compacting if there's enough space
+	// but it's split in pieces too small
+
+	bool fits =
+		allocate( &arena->freeVertices, vertexCount, &mesh->firstVertex );
+
+	if ( fits && !allocate( &arena->freeIndices, indexCount, &mesh->firstIndex ) ){
+		deallocate( &arena->freeVertices, mesh->firstVertex, vertexCount );
+		fits = false;
+	}
+
+	if ( !fits ){
+
+		compact( arena );
+
+		fits = allocate( &arena->freeVertices, vertexCount, &mesh->firstVertex );
+
+		if ( fits && !allocate( &arena->freeIndices, indexCount, &mesh->firstIndex ) ){
+			deallocate( &arena->freeVertices, mesh->firstVertex, vertexCount );
+			fits = false;
+		}
+	}
+
+	if ( !fits ){
+		printf( "Mesh arena full, mesh of %u vertices not added.\n", vertexCount );
+		free( mesh );
+		return NULL;
+	}
+
+
+	// Upload it
+
+	unsigned int stride = arena->layout->stride;
+
+	update( arena->vertexBuffer, mesh->firstVertex * stride, vertexCount * stride, vertices );
+
+	// Not through the element array target,
+	// which would change the bound vertex array
+	stateBindBuffer( GL_COPY_WRITE_BUFFER, arena->indexBuffer->rendererId );
+	GLCall(glBufferSubData(
+		GL_COPY_WRITE_BUFFER,
+		mesh->firstIndex * sizeof( GLuint ),
+		indexCount * sizeof( GLuint ),
+		indices
+	));
+
+
+	// Keep track of it, for compaction
+
+	if ( arena->meshCount == arena->reservedMeshes ){
+		arena->reservedMeshes *= 2;
+		arena->meshes = (ArenaMesh**) realloc(
+			arena->meshes,
+			sizeof( ArenaMesh* ) * arena->reservedMeshes
+		);
+	}
+
+	arena->meshes[arena->meshCount++] = mesh;
+
+	return mesh;
+}
+
+void release( MeshArena * arena, ArenaMesh * mesh ){
+
+	deallocate( &arena->freeVertices, mesh->firstVertex, mesh->vertexCount );
+	deallocate( &arena->freeIndices, mesh->firstIndex, mesh->indexCount );
+
+	for ( int i = 0; i < arena->meshCount; i++ )
+		if ( arena->meshes[i] == mesh ){
+			arena->meshes[i] = arena->meshes[--arena->meshCount];
+			break;
+		}
+
+	free( mesh );
+}
+
+void compact( MeshArena * arena ){
+
+	unsigned int stride = arena->layout->stride;
+	unsigned int vertexBytes = arena->freeVertices.capacity * stride;
+	unsigned int indexBytes = arena->freeIndices.capacity * sizeof( GLuint );
+	unsigned int packedVertices = 0, packedIndices = 0;
+	GLuint scratch;
+
+	// Copies inside a buffer can't overlap,
+	// so everything goes packed to a scratch buffer and back
+
+	GLCall(glGenBuffers( 1, &scratch ));
+	stateBindBuffer( GL_COPY_WRITE_BUFFER, scratch );
+	GLCall(glBufferData(
+		GL_COPY_WRITE_BUFFER,
+		vertexBytes > indexBytes ? vertexBytes : indexBytes,
+		NULL,
+		GL_STREAM_COPY
+	));
+
+
+	// Vertices
+
+	stateBindBuffer( GL_COPY_READ_BUFFER, arena->vertexBuffer->rendererId );
+
+	for ( int i = 0; i < arena->meshCount; i++ ){
+
+		ArenaMesh * mesh = arena->meshes[i];
+
+		if ( mesh->vertexCount > 0 ){
+			GLCall(glCopyBufferSubData(
+				GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+				mesh->firstVertex * stride,
+				packedVertices * stride,
+				mesh->vertexCount * stride
+			));
+		}
+
+		mesh->firstVertex = packedVertices;
+		packedVertices += mesh->vertexCount;
+	}
+
+	if ( packedVertices > 0 ){
+		stateBindBuffer( GL_COPY_READ_BUFFER, scratch );
+		stateBindBuffer( GL_COPY_WRITE_BUFFER, arena->vertexBuffer->rendererId );
+		GLCall(glCopyBufferSubData(
+			GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+			0, 0, packedVertices * stride
+		));
+	}
+
+
+	// Indices.
+	// They are relative to the first vertex of each mesh,
+	// so they stay the same
+
+	stateBindBuffer( GL_COPY_READ_BUFFER, arena->indexBuffer->rendererId );
+	stateBindBuffer( GL_COPY_WRITE_BUFFER, scratch );
+
+	for ( int i = 0; i < arena->meshCount; i++ ){
+
+		ArenaMesh * mesh = arena->meshes[i];
+
+		if ( mesh->indexCount > 0 ){
+			GLCall(glCopyBufferSubData(
+				GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+				mesh->firstIndex * sizeof( GLuint ),
+				packedIndices * sizeof( GLuint ),
+				mesh->indexCount * sizeof( GLuint )
+			));
+		}
+
+		mesh->firstIndex = packedIndices;
+		packedIndices += mesh->indexCount;
+	}
+
+	if ( packedIndices > 0 ){
+		stateBindBuffer( GL_COPY_READ_BUFFER, scratch );
+		stateBindBuffer( GL_COPY_WRITE_BUFFER, arena->indexBuffer->rendererId );
+		GLCall(glCopyBufferSubData(
+			GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+			0, 0, packedIndices * sizeof( GLuint )
+		));
+	}
+
+	stateForgetBuffer( scratch );
+	GLCall(glDeleteBuffers( 1, &scratch ));
+
+
+	// All the free space is now at the end
+
+	arena->freeVertices.ranges[0] = (ArenaRange) {
+		packedVertices,
+		arena->freeVertices.capacity - packedVertices
+	};
+	arena->freeVertices.rangeCount = packedVertices < arena->freeVertices.capacity ? 1 : 0;
+
+	arena->freeIndices.ranges[0] = (ArenaRange) {
+		packedIndices,
+		arena->freeIndices.capacity - packedIndices
+	};
+	arena->freeIndices.rangeCount = packedIndices < arena->freeIndices.capacity ? 1 : 0;
+}
+
+
+// Where the #version line ends, 0 if there is none
+static GLint versionLineEnd( const GLchar* source, GLint length ){
+
+	const char* version = "#version";
+	GLint versionLength = strlen( version );
+
+	for ( GLint i = 0; i + versionLength <= length; i++ ){
+
+		if ( strncmp( source + i, version, versionLength ) != 0 )
+			continue;
+
+		while ( i < length && source[i] != '\n' )
+			i++;
+
+		return i < length ? i + 1 : length;
+	}
+
+	return 0;
+}
+
+// Start compiling, without waiting for the result.
+// defines, if any, go in right after #version, which has to come first
+static GLuint submitShader( GLuint type, const GLchar* source, GLint length, const char* defines = NULL ){
+
+	// With lengths, as sources straight from a file
+	// aren't null terminated
+	const GLchar* sources[3];
+	GLint lengths[3];
+	GLsizei count = 0;
+	GLint split = 0;
+
+	if ( defines != NULL && defines[0] != '\0' ){
+
+		split = versionLineEnd( source, length );
+
+		sources[count] = source;
+		lengths[count++] = split;
+		sources[count] = defines;
+		lengths[count++] = strlen( defines );
+	}
+
+	sources[count] = source + split;
+	lengths[count++] = length - split;
+
+	GLuint shaderId = glCreateShader( type );
+	GLCall(glShaderSource( shaderId, count, sources, lengths ));
+	GLCall(glCompileShader( shaderId ));
+
+	return shaderId;
+}
+
+// Waits for it to compile. Deleted and 0 if it failed
+static GLuint checkShader( GLuint shaderId, GLuint type, const char* name ){
+
+	// Error handling
+	int result;
+	GLCall(glGetShaderiv( shaderId, GL_COMPILE_STATUS, &result ));
+	if ( result == GL_FALSE ){
+		int length;
+		glGetShaderiv( shaderId, GL_INFO_LOG_LENGTH, &length );
+		char* message = (char*) malloc( length * sizeof( char ) );
+		glGetShaderInfoLog( shaderId, length, &length, message );
+		printf(
+			"Failed to compile %s shader \"%s\":\n%s\n",
+			type == GL_VERTEX_SHADER ? "vertex" : "fragment",
+			name,
+			message
+		);
+		glDeleteShader( shaderId );
+		free( message );
+		return 0;
+	}
+
+	return shaderId;
+}
+
+GLuint compileShader( Shader * shader, GLuint type, const GLchar* source, GLint length, const char* name ){
+
+	return checkShader( submitShader( type, source, length ), type, name );
+}
+
+//
+// Program binary cache
+//
+
+#define SHADER_CACHE_FOLDER ".cache/shaders/"
+
+// Start of each cached program
+typedef struct {
+	uint32_t magic;
+	GLenum format;
+	GLint length;
+} ProgramCacheHeader;
+
+#define PROGRAM_CACHE_MAGIC 0x4D4F5250 // "PROM"
+
+static bool programCacheSupported(){
+
+	GLint formats = 0;
+
+	if ( GLEW_ARB_get_program_binary || GLEW_VERSION_4_1 ){
+		GLCall(glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &formats ));
+	}
+
+	return formats > 0;
+}
+
+// Cache file of a program, from its sources and the driver,
+// as binaries only work with the driver that made them
+static void programCachePath( FileView * vertSource, FileView * fragSource, const char* defines, char* path ){
+
+	const char* driver[] = {
+		(const char*) glGetString( GL_VENDOR ),
+		(const char*) glGetString( GL_RENDERER ),
+		(const char*) glGetString( GL_VERSION )
+	};
+
+	uint64_t hash = hashBytes( vertSource->data, vertSource->size );
+	// So that moving text from one to the other changes it
+	hash = hashBytes( "\0", 1, hash );
+	hash = hashBytes( fragSource->data, fragSource->size, hash );
+	hash = hashBytes( defines, strlen( defines ) + 1, hash );
+
+	for ( int i = 0; i < 3; i++ )
+		if ( driver[i] != NULL )
+			hash = hashBytes( driver[i], strlen( driver[i] ) + 1, hash );
+
+	sprintf( path, SHADER_CACHE_FOLDER "%016llx.bin", (unsigned long long) hash );
+}
+
+static void makeDirectory( const char* path ){
+
+#ifdef _WIN32
+	CreateDirectoryA( path, NULL );
+#else
+	mkdir( path, 0755 );
+#endif
+}
+
+// False if there is no usable binary, and it has to be compiled
+static bool loadProgramBinary( GLuint program, const char* path ){
+
+	FileView file;
+	ProgramCacheHeader header;
+
+	// Not cached yet
+	if ( access( path, R_OK ) != 0 )
+		return false;
+
+	if ( !mapFile( &file, path ) )
+		return false;
+
+	bool loaded = false;
+
+	if ( file.size >= sizeof( header ) ){
+
+		memcpy( &header, file.data, sizeof( header ) );
+
+		if ( header.magic == PROGRAM_CACHE_MAGIC && header.length == (GLint) ( file.size - sizeof( header ) ) ){
+
+			GLCall(glProgramBinary( program, header.format, file.data + sizeof( header ), header.length ));
+
+			// Rejected if the driver changed in a way the key didn't catch
+			GLint status;
+			GLCall(glGetProgramiv( program, GL_LINK_STATUS, &status ));
+			loaded = status == GL_TRUE;
+		}
+	}
+
+	unmapFile( &file );
+
+	// Don't try it again
+	if ( !loaded )
+		remove( path );
+
+	return loaded;
+}
+
+static void saveProgramBinary( GLuint program, const char* path ){
+
+	ProgramCacheHeader header;
+	header.magic = PROGRAM_CACHE_MAGIC;
+
+	GLCall(glGetProgramiv( program, GL_PROGRAM_BINARY_LENGTH, &header.length ));
+	if ( header.length <= 0 )
+		return;
+
+	void* binary = malloc( header.length );
+	GLCall(glGetProgramBinary( program, header.length, NULL, &header.format, binary ));
+
+	makeDirectory( ".cache" );
+	makeDirectory( SHADER_CACHE_FOLDER );
+
+	FILE * f = fopen( path, "wb" );
+
+	if ( f ){
+		fwrite( &header, sizeof( header ), 1, f );
+		fwrite( binary, 1, header.length, f );
+		fclose( f );
+	}
+
+	free( binary );
+}
+
+void init(
+	Shader * shader,
+	char* vertShaderFileName, char* fragShaderFileName,
+	const char* const* defines, unsigned int defineCount ){
+
+	char* shaderFolder = "shaders/";
+	char* filePath =
+		(char*) malloc(
+			(
+				strlen( shaderFolder ) +
+				( strlen( vertShaderFileName ) > strlen( fragShaderFileName ) ?
+					strlen( vertShaderFileName ) :
+					strlen( fragShaderFileName ) )
+				+ 1 // for the '\0'
+			) *
+			sizeof( char ) // which is 1 Byte, but still, for clarity
+		);
+	FileView vertSource, fragSource;
+
+	// Let the driver use as many threads as it wants, once
+	static bool compilerThreadsSet = false;
+	if ( !compilerThreadsSet ){
+		if ( GLEW_KHR_parallel_shader_compile ){
+			GLCall(glMaxShaderCompilerThreadsKHR( 0xFFFFFFFF ));
+		}
+		compilerThreadsSet = true;
+	}
+
+	shader->pending = false;
+	shader->cachePath[0] = '\0';
+
+	// All the defines as source text
+	size_t defineBlockLength = 1;
+	for ( unsigned int i = 0; i < defineCount; i++ )
+		defineBlockLength += strlen( "#define \n" ) + strlen( defines[i] );
+
+	char* defineBlock = (char*) malloc( defineBlockLength );
+	defineBlock[0] = '\0';
+
+	for ( unsigned int i = 0; i < defineCount; i++ ){
+		strcat( defineBlock, "#define " );
+		strcat( defineBlock, defines[i] );
+		strcat( defineBlock, "\n" );
+	}
+
+	// Get a new shader program
+	GLCall(shader->rendererId = glCreateProgram());
+
+	// Read the sources
+	strcpy( filePath, shaderFolder );
+	strcat( filePath, vertShaderFileName );
+	bool vertRead = mapFile( &vertSource, filePath );
+
+	strcpy( filePath, shaderFolder );
+	strcat( filePath, fragShaderFileName );
+	bool fragRead = mapFile( &fragSource, filePath );
+
+	// mapFile already said which one is missing.
+	// Left as an empty program, with no uniforms
+	if ( !vertRead || !fragRead ){
+		unmapFile( &vertSource );
+		unmapFile( &fragSource );
+		buildUniformTable( shader );
+		free( defineBlock );
+		free( filePath );
+		return;
+	}
+
+
+	// Already linked in a previous run
+
+	bool cacheSupported = programCacheSupported();
+	bool cached = false;
+
+	if ( cacheSupported ){
+		programCachePath( &vertSource, &fragSource, defineBlock, shader->cachePath );
+		cached = loadProgramBinary( shader->rendererId, shader->cachePath );
+	}
+
+
+	if ( !cached ){
+
+		// Start compiling the vertex and fragment shaders
+		shader->pendingShaders[0] = submitShader(
+			GL_VERTEX_SHADER,
+			(const GLchar*) vertSource.data, vertSource.size,
+			defineBlock
+		);
+		shader->pendingShaders[1] = submitShader(
+			GL_FRAGMENT_SHADER,
+			(const GLchar*) fragSource.data, fragSource.size,
+			defineBlock
+		);
+		shader->pendingNames[0] = strdup( vertShaderFileName );
+		shader->pendingNames[1] = strdup( fragShaderFileName );
+
+		// Link the shaders inside the program,
+		// letting the driver know that we'll want the result back
+		if ( cacheSupported ){
+			GLCall(glProgramParameteri( shader->rendererId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE ));
+		}
+
+		GLCall(glAttachShader( shader->rendererId, shader->pendingShaders[0] ));
+		GLCall(glAttachShader( shader->rendererId, shader->pendingShaders[1] ));
+		GLCall(glLinkProgram( shader->rendererId ));
+
+		shader->pending = true;
+	}
+
+	unmapFile( &vertSource );
+	unmapFile( &fragSource );
+
+	if ( !shader->pending ){
+		buildUniformTable( shader );
+		bindUniformBlocks( shader );
+	}
+
+	free( defineBlock );
+	free( filePath );
+}
+
+bool isReady( Shader * shader ){
+
+	if ( !shader->pending )
+		return true;
+
+	if ( !GLEW_KHR_parallel_shader_compile )
+		return true;
+
+	GLint completed;
+	GLCall(glGetProgramiv( shader->rendererId, GL_COMPLETION_STATUS_KHR, &completed ));
+
+	return completed == GL_TRUE;
+}
+
+void finishCompiling( Shader * shader ){
+
+	if ( !shader->pending )
+		return;
+
+	shader->pending = false;
+
+
+	// Compile errors, waiting for them if needed
+
+	GLuint types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+	bool compiled = true;
+
+	for ( int i = 0; i < 2; i++ ){
+
+		// Linking is already under way, so the program
+		// doesn't need them any more, compiled or not
+		GLCall(glDetachShader( shader->rendererId, shader->pendingShaders[i] ));
+
+		// Deleted by the check when they failed
+		if ( checkShader( shader->pendingShaders[i], types[i], shader->pendingNames[i] ) == 0 )
+			compiled = false;
+		else{
+			GLCall(glDeleteShader( shader->pendingShaders[i] ));
+		}
+	}
+
+
+	// And link errors
+
+	GLint status;
+	GLCall(glGetProgramiv( shader->rendererId, GL_LINK_STATUS, &status ));
+
+	if ( status == GL_FALSE ){
+		if ( compiled )
+			printf( "Failed to link shaders \"%s\" and \"%s\"\n", shader->pendingNames[0], shader->pendingNames[1] );
+	}
+	else{
+		GLCall(glValidateProgram( shader->rendererId ));
+
+		if ( shader->cachePath[0] != '\0' )
+			saveProgramBinary( shader->rendererId, shader->cachePath );
+	}
+
+	free( shader->pendingNames[0] );
+	free( shader->pendingNames[1] );
+
+	buildUniformTable( shader );
+	bindUniformBlocks( shader );
+}
+
+// FNV-1a, good enough for short uniform names
+static unsigned int hashUniformName( const char* name ){
+
+	unsigned int hash = 2166136261u;
+
+	while ( *name ){
+		hash ^= (unsigned char) *name++;
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+void buildUniformTable( Shader * shader ){
+
+	GLint activeUniforms, maxNameLength;
+
+	GLCall(glGetProgramiv( shader->rendererId, GL_ACTIVE_UNIFORMS, &activeUniforms ));
+	GLCall(glGetProgramiv( shader->rendererId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength ));
+
+	shader->uniforms = (ShaderUniform*) malloc( sizeof( ShaderUniform ) * ( activeUniforms + 1 ) );
+	shader->uniformCount = 0;
+	shader->uniformLocationCount = 0;
+
+	char* name = (char*) malloc( ( maxNameLength + 1 ) * sizeof( char ) );
+
+	for ( int i = 0; i < activeUniforms; i++ ){
+
+		ShaderUniform uniform = (ShaderUniform) {};
+		GLsizei nameLength;
+
+		GLCall(glGetActiveUniform(
+			shader->rendererId, i, maxNameLength + 1,
+			&nameLength, &uniform.size, &uniform.type, name
+		));
+
+		// Uniforms inside blocks have no location
+		GLCall(uniform.location = glGetUniformLocation( shader->rendererId, name ));
+		if ( uniform.location == -1 )
+			continue;
+
+		// Arrays are reported as "name[0]", but looked up as "name"
+		if ( nameLength > 3 && strcmp( name + nameLength - 3, "[0]" ) == 0 )
+			name[nameLength - 3] = '\0';
+
+		uniform.name = strdup( name );
+		shader->uniforms[shader->uniformCount++] = uniform;
+
+		if ( uniform.location >= shader->uniformLocationCount )
+			shader->uniformLocationCount = uniform.location + 1;
+	}
+
+	free( name );
+
+
+	// Hash table by name, with linear probing.
+	// Kept at most half full so lookups stay short
+
+	shader->uniformSlotCount = 4;
+	while ( shader->uniformSlotCount < shader->uniformCount * 2 )
+		shader->uniformSlotCount *= 2;
+
+	shader->uniformSlots = (int*) malloc( sizeof( int ) * shader->uniformSlotCount );
+	for ( int i = 0; i < shader->uniformSlotCount; i++ )
+		shader->uniformSlots[i] = -1;
+
+	for ( int i = 0; i < shader->uniformCount; i++ ){
+
+		unsigned int slot = hashUniformName( shader->uniforms[i].name );
+
+		while ( shader->uniformSlots[slot & ( shader->uniformSlotCount - 1 )] != -1 )
+			slot++;
+
+		shader->uniformSlots[slot & ( shader->uniformSlotCount - 1 )] = i;
+	}
+
+
+	// Direct table by location
+
+	shader->uniformsByLocation = (int*) malloc( sizeof( int ) * ( shader->uniformLocationCount + 1 ) );
+	for ( int i = 0; i < shader->uniformLocationCount; i++ )
+		shader->uniformsByLocation[i] = -1;
+
+	for ( int i = 0; i < shader->uniformCount; i++ )
+		shader->uniformsByLocation[shader->uniforms[i].location] = i;
+}
+
+void bindUniformBlocks( Shader * shader ){
+
+	const char* names[] = { "FrameData", "ObjectData" };
+	GLuint bindings[] = { UNIFORM_BLOCK_FRAME, UNIFORM_BLOCK_OBJECT };
+
+	for ( int i = 0; i < 2; i++ ){
+
+		GLuint index;
+		GLCall(index = glGetUniformBlockIndex( shader->rendererId, names[i] ));
+
+		// Not every program uses both
+		if ( index != GL_INVALID_INDEX ){
+			GLCall(glUniformBlockBinding( shader->rendererId, index, bindings[i] ));
+		}
+	}
+}
+
+ShaderUniform * findUniform( Shader * shader, const char* name ){
+
+	if ( shader->pending )
+		finishCompiling( shader );
+
+	unsigned int slot = hashUniformName( name );
+	int index;
+
+	while ( ( index = shader->uniformSlots[slot & ( shader->uniformSlotCount - 1 )] ) != -1 ){
+
+		if ( strcmp( shader->uniforms[index].name, name ) == 0 )
+			return &shader->uniforms[index];
+
+		slot++;
+	}
+
+	return NULL;
+}
+
+ShaderUniform * findUniform( Shader * shader, GLint location ){
+
+	if ( shader->pending )
+		finishCompiling( shader );
+
+	if ( location < 0 || location >= shader->uniformLocationCount )
+		return NULL;
+
+	int index = shader->uniformsByLocation[location];
+
+	return index == -1 ? NULL : &shader->uniforms[index];
+}
+
+void setUniform1i( Shader * shader, GLint location, GLint value ){
+
+	ShaderUniform * uniform = findUniform( shader, location );
+
+	if ( uniform != NULL ){
+
+		if ( uniform->hasValue && uniform->value.i[0] == value )
+			return;
+
+		uniform->value.i[0] = value;
+		uniform->hasValue = true;
+	}
+
+	bind( shader );
+	GLCall(glUniform1i( location, value ));
+}
+
+void setUniform4f( Shader * shader, GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3 ){
+
+	ShaderUniform * uniform = findUniform( shader, location );
+	GLfloat values[4] = { v0, v1, v2, v3 };
+
+	if ( uniform != NULL ){
+
+		if ( uniform->hasValue && memcmp( uniform->value.f, values, sizeof( values ) ) == 0 )
+			return;
+
+		memcpy( uniform->value.f, values, sizeof( values ) );
+		uniform->hasValue = true;
+	}
+
+	bind( shader );
+	GLCall(glUniform4f( location, v0, v1, v2, v3 ));
+}
+
+void setUniformMatrix4fv( Shader * shader, GLint location, mat4 matrix ){
+
+	ShaderUniform * uniform = findUniform( shader, location );
+
+	if ( uniform != NULL ){
+
+		if ( uniform->hasValue && memcmp( uniform->value.f, matrix, sizeof( mat4 ) ) == 0 )
+			return;
+
+		memcpy( uniform->value.f, matrix, sizeof( mat4 ) );
+		uniform->hasValue = true;
+	}
+
+	bind( shader );
+	GLCall(glUniformMatrix4fv(
+		location,
+		1, // We're only passing 1 matrix
+		GL_FALSE, // No need to transpose
+		(GLfloat *) matrix
+	));
+}
+
+GLint getUniformLocation( Shader * shader, char* name ){
+
+	ShaderUniform * uniform = findUniform( shader, name );
+
+	if ( uniform != NULL )
+		return uniform->location;
+
+	// Not in the table, but it could still be
+	// an element of an array, like "name[2]"
+	GLint location;
+	GLCall(location = glGetUniformLocation( shader->rendererId, name ));
+
+	if ( location == -1 )
+		printf( "Uniform %s has not been found.\n", name );
+
+	return location;
+}
+
+void bind( Shader * shader ){
+
+	if ( shader->pending )
+		finishCompiling( shader );
+
+	stateUseProgram( shader->rendererId );
+}
+
+void unbind( Shader * shader ){
+
+	stateUseProgram( 0 );
+}
+
+
+
+
+
+//
+// Shader variants
+//
+
+void init(
+	ShaderVariants * variants,
+	char* vertShaderFileName, char* fragShaderFileName,
+	const char* const* keywords, unsigned int keywordCount ){
+
+	variants->vertShaderFileName = vertShaderFileName;
+	variants->fragShaderFileName = fragShaderFileName;
+
+	if ( keywordCount > SHADER_MAX_KEYWORDS ){
+		printf( "Only %d shader keywords are supported\n", SHADER_MAX_KEYWORDS );
+		keywordCount = SHADER_MAX_KEYWORDS;
+	}
+
+	for ( unsigned int i = 0; i < keywordCount; i++ )
+		variants->keywords[i] = keywords[i];
+	variants->keywordCount = keywordCount;
+
+	variants->reservedVariants = 4;
+	variants->variantCount = 0;
+	variants->variants = (ShaderVariant*) malloc( variants->reservedVariants * sizeof( ShaderVariant ) );
+}
+
+uint32_t keywordBit( ShaderVariants * variants, const char* keyword ){
+
+	for ( unsigned int i = 0; i < variants->keywordCount; i++ )
+		if ( strcmp( variants->keywords[i], keyword ) == 0 )
+			return 1u << i;
+
+	printf( "Shader keyword %s has not been found.\n", keyword );
+
+	return 0;
+}
+
+Shader * getVariant( ShaderVariants * variants, uint32_t keywordMask ){
+
+	// Bits past the last keyword would make variants that only differ by name
+	uint32_t validMask = variants->keywordCount < 32 ?
+		( 1u << variants->keywordCount ) - 1 :
+		0xffffffffu;
+
+	if ( keywordMask & ~validMask ){
+		printf( "Shader keyword mask %x has bits with no keyword, they are ignored.\n", keywordMask );
+		keywordMask &= validMask;
+	}
+
+	for ( unsigned int i = 0; i < variants->variantCount; i++ )
+		if ( variants->variants[i].keywordMask == keywordMask )
+			return variants->variants[i].shader;
+
+
+	// First time, compile it
+
+	const char* defines[SHADER_MAX_KEYWORDS];
+	unsigned int defineCount = 0;
+
+	for ( unsigned int i = 0; i < variants->keywordCount; i++ )
+		if ( keywordMask & ( 1u << i ) )
+			defines[defineCount++] = variants->keywords[i];
+
+	Shader * shader = (Shader*) malloc( sizeof( Shader ) );
+	init( shader, variants->vertShaderFileName, variants->fragShaderFileName, defines, defineCount );
+
+	if ( variants->variantCount == variants->reservedVariants ){
+		variants->reservedVariants *= 2;
+		variants->variants = (ShaderVariant*) realloc(
+			variants->variants,
+			variants->reservedVariants * sizeof( ShaderVariant )
+		);
+	}
+
+	variants->variants[variants->variantCount].keywordMask = keywordMask;
+	variants->variants[variants->variantCount].shader = shader;
+	variants->variantCount++;
+
+	return shader;
+}
+
+
+void init( Renderer * renderer ){
+
+	renderer->reservedCommands = 16;
+	renderer->commandCount = 0;
+
+	renderer->commands = (DrawCommand*)
+		malloc( sizeof( DrawCommand ) * renderer->reservedCommands );
+	renderer->sortItems = (DrawSortItem*)
+		malloc( sizeof( DrawSortItem ) * renderer->reservedCommands * 2 );
+
+	renderer->batch = (DrawElementsIndirectCommand*)
+		malloc( sizeof( DrawElementsIndirectCommand ) * RENDERER_INDIRECT_COMMANDS );
+	renderer->batchCounts = (GLsizei*)
+		malloc( sizeof( GLsizei ) * RENDERER_INDIRECT_COMMANDS );
+	renderer->batchIndices = (void**)
+		malloc( sizeof( void* ) * RENDERER_INDIRECT_COMMANDS );
+	renderer->batchBaseVertices = (GLint*)
+		malloc( sizeof( GLint ) * RENDERER_INDIRECT_COMMANDS );
+
+	renderer->indirectBuffer = NULL;
+
+	if ( GLEW_ARB_multi_draw_indirect ){
+		renderer->indirectBuffer = (BufferRing*) malloc( sizeof( BufferRing ) );
+		init(
+			renderer->indirectBuffer,
+			GL_DRAW_INDIRECT_BUFFER,
+			sizeof( DrawElementsIndirectCommand ) * RENDERER_INDIRECT_COMMANDS,
+			STREAM_PERSISTENT
+		);
+	}
+
+	GLint uniformAlignment;
+	GLCall(glGetIntegerv( GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment ));
+
+	renderer->uniformBuffer = (BufferRing*) malloc( sizeof( BufferRing ) );
+	init(
+		renderer->uniformBuffer,
+		GL_UNIFORM_BUFFER,
+		RENDERER_UNIFORM_BUFFER_SIZE,
+		STREAM_PERSISTENT,
+		uniformAlignment
+	);
+	renderer->frameOffset = renderer->objectOffset = 0;
+	renderer->translucent = false;
+}
+
+static void writeFrameData( Renderer * renderer ){
+
+	void* data = beginWrite( renderer->uniformBuffer, sizeof( FrameData ), &renderer->frameOffset );
+
+	if ( data != NULL ){
+		memcpy( data, &renderer->frame, sizeof( FrameData ) );
+		endWrite( renderer->uniformBuffer );
+	}
+}
+
+void setFrameData( Renderer * renderer, FrameData * frame ){
+
+	renderer->frame = frame[0];
+	writeFrameData( renderer );
+
+	mat4 identity = GLM_MAT4_IDENTITY_INIT;
+	vec4 white = { 1, 1, 1, 1 };
+	setObjectData( renderer, identity, white );
+	setTranslucent( renderer, false );
+}
+
+void setTranslucent( Renderer * renderer, bool translucent ){
+
+	renderer->translucent = translucent;
+}
+
+void setObjectData( Renderer * renderer, mat4 model, vec4 color ){
+
+	// Built aside, as the buffer may not be as aligned as cglm wants
+	ObjectData object;
+	glm_mat4_copy( model, object.model );
+	glm_vec4_copy( color, object.color );
+
+	// Out of room: the queued draws keep their offsets in this region,
+	// and the flush moves the ring on to a region of its own
+	if ( !hasRoom( renderer->uniformBuffer, sizeof( ObjectData ) ) ){
+		printf(
+			"Uniform buffer full, flushing %u draws early. RENDERER_UNIFORM_BUFFER_SIZE may be too small.\n",
+			renderer->commandCount
+		);
+		flush( renderer );
+		writeFrameData( renderer );
+	}
+
+	void* data = beginWrite( renderer->uniformBuffer, sizeof( ObjectData ), &renderer->objectOffset );
+
+	if ( data != NULL ){
+		memcpy( data, &object, sizeof( ObjectData ) );
+		endWrite( renderer->uniformBuffer );
+	}
+}
+
+void draw(
+	Renderer * renderer,
+	VertexArray * vertexArray,
+	IndexBuffer * indexBuffer,
+	Shader * shader,
+	Texture * texture,
+	float depth ){
+
+	// Reserve more space
+
+	if ( renderer->commandCount == renderer->reservedCommands ){
+
+		renderer->reservedCommands *= 2;
+
+		renderer->commands = (DrawCommand*) realloc(
+			renderer->commands,
+			sizeof( DrawCommand ) * renderer->reservedCommands
+		);
+		renderer->sortItems = (DrawSortItem*) realloc(
+			renderer->sortItems,
+			sizeof( DrawSortItem ) * renderer->reservedCommands * 2
+		);
+	}
+
+
+	// Build the sort key out of the GL names,
+	// which are small numbers handed out in order
+
+	depth = depth < 0 ? 0 : depth > 1 ? 1 : depth;
+
+	uint64_t depthBits = (uint64_t) ( depth * ( ( 1 << SORT_KEY_DEPTH_BITS ) - 1 ) );
+	uint64_t key;
+
+	if ( renderer->translucent ){
+		key = 1;
+		key = ( key << SORT_KEY_DEPTH_BITS ) | ( ( ( 1 << SORT_KEY_DEPTH_BITS ) - 1 ) - depthBits );
+		key <<= 64 - SORT_KEY_LAYER_BITS - SORT_KEY_DEPTH_BITS;
+	}
+	else {
+		key =
+			(uint64_t) ( shader->rendererId & ( ( 1 << SORT_KEY_SHADER_BITS ) - 1 ) );
+		key = ( key << SORT_KEY_TEXTURE_BITS ) |
+			( texture == NULL ? 0 : texture->rendererId & ( ( 1 << SORT_KEY_TEXTURE_BITS ) - 1 ) );
+		key = ( key << SORT_KEY_VERTEX_ARRAY_BITS ) |
+			( vertexArray->rendererId & ( ( 1 << SORT_KEY_VERTEX_ARRAY_BITS ) - 1 ) );
+		key = ( key << SORT_KEY_DEPTH_BITS ) | depthBits;
+	}
+
+	renderer->commands[renderer->commandCount] = (DrawCommand) {
+		.key = key,
+		.vertexArray = vertexArray,
+		.indexBuffer = indexBuffer,
+		.shader = shader,
+		.texture = texture,
+		.instanceCount = 0,
+		.mesh = NULL,
+		.objectOffset = renderer->objectOffset
+	};
+	renderer->commandCount++;
+}
+
+void draw(
+	Renderer * renderer,
+	MeshArena * arena,
+	ArenaMesh * mesh,
+	Shader * shader,
+	Texture * texture,
+	float depth ){
+
+	draw( renderer, arena->vertexArray, arena->indexBuffer, shader, texture, depth );
+
+	renderer->commands[renderer->commandCount - 1].mesh = mesh;
+}
+
+void drawArrays(
+	Renderer * renderer,
+	VertexArray * vertexArray,
+	Shader * shader,
+	GLenum primitive,
+	GLint first,
+	GLsizei count,
+	Texture * texture,
+	float depth ){
+
+	draw( renderer, vertexArray, NULL, shader, texture, depth );
+
+	DrawCommand * command = &renderer->commands[renderer->commandCount - 1];
+	command->primitive = primitive;
+	command->first = first;
+	command->count = count;
+}
+
+void drawInstanced(
+	Renderer * renderer,
+	VertexArray * vertexArray,
+	IndexBuffer * indexBuffer,
+	Shader * shader,
+	unsigned int instanceCount,
+	Texture * texture,
+	float depth ){
+
+	draw( renderer, vertexArray, indexBuffer, shader, texture, depth );
+
+	renderer->commands[renderer->commandCount - 1].instanceCount = instanceCount;
+}
+
+// Least significant digit radix sort, one byte per pass.
+// Returns where the sorted items ended up
+static DrawSortItem * sortDrawCommands( Renderer * renderer ){
+
+	unsigned int count = renderer->commandCount;
+	DrawSortItem * items = renderer->sortItems;
+	DrawSortItem * sorted = renderer->sortItems + renderer->reservedCommands;
+
+	for ( int i = 0; i < count; i++ )
+		items[i] = (DrawSortItem) { renderer->commands[i].key, (unsigned int) i };
+
+	for ( int shift = 0; shift < 64; shift += 8 ){
+
+		unsigned int offsets[256] = {};
+
+		for ( int i = 0; i < count; i++ )
+			offsets[( items[i].key >> shift ) & 0xFF]++;
+
+		// Every key has the same byte here, nothing to do
+		if ( offsets[( items[0].key >> shift ) & 0xFF] == count )
+			continue;
+
+		for ( int i = 0, total = 0; i < 256; i++ ){
+			unsigned int bucketSize = offsets[i];
+			offsets[i] = total;
+			total += bucketSize;
+		}
+
+		for ( int i = 0; i < count; i++ )
+			sorted[offsets[( items[i].key >> shift ) & 0xFF]++] = items[i];
+
+		DrawSortItem * tmp = items;
+		items = sorted;
+		sorted = tmp;
+	}
+
+	return items;
+}
+
+// Issue the draws of arena meshes gathered in the batch
+static void flushBatch( Renderer * renderer, unsigned int batchSize ){
+
+	if ( renderer->indirectBuffer != NULL ){
+
+		unsigned int offset;
+		void* data = beginWrite(
+			renderer->indirectBuffer,
+			sizeof( DrawElementsIndirectCommand ) * batchSize,
+			&offset
+		);
+
+		if ( data != NULL ){
+
+			memcpy( data, renderer->batch, sizeof( DrawElementsIndirectCommand ) * batchSize );
+			endWrite( renderer->indirectBuffer );
+
+			stateBindBuffer( GL_DRAW_INDIRECT_BUFFER, renderer->indirectBuffer->rendererId );
+			GLCall(glMultiDrawElementsIndirect(
+				GL_TRIANGLES,
+				GL_UNSIGNED_INT,
+				(const void*) (uintptr_t) offset,
+				batchSize,
+				0 // tightly packed
+			));
+
+			return;
+		}
+	}
+
+	for ( int i = 0; i < batchSize; i++ ){
+		renderer->batchCounts[i] = renderer->batch[i].count;
+		renderer->batchIndices[i] = (void*) (uintptr_t) ( renderer->batch[i].firstIndex * sizeof( GLuint ) );
+		renderer->batchBaseVertices[i] = renderer->batch[i].baseVertex;
+	}
+
+	GLCall(glMultiDrawElementsBaseVertex(
+		GL_TRIANGLES,
+		renderer->batchCounts,
+		GL_UNSIGNED_INT,
+		(const void* const*) renderer->batchIndices,
+		batchSize,
+		renderer->batchBaseVertices
+	));
+}
+
+void flush( Renderer * renderer ){
+
+	if ( renderer->commandCount == 0 ){
+		nextFrame( renderer->uniformBuffer );
+		return;
+	}
+
+	DrawSortItem * items = sortDrawCommands( renderer );
+
+	GLuint uniformBufferId = renderer->uniformBuffer->rendererId;
+	stateBindBufferRange( GL_UNIFORM_BUFFER, UNIFORM_BLOCK_FRAME, uniformBufferId, renderer->frameOffset, sizeof( FrameData ) );
+
+	for ( int i = 0; i < renderer->commandCount; i++ ){
+
+		DrawCommand * command = &renderer->commands[items[i].command];
+
+		// Not drawn this frame rather than waiting for the driver
+		if ( !isReady( command->shader ) )
+			continue;
+
+		// The state cache drops binds of what is already bound
+		bind( command->shader );
+		stateBindBufferRange( GL_UNIFORM_BUFFER, UNIFORM_BLOCK_OBJECT, uniformBufferId, command->objectOffset, sizeof( ObjectData ) );
+		if ( command->texture != NULL )
+			bind( command->texture, 0 );
+		bind( command->vertexArray );
+		if ( command->indexBuffer != NULL )
+			bind( command->indexBuffer );
+
+		if ( command->indexBuffer == NULL ){
+			GLCall(glDrawArrays( command->primitive, command->first, command->count ));
+		}
+		else if ( command->mesh != NULL ){
+
+			// Merge with the following draws of the same arena,
+			// which the sort has put right after this one
+			unsigned int batchSize = 0;
+
+			while ( true ){
+
+				ArenaMesh * mesh = command->mesh;
+
+				renderer->batch[batchSize++] = (DrawElementsIndirectCommand) {
+					.count = mesh->indexCount,
+					.instanceCount = 1,
+					.firstIndex = mesh->firstIndex,
+					.baseVertex = (GLint) mesh->firstVertex,
+					.baseInstance = 0
+				};
+
+				if ( i + 1 == renderer->commandCount || batchSize == RENDERER_INDIRECT_COMMANDS )
+					break;
+
+				DrawCommand * next = &renderer->commands[items[i + 1].command];
+
+				if ( next->mesh == NULL ||
+					next->vertexArray != command->vertexArray ||
+					next->shader != command->shader ||
+					next->texture != command->texture ||
+					next->objectOffset != command->objectOffset )
+					break;
+
+				command = next;
+				i++;
+			}
+
+			flushBatch( renderer, batchSize );
+		}
+		else if ( command->instanceCount == 0 ){
+			GLCall(glDrawElements(
+				GL_TRIANGLES,
+				command->indexBuffer->count,
+				GL_UNSIGNED_INT,
+				NULL
+			));
+		}
+		else {
+			GLCall(glDrawElementsInstanced(
+				GL_TRIANGLES,
+				command->indexBuffer->count,
+				GL_UNSIGNED_INT,
+				NULL,
+				command->instanceCount
+			));
+		}
+	}
+
+	renderer->commandCount = 0;
+
+	if ( renderer->indirectBuffer != NULL )
+		nextFrame( renderer->indirectBuffer );
+	nextFrame( renderer->uniformBuffer );
+}
+
+
+
+
+
+//
+// Textures
+//
+
+// Levels down to 1x1
+static int mipmapLevels( int width, int height ){
+
+	int levels = 1;
+
+	while ( ( width > 1 || height > 1 ) && levels < TEXTURE_MAX_LEVELS ){
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+		levels++;
+	}
+
+	return levels;
+}
+
+static int levelSize( int size, int level ){
+
+	size >>= level;
+	return size > 0 ? size : 1;
+}
+
+// Half the size of an RGBA image, averaging blocks of 2x2 pixels.
+// The half size rounds down, so with odd sizes the last row
+// or column is left out. A side of a single pixel is used twice
+static void downsample( const unsigned char* source, int width, int height, unsigned char* destination ){
+
+	int halfWidth = levelSize( width, 1 );
+	int halfHeight = levelSize( height, 1 );
+
+	for ( int y = 0; y < halfHeight; y++ ){
+
+		const unsigned char* row0 = source + 2 * y * width * 4;
+		const unsigned char* row1 = source + ( 2 * y + 1 < height ? 2 * y + 1 : height - 1 ) * width * 4;
+		unsigned char* out = destination + y * halfWidth * 4;
+
+		int x = 0;
+
+#ifdef __SSE2__
+		// Four pixels at a time, from eight of each row
+		__m128i zero = _mm_setzero_si128();
+		__m128i two = _mm_set1_epi16( 2 );
+
+		for ( ; x + 4 <= halfWidth; x += 4 ){
+
+			__m128i a0 = _mm_loadu_si128( (const __m128i*) ( row0 + x * 8 ) );
+			__m128i a1 = _mm_loadu_si128( (const __m128i*) ( row0 + x * 8 + 16 ) );
+			__m128i b0 = _mm_loadu_si128( (const __m128i*) ( row1 + x * 8 ) );
+			__m128i b1 = _mm_loadu_si128( (const __m128i*) ( row1 + x * 8 + 16 ) );
+
+			// Vertical sums, two pixels per register
+			__m128i s01 = _mm_add_epi16( _mm_unpacklo_epi8( a0, zero ), _mm_unpacklo_epi8( b0, zero ) );
+			__m128i s23 = _mm_add_epi16( _mm_unpackhi_epi8( a0, zero ), _mm_unpackhi_epi8( b0, zero ) );
+			__m128i s45 = _mm_add_epi16( _mm_unpacklo_epi8( a1, zero ), _mm_unpacklo_epi8( b1, zero ) );
+			__m128i s67 = _mm_add_epi16( _mm_unpackhi_epi8( a1, zero ), _mm_unpackhi_epi8( b1, zero ) );
+
+			// Horizontal sums, adding each pixel to its neighbour
+			__m128i h0 = _mm_add_epi16( _mm_unpacklo_epi64( s01, s23 ), _mm_unpackhi_epi64( s01, s23 ) );
+			__m128i h1 = _mm_add_epi16( _mm_unpacklo_epi64( s45, s67 ), _mm_unpackhi_epi64( s45, s67 ) );
+
+			// Rounded average
+			h0 = _mm_srli_epi16( _mm_add_epi16( h0, two ), 2 );
+			h1 = _mm_srli_epi16( _mm_add_epi16( h1, two ), 2 );
+
+			_mm_storeu_si128( (__m128i*) ( out + x * 4 ), _mm_packus_epi16( h0, h1 ) );
+		}
+#endif
+
+		for ( ; x < halfWidth; x++ ){
+
+			int x0 = 2 * x * 4;
+			int x1 = ( 2 * x + 1 < width ? 2 * x + 1 : width - 1 ) * 4;
+
+			for ( int c = 0; c < 4; c++ )
+				out[x * 4 + c] = ( row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2 ) >> 2;
+		}
+	}
+}
+
+// Fill levels[1..] from levels[0], allocating them.
+// Returns how many levels there are
+static int buildMipmaps( unsigned char* levels[TEXTURE_MAX_LEVELS], int width, int height ){
+
+	int levelCount = mipmapLevels( width, height );
+
+	for ( int level = 1; level < levelCount; level++ ){
+
+		int levelWidth = levelSize( width, level - 1 );
+		int levelHeight = levelSize( height, level - 1 );
+
+		levels[level] = (unsigned char*) malloc( levelSize( width, level ) * levelSize( height, level ) * 4 );
+		downsample( levels[level - 1], levelWidth, levelHeight, levels[level] );
+	}
+
+	return levelCount;
+}
+
+// Filtering for the bound texture
+static void applyOptions( GLenum target, TextureOptions options, int levels ){
+
+	GLenum minFilter = GL_LINEAR;
+
+	if ( levels > 1 )
+		minFilter = options.trilinear ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_NEAREST;
+
+	GLCall(glTexParameteri( target, GL_TEXTURE_MIN_FILTER, minFilter ));
+	GLCall(glTexParameteri( target, GL_TEXTURE_MAG_FILTER, GL_LINEAR ));
+	GLCall(glTexParameteri( target, GL_TEXTURE_MAX_LEVEL, levels - 1 ));
+
+	if ( GLEW_EXT_texture_filter_anisotropic ){
+
+		static GLfloat maxAnisotropy = 0;
+		if ( maxAnisotropy == 0 ){
+			GLCall(glGetFloatv( GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy ));
+		}
+
+		GLfloat anisotropy = options.anisotropy;
+		if ( anisotropy < 1 )
+			anisotropy = 1;
+		if ( anisotropy > maxAnisotropy )
+			anisotropy = maxAnisotropy;
+
+		GLCall(glTexParameterf( target, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy ));
+	}
+}
+
+// New RGBA texture with storage for every level.
+// pixels, if any, go to the first one
+static GLuint createTexture( int width, int height, const unsigned char* pixels, int levels = 1, TextureOptions options = defaultTextureOptions ){
+
+	GLuint rendererId;
+
+	GLCall(glGenTextures( 1, &rendererId ));
+	stateBindTexture( GL_TEXTURE_2D, rendererId );
+
+	applyOptions( GL_TEXTURE_2D, options, levels );
+	GLCall(glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE ));
+	GLCall(glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE ));
+
+	for ( int level = 0; level < levels; level++ ){
+		GLCall(glTexImage2D(
+			GL_TEXTURE_2D,
+			level,
+			GL_RGBA8,
+			levelSize( width, level ),
+			levelSize( height, level ),
+			0,
+			GL_RGBA,
+			GL_UNSIGNED_BYTE,
+			level == 0 ? pixels : NULL
+		));
+	}
+
+	stateBindTexture( GL_TEXTURE_2D, 0 );
+
+	return rendererId;
+}
+
+//
+// Cooked textures
+//
+
+typedef struct {
+	char identifier[12];
+	uint32_t endianness;
+	uint32_t glType;
+	uint32_t glTypeSize;
+	uint32_t glFormat;
+	uint32_t glInternalFormat;
+	uint32_t glBaseInternalFormat;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t numberOfArrayElements;
+	uint32_t numberOfFaces;
+	uint32_t numberOfMipmapLevels;
+	uint32_t bytesOfKeyValueData;
+} KtxHeader;
+
+bool parseKtx( const unsigned char* file, long size, CompressedImage * image ){
+
+	static const char identifier[12] = {
+		(char) 0xAB, 'K', 'T', 'X', ' ', '1', '1', (char) 0xBB, '\r', '\n', 0x1A, '\n'
+	};
+
+	if ( size < (long) sizeof( KtxHeader ) )
+		return false;
+
+	KtxHeader header;
+	memcpy( &header, file, sizeof( header ) );
+
+	// Written on a machine of the same endianness, compressed, 2D, one face
+	if ( memcmp( header.identifier, identifier, sizeof( identifier ) ) != 0 ||
+		header.endianness != 0x04030201 ||
+		header.glType != 0 ||
+		header.pixelDepth != 0 ||
+		header.numberOfArrayElements != 0 ||
+		header.numberOfFaces != 1 )
+		return false;
+
+	// Checked before they become ints, as the file may be corrupt
+	if ( header.pixelWidth == 0 || header.pixelWidth > TEXTURE_MAX_SIZE ||
+		header.pixelHeight == 0 || header.pixelHeight > TEXTURE_MAX_SIZE )
+		return false;
+
+	image->format = header.glInternalFormat;
+	image->width = header.pixelWidth;
+	image->height = header.pixelHeight;
+
+	// No more levels than it takes to get down to 1x1
+	if ( header.numberOfMipmapLevels > (uint32_t) mipmapLevels( image->width, image->height ) )
+		return false;
+
+	image->levelCount = header.numberOfMipmapLevels > 0 ? header.numberOfMipmapLevels : 1;
+
+	if ( header.bytesOfKeyValueData > size - sizeof( header ) )
+		return false;
+
+	long offset = sizeof( header ) + header.bytesOfKeyValueData;
+
+	// Sizes are compared with what is left of the file,
+	// so that adding them can't overflow
+	for ( int level = 0; level < image->levelCount; level++ ){
+
+		uint32_t levelSize;
+
+		if ( size - offset < (long) sizeof( levelSize ) )
+			return false;
+
+		memcpy( &levelSize, file + offset, sizeof( levelSize ) );
+		offset += sizeof( levelSize );
+
+		if ( levelSize > (unsigned long) ( size - offset ) )
+			return false;
+
+		image->levels[level] = file + offset;
+		image->levelSizes[level] = levelSize;
+
+		// Padded to 4 bytes
+		offset += ( levelSize + 3 ) & ~3;
+	}
+
+	return true;
+}
+
+bool compressedFormatSupported( GLenum format ){
+
+	switch ( format ){
+
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			return GLEW_EXT_texture_compression_s3tc;
+
+		case GL_COMPRESSED_RGBA_BPTC_UNORM_ARB:
+			return GLEW_ARB_texture_compression_bptc || GLEW_VERSION_4_2;
+	}
+
+	return false;
+}
+
+// Texture with the levels of the image, but nothing in them yet.
+// Without mipmaps only the first one is used
+static GLuint createCompressedTexture( const CompressedImage * image, TextureOptions options, int * levels ){
+
+	GLuint rendererId;
+
+	*levels = options.mipmaps == MIPMAPS_NONE ? 1 : image->levelCount;
+
+	GLCall(glGenTextures( 1, &rendererId ));
+	stateBindTexture( GL_TEXTURE_2D, rendererId );
+
+	applyOptions( GL_TEXTURE_2D, options, *levels );
+	GLCall(glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE ));
+	GLCall(glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE ));
+
+	return rendererId;
+}
+
+static void uploadCompressedLevel( GLuint rendererId, const CompressedImage * image, int level ){
+
+	stateBindTexture( GL_TEXTURE_2D, rendererId );
+
+	GLCall(glCompressedTexImage2D(
+		GL_TEXTURE_2D,
+		level,
+		image->format,
+		levelSize( image->width, level ),
+		levelSize( image->height, level ),
+		0,
+		image->levelSizes[level],
+		image->levels[level]
+	));
+}
+
+// From the contents of a file, which may be NULL if it couldn't be read
+static void init( Texture * texture, const unsigned char* file, long size, const char* filePath, TextureOptions options ){
+
+	texture->target = GL_TEXTURE_2D;
+	texture->options = options;
+	texture->levels = 1;
+	texture->format = GL_RGBA8;
+
+
+	// Cooked, straight to OpenGL
+
+	CompressedImage compressed;
+
+	if ( file && parseKtx( file, size, &compressed ) ){
+
+		if ( compressedFormatSupported( compressed.format ) ){
+
+			texture->rendererId = createCompressedTexture( &compressed, options, &texture->levels );
+
+			for ( int level = 0; level < texture->levels; level++ )
+				uploadCompressedLevel( texture->rendererId, &compressed, level );
+
+			texture->width = compressed.width;
+			texture->height = compressed.height;
+			texture->bpp = 4;
+			texture->format = compressed.format;
+		}
+		else{
+			printf( "Texture format of %s not supported\n", filePath );
+			texture->rendererId = createTexture( 1, 1, NULL );
+			texture->width = texture->height = 1;
+		}
+
+		texture->loaded = true;
+		return;
+	}
+
+
+	// Flipped on load, bottom row first
+	unsigned char* levels[TEXTURE_MAX_LEVELS];
+
+	levels[0] = NULL;
+
+	if ( file ){
+		levels[0] = stbi_load_from_memory(
+			file, size,
+			&texture->width,
+			&texture->height,
+			&texture->bpp,
+			// We want four channels for our picture (RGBA)
+			4
+		);
+	}
+
+	if ( levels[0] == NULL ){
+		printf( "Could not load texture %s\n", filePath );
+		texture->width = texture->height = 1;
+	}
+
+	if ( levels[0] && options.mipmaps != MIPMAPS_NONE )
+		texture->levels = mipmapLevels( texture->width, texture->height );
+
+	texture->rendererId = createTexture( texture->width, texture->height, levels[0], texture->levels, options );
+	texture->loaded = true;
+
+	if ( levels[0] && options.mipmaps == MIPMAPS_CPU ){
+
+		buildMipmaps( levels, texture->width, texture->height );
+
+		stateBindTexture( GL_TEXTURE_2D, texture->rendererId );
+
+		for ( int level = 1; level < texture->levels; level++ ){
+			GLCall(glTexSubImage2D(
+				GL_TEXTURE_2D,
+				level,
+				0, 0,
+				levelSize( texture->width, level ),
+				levelSize( texture->height, level ),
+				GL_RGBA,
+				GL_UNSIGNED_BYTE,
+				levels[level]
+			));
+			free( levels[level] );
+		}
+	}
+	else if ( texture->levels > 1 ){
+
+		stateBindTexture( GL_TEXTURE_2D, texture->rendererId );
+		GLCall(glGenerateMipmap( GL_TEXTURE_2D ));
+	}
+
+	// Free the image once it's already been loaded to OpenGL
+	if ( levels[0] )
+		stbi_image_free( levels[0] );
+}
+
+void init( Texture * texture, const char* filePath, TextureOptions options ){
+
+	FileView file;
+
+	if ( mapFile( &file, filePath ) ){
+		init( texture, file.data, file.size, filePath, options );
+		unmapFile( &file );
+	}
+	else
+		init( texture, NULL, 0, filePath, options );
+}
+
+void setOptions( Texture * texture, TextureOptions options ){
+
+	// Levels can't be added after the fact
+	texture->options.trilinear = options.trilinear;
+	texture->options.anisotropy = options.anisotropy;
+
+	// Still loading, picked up once it's done
+	if ( !texture->loaded )
+		return;
+
+	stateBindTexture( texture->target, texture->rendererId );
+	applyOptions( texture->target, texture->options, texture->levels );
+}
+
+void bind( Texture * texture, GLuint slot ){
+
+	stateBindTexture( slot, texture->target, texture->rendererId );
+}
+
+void unbind( Texture * texture ){
+
+	stateBindTexture( texture->target, 0 );
+}
+
+
+
+
+
+//
+// Pixel buffers
+//
+
+void init( PixelBufferPool * pool, unsigned int bufferSize ){
+
+	pool->size = bufferSize;
+	pool->next = 0;
+
+	GLCall(glGenBuffers( PIXEL_BUFFER_COUNT, pool->rendererIds ));
+
+	for ( int i = 0; i < PIXEL_BUFFER_COUNT; i++ ){
+		stateBindBuffer( GL_PIXEL_UNPACK_BUFFER, pool->rendererIds[i] );
+		GLCall(glBufferData( GL_PIXEL_UNPACK_BUFFER, bufferSize, NULL, GL_STREAM_DRAW ));
+		pool->fences[i] = 0;
+	}
+
+	// Uploads from client memory need it unbound
+	stateBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+}
+
+int uploadRows(
+	PixelBufferPool * pool,
+	GLuint textureId,
+	int level,
+	int x, int y,
+	int width, int height,
+	const unsigned char* pixels,
+	bool wait ){
+
+	unsigned int rowSize = width * 4;
+
+	// Not even one row fits in a buffer
+	if ( rowSize > pool->size ){
+
+		stateBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+		stateBindTexture( GL_TEXTURE_2D, textureId );
+		GLCall(glTexSubImage2D(
+			GL_TEXTURE_2D,
+			level,
+			x, y,
+			width, height,
+			GL_RGBA,
+			GL_UNSIGNED_BYTE,
+			pixels
+		));
+
+		return height;
+	}
+
+	unsigned int index = pool->next;
+	GLsync fence = pool->fences[index];
+
+
+	// Make sure the GPU is done reading the buffer
+
+	if ( fence != 0 ){
+
+		GLenum result;
+		GLCall(result = glClientWaitSync( fence, 0, 0 ));
+
+		if ( result == GL_TIMEOUT_EXPIRED ){
+
+			if ( !wait )
+				return 0;
+
+			while ( result == GL_TIMEOUT_EXPIRED ){
+				GLCall(result = glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000 ));
+			}
+		}
+
+		GLCall(glDeleteSync( fence ));
+		pool->fences[index] = 0;
+	}
+
+
+	// As many rows as fit, at least one as checked above
+
+	int rows = pool->size / rowSize;
+
+	if ( rows > height )
+		rows = height;
+
+
+	// Copy them into the buffer.
+	// Invalidating it spares the driver from keeping the old contents
+
+	void* data;
+
+	stateBindBuffer( GL_PIXEL_UNPACK_BUFFER, pool->rendererIds[index] );
+	GLCall(data = glMapBufferRange(
+		GL_PIXEL_UNPACK_BUFFER,
+		0,
+		rows * rowSize,
+		GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+	));
+
+	memcpy( data, pixels, rows * rowSize );
+
+	GLCall(glUnmapBuffer( GL_PIXEL_UNPACK_BUFFER ));
+
+
+	// And start the transfer, reading from the buffer
+
+	stateBindTexture( GL_TEXTURE_2D, textureId );
+	GLCall(glTexSubImage2D(
+		GL_TEXTURE_2D,
+		level,
+		x, y,
+		width, rows,
+		GL_RGBA,
+		GL_UNSIGNED_BYTE,
+		NULL // offset into the pixel buffer
+	));
+
+	GLCall(pool->fences[index] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 ));
+	pool->next = ( index + 1 ) % PIXEL_BUFFER_COUNT;
+
+	// Uploads from client memory need it unbound
+	stateBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+
+	return rows;
+}
+
+void update( Texture * texture, PixelBufferPool * pool, int x, int y, int width, int height, const unsigned char* pixels ){
+
+	for ( int row = 0; row < height; ){
+		row += uploadRows(
+			pool,
+			texture->rendererId,
+			0,
+			x, y + row,
+			width, height - row,
+			pixels + row * width * 4,
+			true
+		);
+	}
+}
+
+
+
+
+
+//
+// Texture loader
+//
+
+static void* textureLoaderWorker( void* argument ){
+
+	TextureLoader * loader = (TextureLoader*) argument;
+
+	while ( true ){
+
+		// Wait for a job
+
+		pthread_mutex_lock( &loader->mutex );
+
+		while ( loader->pendingJobs == NULL && !loader->stopping )
+			pthread_cond_wait( &loader->jobAvailable, &loader->mutex );
+
+		if ( loader->pendingJobs == NULL ){
+			pthread_mutex_unlock( &loader->mutex );
+			return NULL;
+		}
+
+		TextureLoadJob * job = loader->pendingJobs;
+		loader->pendingJobs = job->next;
+		if ( loader->pendingJobs == NULL )
+			loader->lastPendingJob = NULL;
+
+		pthread_mutex_unlock( &loader->mutex );
+
+
+		// Decode it
+
+		FileView file;
+		bool read = mapFile( &file, job->filePath );
+
+		job->pixels = NULL;
+		job->file.data = NULL;
+		job->compressed.levelCount = 0;
+
+		if ( read && parseKtx( file.data, file.size, &job->compressed ) ){
+
+			// Cooked, nothing to decode
+			job->file = file;
+		}
+		else if ( read ){
+
+			job->compressed.levelCount = 0;
+			job->pixels = stbi_load_from_memory(
+				file.data, file.size,
+				&job->width, &job->height, &job->bpp,
+				4 // RGBA
+			);
+			unmapFile( &file );
+		}
+
+		if ( job->pixels == NULL && job->file.data == NULL )
+			printf( "Could not load texture %s\n", job->filePath );
+
+		job->levelPixels[0] = job->pixels;
+		job->levelCount = 1;
+
+		if ( job->pixels != NULL ){
+			if ( job->texture->options.mipmaps == MIPMAPS_CPU )
+				job->levelCount = buildMipmaps( job->levelPixels, job->width, job->height );
+			else if ( job->texture->options.mipmaps == MIPMAPS_GPU )
+				job->levelCount = mipmapLevels( job->width, job->height );
+		}
+
+
+		// Hand it to the GL thread
+
+		job->next = __atomic_load_n( &loader->decodedJobs, __ATOMIC_RELAXED );
+		while ( !__atomic_compare_exchange_n(
+			&loader->decodedJobs, &job->next, job,
+			true, __ATOMIC_RELEASE, __ATOMIC_RELAXED ) );
+	}
+}
+
+void init( TextureLoader * loader, double budgetMilliseconds ){
+
+	loader->pendingJobs = loader->lastPendingJob = NULL;
+	loader->decodedJobs = loader->uploadJobs = NULL;
+	loader->stopping = false;
+	loader->budgetMilliseconds = budgetMilliseconds;
+
+	// White, so that it doesn't tint anything
+	unsigned char white[] = { 255, 255, 255, 255 };
+	loader->placeholderId = createTexture( 1, 1, white );
+
+	// 4 MB each, a 1024x1024 image per buffer
+	loader->pixelBuffers = (PixelBufferPool*) malloc( sizeof( PixelBufferPool ) );
+	init( loader->pixelBuffers, 4 * 1024 * 1024 );
+
+	pthread_mutex_init( &loader->mutex, NULL );
+	pthread_cond_init( &loader->jobAvailable, NULL );
+
+	// Leave a core for the GL thread
+	long cores = sysconf( _SC_NPROCESSORS_ONLN );
+	loader->threadCount =
+		cores <= 2 ? 1 :
+		cores - 1 > TEXTURE_LOADER_MAX_THREADS ? TEXTURE_LOADER_MAX_THREADS :
+		cores - 1;
+
+	for ( int i = 0; i < loader->threadCount; i++ )
+		pthread_create( &loader->threads[i], NULL, textureLoaderWorker, loader );
+}
+
+void init( Texture * texture, const char* filePath, TextureLoader * loader, TextureOptions options ){
+
+	texture->rendererId = loader->placeholderId;
+	texture->target = GL_TEXTURE_2D;
+	texture->width = texture->height = 1;
+	texture->bpp = 4;
+	texture->levels = 1;
+	texture->format = GL_RGBA8;
+	texture->options = options;
+	texture->loaded = false;
+
+	TextureLoadJob * job = (TextureLoadJob*) malloc( sizeof( TextureLoadJob ) );
+	job->texture = texture;
+	job->filePath = strdup( filePath );
+	job->rendererId = 0;
+	job->uploadedLevel = 0;
+	job->uploadedRows = 0;
+	job->next = NULL;
+
+	pthread_mutex_lock( &loader->mutex );
+
+	if ( loader->lastPendingJob != NULL )
+		loader->lastPendingJob->next = job;
+	else
+		loader->pendingJobs = job;
+	loader->lastPendingJob = job;
+
+	pthread_cond_signal( &loader->jobAvailable );
+	pthread_mutex_unlock( &loader->mutex );
+}
+
+void processUploads( TextureLoader * loader ){
+
+	// Take everything decoded so far.
+	// It comes newest first, so reverse it
+
+	TextureLoadJob * decoded = __atomic_exchange_n( &loader->decodedJobs, NULL, __ATOMIC_ACQUIRE );
+	TextureLoadJob * reversed = NULL;
+
+	while ( decoded != NULL ){
+		TextureLoadJob * next = decoded->next;
+		decoded->next = reversed;
+		reversed = decoded;
+		decoded = next;
+	}
+
+	// And queue it after what is still waiting from other frames
+
+	TextureLoadJob ** tail = &loader->uploadJobs;
+	while ( *tail != NULL )
+		tail = &( *tail )->next;
+	*tail = reversed;
+
+
+	// Upload, at least one group of rows per frame
+	// so that loading always advances
+
+	double start = glfwGetTime();
+
+	while ( loader->uploadJobs != NULL ){
+
+		TextureLoadJob * job = loader->uploadJobs;
+
+		if ( job->file.data != NULL ){
+
+			// Cooked, a level at a time straight from the file
+
+			Texture * texture = job->texture;
+			bool supported = compressedFormatSupported( job->compressed.format );
+
+			if ( supported ){
+
+				if ( job->rendererId == 0 )
+					job->rendererId = createCompressedTexture( &job->compressed, texture->options, &job->levelCount );
+
+				uploadCompressedLevel( job->rendererId, &job->compressed, job->uploadedLevel );
+				job->uploadedLevel++;
+			}
+			else
+				printf( "Texture format of %s not supported\n", job->filePath );
+
+			if ( !supported || job->uploadedLevel == job->levelCount ){
+
+				if ( supported ){
+
+					texture->rendererId = job->rendererId;
+					texture->width = job->compressed.width;
+					texture->height = job->compressed.height;
+					texture->bpp = 4;
+					texture->levels = job->levelCount;
+					texture->format = job->compressed.format;
+					texture->loaded = true;
+
+					// In case setOptions() was called while loading
+					setOptions( texture, texture->options );
+				}
+
+				loader->uploadJobs = job->next;
+				unmapFile( &job->file );
+				free( job->filePath );
+				free( job );
+			}
+		}
+		else{
+
+			if ( job->pixels != NULL ){
+
+				Texture * texture = job->texture;
+
+				// Storage for the whole texture, filled in the following frames
+				if ( job->rendererId == 0 )
+					job->rendererId = createTexture( job->width, job->height, NULL, job->levelCount, texture->options );
+
+				// Only the first level unless they were built on the CPU
+				int level = job->uploadedLevel;
+				int width = levelSize( job->width, level );
+				int height = levelSize( job->height, level );
+
+				int rows = uploadRows(
+					loader->pixelBuffers,
+					job->rendererId,
+					level,
+					0, job->uploadedRows,
+					width, height - job->uploadedRows,
+					job->levelPixels[level] + job->uploadedRows * width * 4,
+					false
+				);
+
+				// Every pixel buffer still in use, try next frame
+				if ( rows == 0 )
+					break;
+
+				job->uploadedRows += rows;
+
+				if ( job->uploadedRows == height && texture->options.mipmaps == MIPMAPS_CPU && level + 1 < job->levelCount ){
+					job->uploadedLevel++;
+					job->uploadedRows = 0;
+				}
+			}
+
+			if ( job->pixels == NULL || job->uploadedRows == levelSize( job->height, job->uploadedLevel ) ){
+
+				if ( job->pixels != NULL ){
+
+					Texture * texture = job->texture;
+
+					if ( texture->options.mipmaps == MIPMAPS_GPU && job->levelCount > 1 ){
+						stateBindTexture( GL_TEXTURE_2D, job->rendererId );
+						GLCall(glGenerateMipmap( GL_TEXTURE_2D ));
+					}
+
+					texture->rendererId = job->rendererId;
+					texture->width = job->width;
+					texture->height = job->height;
+					texture->bpp = job->bpp;
+					texture->levels = job->levelCount;
+					texture->loaded = true;
+
+					// In case setOptions() was called while loading
+					setOptions( texture, texture->options );
+
+					stbi_image_free( job->pixels );
+
+					if ( texture->options.mipmaps == MIPMAPS_CPU )
+						for ( int level = 1; level < job->levelCount; level++ )
+							free( job->levelPixels[level] );
+				}
+
+				loader->uploadJobs = job->next;
+				free( job->filePath );
+				free( job );
+			}
+		}
+
+		if ( ( glfwGetTime() - start ) * 1000 >= loader->budgetMilliseconds )
+			break;
+	}
+}
+
+void stop( TextureLoader * loader ){
+
+	pthread_mutex_lock( &loader->mutex );
+	loader->stopping = true;
+	pthread_cond_broadcast( &loader->jobAvailable );
+	pthread_mutex_unlock( &loader->mutex );
+
+	for ( int i = 0; i < loader->threadCount; i++ )
+		pthread_join( loader->threads[i], NULL );
+}
+
+
+
+
+
+//
+// Texture atlas
+//
+
+static void init( Skyline * skyline, int width ){
+
+	skyline->reservedNodes = 16;
+	skyline->nodes = (SkylineNode*) malloc( skyline->reservedNodes * sizeof( SkylineNode ) );
+
+	// Flat and empty
+	skyline->nodes[0].x = 0;
+	skyline->nodes[0].y = 0;
+	skyline->nodes[0].width = width;
+	skyline->nodeCount = 1;
+}
+
+// Height at which a rectangle starting at a node would sit,
+// resting on the highest node it spans. -1 if it doesn't fit
+static int fit( Skyline * skyline, unsigned int index, int width, int height, int maxWidth, int maxHeight ){
+
+	SkylineNode * nodes = skyline->nodes;
+
+	if ( nodes[index].x + width > maxWidth )
+		return -1;
+
+	int y = 0;
+	int remaining = width;
+
+	for ( unsigned int i = index; remaining > 0; i++ ){
+
+		if ( nodes[i].y > y )
+			y = nodes[i].y;
+
+		remaining -= nodes[i].width;
+	}
+
+	if ( y + height > maxHeight )
+		return -1;
+
+	return y;
+}
+
+// Place a rectangle where its top ends lowest,
+// on the narrowest segment if there is a tie.
+// False if it doesn't fit anywhere
+static bool place( Skyline * skyline, int width, int height, int maxWidth, int maxHeight, int * x, int * y ){
+
+	int bestIndex = -1;
+	int bestTop = maxHeight + 1;
+	int bestWidth = maxWidth + 1;
+
+	for ( unsigned int i = 0; i < skyline->nodeCount; i++ ){
+
+		int nodeY = fit( skyline, i, width, height, maxWidth, maxHeight );
+
+		if ( nodeY < 0 )
+			continue;
+
+		if ( nodeY + height < bestTop ||
+			( nodeY + height == bestTop && skyline->nodes[i].width < bestWidth ) ){
+
+			bestIndex = i;
+			bestTop = nodeY + height;
+			bestWidth = skyline->nodes[i].width;
+			*y = nodeY;
+		}
+	}
+
+	if ( bestIndex < 0 )
+		return false;
+
+	*x = skyline->nodes[bestIndex].x;
+
+
+	// New segment on top of the rectangle
+
+	if ( skyline->nodeCount == skyline->reservedNodes ){
+		skyline->reservedNodes *= 2;
+		skyline->nodes = (SkylineNode*) realloc( skyline->nodes, skyline->reservedNodes * sizeof( SkylineNode ) );
+	}
+
+	SkylineNode * nodes = skyline->nodes;
+
+	memmove( &nodes[bestIndex + 1], &nodes[bestIndex], ( skyline->nodeCount - bestIndex ) * sizeof( SkylineNode ) );
+	skyline->nodeCount++;
+
+	nodes[bestIndex].x = *x;
+	nodes[bestIndex].y = bestTop;
+	nodes[bestIndex].width = width;
+
+
+	// Shrink or remove the segments now under it
+
+	unsigned int i = bestIndex + 1;
+
+	while ( i < skyline->nodeCount ){
+
+		int covered = nodes[bestIndex].x + nodes[bestIndex].width - nodes[i].x;
+
+		if ( covered <= 0 )
+			break;
+
+		if ( covered < nodes[i].width ){
+			nodes[i].x += covered;
+			nodes[i].width -= covered;
+			break;
+		}
+
+		memmove( &nodes[i], &nodes[i + 1], ( skyline->nodeCount - i - 1 ) * sizeof( SkylineNode ) );
+		skyline->nodeCount--;
+	}
+
+
+	// And join neighbours at the same height
+
+	for ( i = 0; i + 1 < skyline->nodeCount; ){
+
+		if ( nodes[i].y == nodes[i + 1].y ){
+			nodes[i].width += nodes[i + 1].width;
+			memmove( &nodes[i + 1], &nodes[i + 2], ( skyline->nodeCount - i - 2 ) * sizeof( SkylineNode ) );
+			skyline->nodeCount--;
+		}
+		else
+			i++;
+	}
+
+	return true;
+}
+
+void init( TextureAtlas * atlas, int width, int height, GLenum target, int layerCount ){
+
+	Texture * texture = &atlas->texture;
+
+	texture->target = target;
+	texture->width = width;
+	texture->height = height;
+	texture->bpp = 4;
+	texture->levels = 1;
+	texture->format = GL_RGBA8;
+	texture->options.mipmaps = MIPMAPS_NONE;
+	texture->options.trilinear = false;
+	texture->options.anisotropy = 1;
+	texture->loaded = true;
+
+	atlas->layerCount = target == GL_TEXTURE_2D_ARRAY ? layerCount : 1;
+	atlas->padding = 1;
+
+	atlas->layers = (Skyline*) malloc( atlas->layerCount * sizeof( Skyline ) );
+	for ( int i = 0; i < atlas->layerCount; i++ )
+		init( &atlas->layers[i], width );
+
+
+	// Cleared, so that the padding is transparent
+
+	unsigned char* clear = (unsigned char*) calloc( width * height * atlas->layerCount, 4 );
+
+	GLCall(glGenTextures( 1, &texture->rendererId ));
+	stateBindTexture( target, texture->rendererId );
+
+	applyOptions( target, texture->options, 1 );
+	GLCall(glTexParameteri( target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE ));
+	GLCall(glTexParameteri( target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE ));
+
+	if ( target == GL_TEXTURE_2D_ARRAY ){
+		GLCall(glTexImage3D(
+			GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8,
+			width, height, atlas->layerCount,
+			0, GL_RGBA, GL_UNSIGNED_BYTE, clear
+		));
+	}
+	else{
+		GLCall(glTexImage2D(
+			GL_TEXTURE_2D, 0, GL_RGBA8,
+			width, height,
+			0, GL_RGBA, GL_UNSIGNED_BYTE, clear
+		));
+	}
+
+	free( clear );
+}
+
+bool reserve( TextureAtlas * atlas, int width, int height, AtlasRegion * region ){
+
+	Texture * texture = &atlas->texture;
+	int padding = atlas->padding;
+
+	// Padding on every side, shared between neighbours
+	int paddedWidth = width + padding;
+	int paddedHeight = height + padding;
+	int maxWidth = texture->width - padding;
+	int maxHeight = texture->height - padding;
+
+	int x, y;
+	int layer = 0;
+
+	while ( layer < atlas->layerCount &&
+		!place( &atlas->layers[layer], paddedWidth, paddedHeight, maxWidth, maxHeight, &x, &y ) )
+		layer++;
+
+	if ( layer == atlas->layerCount )
+		return false;
+
+	x += padding;
+	y += padding;
+
+	region->layer = layer;
+	region->x = x;
+	region->y = y;
+	region->width = width;
+	region->height = height;
+	region->u0 = ( x + 0.5f ) / texture->width;
+	region->v0 = ( y + 0.5f ) / texture->height;
+	region->u1 = ( x + width - 0.5f ) / texture->width;
+	region->v1 = ( y + height - 0.5f ) / texture->height;
+
+	return true;
+}
+
+static void upload( TextureAtlas * atlas, AtlasRegion * region, const unsigned char* pixels ){
+
+	Texture * texture = &atlas->texture;
+
+	stateBindTexture( texture->target, texture->rendererId );
+
+	if ( texture->target == GL_TEXTURE_2D_ARRAY ){
+		GLCall(glTexSubImage3D(
+			GL_TEXTURE_2D_ARRAY, 0,
+			region->x, region->y, region->layer,
+			region->width, region->height, 1,
+			GL_RGBA, GL_UNSIGNED_BYTE, pixels
+		));
+	}
+	else{
+		GLCall(glTexSubImage2D(
+			GL_TEXTURE_2D, 0,
+			region->x, region->y,
+			region->width, region->height,
+			GL_RGBA, GL_UNSIGNED_BYTE, pixels
+		));
+	}
+}
+
+bool add( TextureAtlas * atlas, const unsigned char* pixels, int width, int height, AtlasRegion * region ){
+
+	if ( !reserve( atlas, width, height, region ) )
+		return false;
+
+	upload( atlas, region, pixels );
+
+	return true;
+}
+
+void fill( TextureAtlas * atlas, AtlasRegion * region, Texture * source ){
+
+	if ( source->width != region->width || source->height != region->height ){
+		printf( "Texture is %dx%d, its atlas region %dx%d\n", source->width, source->height, region->width, region->height );
+		return;
+	}
+
+	// Decompressed by the driver if it's a cooked texture
+	unsigned char* pixels = (unsigned char*) malloc( region->width * region->height * 4 );
+
+	stateBindTexture( GL_TEXTURE_2D, source->rendererId );
+	GLCall(glGetTexImage( GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels ));
+
+	upload( atlas, region, pixels );
+
+	free( pixels );
+}
+
+bool add( TextureAtlas * atlas, const char* filePath, AtlasRegion * region ){
+
+	int width, height, bpp;
+
+	// Bottom row first, as for any other texture
+	unsigned char* pixels = stbi_load( filePath, &width, &height, &bpp, 4 );
+
+	if ( pixels == NULL ){
+		printf( "Could not load texture %s\n", filePath );
+		return false;
+	}
+
+	bool added = add( atlas, pixels, width, height, region );
+
+	if ( !added )
+		printf( "No room in the atlas for %s\n", filePath );
+
+	stbi_image_free( pixels );
+
+	return added;
+}
+
+void remapTexCoords(
+	AtlasRegion * region,
+	GLfloat * vertices,
+	unsigned int vertexCount,
+	unsigned int stride,
+	unsigned int offset,
+	unsigned int components ){
+
+	for ( unsigned int i = 0; i < vertexCount; i++ ){
+
+		GLfloat * texCoord = vertices + i * stride + offset;
+
+		texCoord[0] = region->u0 + texCoord[0] * ( region->u1 - region->u0 );
+		texCoord[1] = region->v0 + texCoord[1] * ( region->v1 - region->v0 );
+
+		if ( components > 2 )
+			texCoord[2] = region->layer;
+	}
+}
+
+
+
+
+
+//
+// Texture manager
+//
+
+// What it takes in video memory, with every level
+static size_t textureBytes( Texture * texture ){
+
+	size_t bytes = 0;
+
+	for ( int level = 0; level < texture->levels; level++ ){
+
+		size_t width = levelSize( texture->width, level );
+		size_t height = levelSize( texture->height, level );
+
+		if ( texture->format == GL_RGBA8 )
+			bytes += width * height * 4;
+		else
+			bytes += ( ( width + 3 ) / 4 ) * ( ( height + 3 ) / 4 ) * (
+				texture->format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT ||
+				texture->format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT ? 8 : 16
+			);
+	}
+
+	return bytes;
+}
+
+// Entries of the same contents loaded with different options are different textures
+static uint64_t textureKey( uint64_t contentHash, TextureOptions options ){
+
+	// Field by field, as there is padding between them
+	uint64_t hash = hashBytes( &options.mipmaps, sizeof( options.mipmaps ), contentHash );
+	hash = hashBytes( &options.trilinear, sizeof( options.trilinear ), hash );
+	return hashBytes( &options.anisotropy, sizeof( options.anisotropy ), hash );
+}
+
+static bool sameOptions( TextureOptions a, TextureOptions b ){
+
+	return a.mipmaps == b.mipmaps && a.trilinear == b.trilinear && a.anisotropy == b.anisotropy;
+}
+
+// Whether the file at filePath holds the same bytes
+static bool sameContents( const char* filePath, FileView * file ){
+
+	FileView other;
+
+	if ( !mapFile( &other, filePath ) )
+		return false;
+
+	bool same = other.size == file->size && memcmp( other.data, file->data, file->size ) == 0;
+	unmapFile( &other );
+
+	return same;
+}
+
+// The entry with this hash, if it was loaded from filePath,
+// or, when the file is given, from one with the same contents
+static TextureEntry * findEntry(
+	TextureManager * manager,
+	uint64_t hash,
+	const char* filePath,
+	TextureOptions options,
+	FileView * file = NULL ){
+
+	TextureEntry * entry = manager->entries[hash % TEXTURE_MANAGER_BUCKETS];
+
+	for ( ; entry != NULL; entry = entry->next ){
+
+		if ( entry->hash != hash || !sameOptions( entry->options, options ) )
+			continue;
+
+		if ( strcmp( entry->path, filePath ) == 0 ||
+			( file != NULL && sameContents( entry->path, file ) ) )
+			return entry;
+	}
+
+	return NULL;
+}
+
+// Count the textures loaded in the background since the last time.
+// Until then they show the loader's placeholder, which isn't theirs
+static void countLoaded( TextureManager * manager ){
+
+	for ( int i = 0; i < TEXTURE_MANAGER_BUCKETS; i++ )
+		for ( TextureEntry * entry = manager->entries[i]; entry != NULL; entry = entry->next )
+			if ( entry->texture.loaded && entry->bytes == 0 ){
+				entry->bytes = textureBytes( &entry->texture );
+				manager->stats.residentBytes += entry->bytes;
+			}
+}
+
+static void unlinkReleased( TextureManager * manager, TextureEntry * entry ){
+
+	if ( entry->older != NULL )
+		entry->older->newer = entry->newer;
+	else
+		manager->oldestReleased = entry->newer;
+
+	if ( entry->newer != NULL )
+		entry->newer->older = entry->older;
+	else
+		manager->newestReleased = entry->older;
+
+	entry->older = entry->newer = NULL;
+}
+
+// Delete released textures until back within budget.
+// Those still loading are skipped, as the loader will write to them,
+// and so are those that failed to, which only show the placeholder
+static void evict( TextureManager * manager ){
+
+	countLoaded( manager );
+
+	TextureEntry * entry = manager->oldestReleased;
+
+	while ( manager->stats.residentBytes > manager->budgetBytes && entry != NULL ){
+
+		TextureEntry * newer = entry->newer;
+
+		if ( !entry->texture.loaded ){
+			entry = newer;
+			continue;
+		}
+
+		unlinkReleased( manager, entry );
+
+		TextureEntry ** link = &manager->entries[entry->hash % TEXTURE_MANAGER_BUCKETS];
+		while ( *link != entry )
+			link = &( *link )->next;
+		*link = entry->next;
+
+		stateForgetTexture( entry->texture.rendererId );
+		GLCall(glDeleteTextures( 1, &entry->texture.rendererId ));
+
+		manager->stats.residentBytes -= entry->bytes;
+		manager->stats.evictions++;
+
+		free( entry->path );
+		free( entry );
+
+		entry = newer;
+	}
+}
+
+void init( TextureManager * manager, size_t budgetBytes, TextureLoader * loader ){
+
+	memset( manager, 0, sizeof( TextureManager ) );
+	manager->budgetBytes = budgetBytes;
+	manager->loader = loader;
+}
+
+Texture * acquire( TextureManager * manager, const char* filePath, TextureOptions options ){
+
+	// Seen this path before
+
+	uint64_t pathHash = hashBytes( filePath, strlen( filePath ) );
+	TexturePath * path = manager->paths[pathHash % TEXTURE_MANAGER_BUCKETS];
+
+	while ( path != NULL && strcmp( path->path, filePath ) != 0 )
+		path = path->next;
+
+	TextureEntry * entry = path != NULL ?
+		findEntry( manager, textureKey( path->hash, options ), filePath, options ) :
+		NULL;
+
+	if ( entry != NULL )
+		manager->stats.hits++;
+
+
+	// Otherwise read it, and look for its contents
+
+	FileView file = {};
+
+	if ( entry == NULL && !mapFile( &file, filePath ) ){
+
+		// Not cached, so that it's tried again next time,
+		// and not shared with other files that failed
+		manager->stats.misses++;
+
+		entry = (TextureEntry*) malloc( sizeof( TextureEntry ) );
+		init( &entry->texture, NULL, 0, filePath, options );
+
+		entry->hash = 0;
+		entry->path = NULL;
+		entry->options = options;
+		entry->shared = false;
+		entry->references = 1;
+		entry->bytes = textureBytes( &entry->texture );
+		entry->next = entry->older = entry->newer = NULL;
+
+		manager->stats.residentBytes += entry->bytes;
+
+		return &entry->texture;
+	}
+
+	if ( entry == NULL ){
+
+		uint64_t hash = hashBytes( file.data, file.size );
+
+		if ( path == NULL ){
+			path = (TexturePath*) malloc( sizeof( TexturePath ) );
+			path->path = strdup( filePath );
+			path->next = manager->paths[pathHash % TEXTURE_MANAGER_BUCKETS];
+			manager->paths[pathHash % TEXTURE_MANAGER_BUCKETS] = path;
+		}
+		path->hash = hash;
+
+		entry = findEntry( manager, textureKey( hash, options ), filePath, options, &file );
+
+		if ( entry != NULL )
+			manager->stats.contentHits++;
+	}
+
+
+	// Or load it
+
+	if ( entry == NULL ){
+
+		manager->stats.misses++;
+
+		entry = (TextureEntry*) malloc( sizeof( TextureEntry ) );
+
+		// The loader reads the file again, most likely from the OS cache.
+		// Its bytes are counted once it's done
+		if ( manager->loader != NULL )
+			init( &entry->texture, filePath, manager->loader, options );
+		else
+			init( &entry->texture, file.data, file.size, filePath, options );
+
+		entry->hash = textureKey( path->hash, options );
+		entry->path = strdup( filePath );
+		entry->options = options;
+		entry->shared = true;
+		entry->references = 0;
+		entry->bytes = 0;
+		entry->older = entry->newer = NULL;
+
+		entry->next = manager->entries[entry->hash % TEXTURE_MANAGER_BUCKETS];
+		manager->entries[entry->hash % TEXTURE_MANAGER_BUCKETS] = entry;
+	}
+
+	unmapFile( &file );
+
+
+	// Back in use, so it can't be evicted
+
+	if ( entry->references == 0 && ( entry->older != NULL || manager->oldestReleased == entry ) )
+		unlinkReleased( manager, entry );
+
+	entry->references++;
+
+	evict( manager );
+
+	return &entry->texture;
+}
+
+void release( TextureManager * manager, Texture * texture ){
+
+	TextureEntry * entry = (TextureEntry*) texture;
+
+	if ( --entry->references > 0 )
+		return;
+
+	if ( !entry->shared ){
+		stateForgetTexture( entry->texture.rendererId );
+		GLCall(glDeleteTextures( 1, &entry->texture.rendererId ));
+		manager->stats.residentBytes -= entry->bytes;
+		free( entry );
+		return;
+	}
+
+	// Newest released, last to go
+	entry->older = manager->newestReleased;
+	entry->newer = NULL;
+
+	if ( manager->newestReleased != NULL )
+		manager->newestReleased->newer = entry;
+	else
+		manager->oldestReleased = entry;
+
+	manager->newestReleased = entry;
+
+	evict( manager );
+}
+
+void printStats( TextureManager * manager ){
+
+	countLoaded( manager );
+
+	TextureManagerStats * stats = &manager->stats;
+
+	printf(
+		"Textures: %u hits, %u by contents, %u misses, %u evicted, %.1f of %.1f MB resident\n",
+		stats->hits, stats->contentHits, stats->misses, stats->evictions,
+		stats->residentBytes / ( 1024.0 * 1024.0 ),
+		manager->budgetBytes / ( 1024.0 * 1024.0 )
+	);
+}
+
+
+
+
+
+//
+// Axes
+//
+
+
+void init( Axes * axes, Shader * shader ){
+
+	axes[0] = (Axes) {};
+    axes->axisSize = 1000;
+	axes->shader = shader;
+
+	createArrayData( axes );
+
+
+	// Positions and colors live in separate buffers,
+	// with 3 floats per vertex each
+
+	axes->vertexArrayObject = (VertexArray*) malloc( sizeof( VertexArray ) );
+	init( axes->vertexArrayObject );
+
+	axes->positionBuffer = (VertexBuffer*) malloc( sizeof( VertexBuffer ) );
+	init( axes->positionBuffer, sizeof( axes->vertexArray ), axes->vertexArray );
+
+	VertexBufferLayout * layout = (VertexBufferLayout*) malloc( sizeof( VertexBufferLayout ) );
+	init( layout );
+	push( layout, 3, GL_FLOAT );
+	push( axes->vertexArrayObject, axes->positionBuffer, layout );
+
+	axes->colorBuffer = (VertexBuffer*) malloc( sizeof( VertexBuffer ) );
+	init( axes->colorBuffer, sizeof( axes->colorArray ), axes->colorArray );
+
+	// Same layout for the colors
+	push( axes->vertexArrayObject, axes->colorBuffer, layout );
+}
+
+
+void createArrayData( Axes * axes ){
+
+	axes->colorArray[0] = 1; axes->colorArray[1] = 0; axes->colorArray[2] = 0;
+	axes->colorArray[3] = 1; axes->colorArray[4] = 0; axes->colorArray[5] = 0;
+	axes->colorArray[6] = 0; axes->colorArray[7] = 1; axes->colorArray[8] = 0;
+	axes->colorArray[9] = 0; axes->colorArray[10] = 1; axes->colorArray[11] = 0;
+	axes->colorArray[12] = 0; axes->colorArray[13] = 0; axes->colorArray[14] = 1;
+	axes->colorArray[15] = 0; axes->colorArray[16] = 0; axes->colorArray[17] = 1;
+
+	axes->vertexArray[0] = -axes->axisSize; axes->vertexArray[1] = 0; axes->vertexArray[2] = 0;
+	axes->vertexArray[3] = axes->axisSize; axes->vertexArray[4] = 0; axes->vertexArray[5] = 0;
+	axes->vertexArray[6] = 0; axes->vertexArray[7] = -axes->axisSize; axes->vertexArray[8] = 0;
+	axes->vertexArray[9] = 0; axes->vertexArray[10] = axes->axisSize; axes->vertexArray[11] = 0;
+	axes->vertexArray[12] = 0; axes->vertexArray[13] = 0; axes->vertexArray[14] = -axes->axisSize;
+	axes->vertexArray[15] = 0; axes->vertexArray[16] = 0; axes->vertexArray[17] = axes->axisSize;
+}
+
+
+
+void draw( Axes * axes, Renderer * renderer ){
+
+	drawArrays( renderer, axes->vertexArrayObject, axes->shader, GL_LINES, 0, 6 );
+}
+
+
+
+void changeAxisSize( Axes * axes, float newSize ){
+
+	axes->axisSize = newSize;
+	createArrayData( axes );
+
+	update( axes->positionBuffer, 0, sizeof( axes->vertexArray ), axes->vertexArray );
+}
+
+
+
+
+
+//
+// Debug lines
+//
+
+void init( DebugLines * lines, Shader * shader, unsigned int maxLines ){
+
+	lines->shader = shader;
+	lines->maxVertices = maxLines * 2;
+	lines->vertexCount = 0;
+	lines->vertices = (DebugLineVertex*)
+		malloc( sizeof( DebugLineVertex ) * lines->maxVertices );
+
+	lines->vertexArray = (VertexArray*) malloc( sizeof( VertexArray ) );
+	init( lines->vertexArray );
+
+	lines->vertexBuffer = (VertexBuffer*) malloc( sizeof( VertexBuffer ) );
+	init(
+		lines->vertexBuffer,
+		sizeof( DebugLineVertex ) * lines->maxVertices,
+		STREAM_PERSISTENT
+	);
+
+	VertexBufferLayout * layout = (VertexBufferLayout*) malloc( sizeof( VertexBufferLayout ) );
+	init( layout );
+	push( layout, 3, GL_FLOAT ); // position
+	push( layout, 4, GL_FLOAT ); // color
+	push( lines->vertexArray, lines->vertexBuffer, layout );
+}
+
+void addLine( DebugLines * lines, vec3 from, vec3 to, vec4 color ){
+
+	if ( lines->vertexCount + 2 > lines->maxVertices )
+		return;
+
+	DebugLineVertex * vertex = &lines->vertices[lines->vertexCount];
+
+	glm_vec3_copy( from, vertex[0].position );
+	glm_vec4_copy( color, vertex[0].color );
+	glm_vec3_copy( to, vertex[1].position );
+	glm_vec4_copy( color, vertex[1].color );
+
+	lines->vertexCount += 2;
+}
+
+void addBox( DebugLines * lines, vec3 box[2], vec4 color ){
+
+	vec3 corners[8];
+
+	// Bit i of the corner index picks min or max for axis i
+	for ( int i = 0; i < 8; i++ ){
+		corners[i][0] = box[( i >> 0 ) & 1][0];
+		corners[i][1] = box[( i >> 1 ) & 1][1];
+		corners[i][2] = box[( i >> 2 ) & 1][2];
+	}
+
+	// Edges join corners that differ in a single axis
+	for ( int i = 0; i < 8; i++ )
+		for ( int axis = 0; axis < 3; axis++ )
+			if ( !( i & ( 1 << axis ) ) )
+				addLine( lines, corners[i], corners[i | ( 1 << axis )], color );
+}
+
+void addGrid( DebugLines * lines, float halfSize, unsigned int divisions, vec4 color ){
+
+	float step = 2 * halfSize / divisions;
+
+	for ( int i = 0; i <= divisions; i++ ){
+
+		float position = -halfSize + i * step;
+
+		vec3 verticalFrom = { position, -halfSize, 0 };
+		vec3 verticalTo = { position, halfSize, 0 };
+		addLine( lines, verticalFrom, verticalTo, color );
+
+		vec3 horizontalFrom = { -halfSize, position, 0 };
+		vec3 horizontalTo = { halfSize, position, 0 };
+		addLine( lines, horizontalFrom, horizontalTo, color );
+	}
+}
+
+void addNormals( DebugLines * lines, vec3 * positions, vec3 * normals, unsigned int count, float length, vec4 color ){
+
+	for ( int i = 0; i < count; i++ ){
+
+		vec3 end;
+
+		glm_vec3_scale( normals[i], length, end );
+		glm_vec3_add( positions[i], end, end );
+		addLine( lines, positions[i], end, color );
+	}
+}
+
+void addProfilerBars( DebugLines * lines, Profiler * profiler, float left, float top ){
+
+	const float frameMilliseconds = 1000.0f / 60;
+	const float rowHeight = 0.04;
+
+	vec4 p50Color = { 0, 1, 0, 1 };
+	vec4 p99Color = { 1, 0, 0, 1 };
+	vec4 markColor = { 1, 1, 1, 0.5 };
+
+	for ( unsigned int i = 0; i < profiler->scopeCount; i++ ){
+
+		ProfilerStats stats = getStats( profiler, i );
+		float y = top - i * rowHeight;
+
+		vec3 from = { left, y, 0 };
+		vec3 p50 = { left + stats.p50 / frameMilliseconds, y, 0 };
+		addLine( lines, from, p50, p50Color );
+
+		from[1] = y - rowHeight / 3;
+		vec3 p99 = { left + stats.p99 / frameMilliseconds, from[1], 0 };
+		addLine( lines, from, p99, p99Color );
+	}
+
+	vec3 markFrom = { left + 1, top + rowHeight / 2, 0 };
+	vec3 markTo = { left + 1, top - profiler->scopeCount * rowHeight, 0 };
+	addLine( lines, markFrom, markTo, markColor );
+}
+
+void draw( DebugLines * lines, Renderer * renderer ){
+
+	// Fences everything issued up to now,
+	// including the draw of the previous frame
+	nextFrame( lines->vertexBuffer );
+
+	if ( lines->vertexCount == 0 )
+		return;
+
+	unsigned int size = sizeof( DebugLineVertex ) * lines->vertexCount;
+	unsigned int offset;
+	void* data = beginWrite( lines->vertexBuffer, size, &offset );
+
+	if ( data != NULL ){
+
+		memcpy( data, lines->vertices, size );
+		endWrite( lines->vertexBuffer );
+
+		// Some, like the grid, are see through
+		setTranslucent( renderer, true );
+		drawArrays(
+			renderer,
+			lines->vertexArray,
+			lines->shader,
+			GL_LINES,
+			offset / sizeof( DebugLineVertex ),
+			lines->vertexCount
+		);
+		setTranslucent( renderer, false );
+	}
+
+	lines->vertexCount = 0;
+}
+
+
+
+
+
+//
+// Triangle
+//
+
+static const GLfloat triangleVertices[] = {
+	// 3 coords for position,
+	// 4 for base color,
+	// 2 for texture mapping
+	-0.5, -0.5, 0.0,	0.8, 0.5, 0.2, 1.0,		0.0, 0.0,
+	0.5, -0.5, 0.0,		0.8, 0.5, 0.2, 1.0,		1.0, 0.0,
+	0.0, 0.5, 0.0,		0.8, 0.5, 0.2, 1.0,		0.5, 0.8,
+	0.1, 0.7, 0.0,		0.8, 0.5, 0.2, 1.0,		0.6, 1.0,
+	-0.1, 0.7, 0.0,		0.8, 0.5, 0.2, 1.0,		0.4, 1.0
+};
+
+static const GLuint triangleIndices[] = {
+	0, 1, 2,
+	2, 3, 4
+};
+
+// Each part in the arena is a single triangle,
+// with the body taking the first three vertices
+// and the tip the last three
+#define TRIANGLE_TIP_FIRST_VERTEX 2
+static const GLuint trianglePartIndices[] = { 0, 1, 2 };
+
+void init( Triangle * triangle, Shader * shader, TextureManager * textures ){
+
+
+	triangle->shader = shader;
+	triangle->arena = NULL;
+	triangle->body = triangle->tip = NULL;
+	triangle->angle = 0;
+	glm_vec4_one( triangle->color );
+
+	const GLfloat* vertices = triangleVertices;
+	const GLuint* indices = triangleIndices;
+	int positionDimensions = 3;
+	int colorDimensions = 4;
+	int textureDimensions = 2;
+	int dimensions = positionDimensions + colorDimensions + textureDimensions;
+	triangle->vertexCount =
+		sizeof( triangleVertices ) / sizeof( GLfloat ) / dimensions;
+	triangle->indexCount =
+		sizeof( triangleIndices ) / sizeof( GLuint );
+
+
+	// Dealing with blending to display transparency
+	GLCall(glEnable( GL_BLEND ));
+	GLCall(glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA ));
+
+
+	// Initialize first the vertex array
+	// to have it bound when dealing with the rest
+	triangle->vertexArray =
+		(VertexArray*) malloc( sizeof( VertexArray ) );
+	init( triangle->vertexArray );
+	bind( triangle->vertexArray );
+
+
+	// Initialize index buffer
+
+	triangle->indexBuffer =
+		(IndexBuffer*) malloc( sizeof( IndexBuffer ) );
+	init(
+		triangle->indexBuffer,
+		sizeof( triangleIndices ),
+		indices
+	);
+
+
+	// Initialize vertex buffer
+
+	triangle->vertexBuffer =
+		(VertexBuffer*) malloc( sizeof( VertexBuffer ) );
+	init(
+		triangle->vertexBuffer,
+		sizeof( triangleVertices ),
+		vertices
+	);
+
+	// Tell the vertex array the configuration of our vertices,
+	// how should OpenGL interpret the raw data
+	triangle->vertexBufferLayout =
+		(VertexBufferLayout*) malloc( sizeof( VertexBufferLayout ) );
+	init( triangle->vertexBufferLayout );
+	// We have <positionDimensions> floats per vertex for position
+	push( triangle->vertexBufferLayout, positionDimensions, GL_FLOAT );
+	// <colorDimensions> more floats per vertex for the base color
+	push( triangle->vertexBufferLayout, colorDimensions, GL_FLOAT );
+	// and <textureDimensions> more floats per vertex for texturing
+	push( triangle->vertexBufferLayout, textureDimensions, GL_FLOAT );
+	// And load it finally to the vertex array
+	push(
+		triangle->vertexArray,
+		triangle->vertexBuffer,
+		triangle->vertexBufferLayout
+	);
+
+
+	// Initialize and bind the texture
+
+	triangle->texture = acquire( textures, "img/texture.jpeg" );
+
+	bind( triangle->texture, 0 ); // texture bound to slot 0
+
+	triangle->u_Texture = getUniformLocation( triangle->shader, "u_Texture" );
+	setUniform1i( triangle->shader, triangle->u_Texture, 0 ); // so 0 here too
+}
+
+
+void addMeshes( Triangle * triangle, MeshArena * arena ){
+
+	triangle->arena = arena;
+
+	triangle->body = add( arena, triangleVertices, 3, trianglePartIndices, 3 );
+	triangle->tip = NULL;
+	toggleTip( triangle );
+}
+
+void toggleTip( Triangle * triangle ){
+
+	if ( triangle->tip != NULL ){
+
+		release( triangle->arena, triangle->tip );
+		triangle->tip = NULL;
+
+		// Join the space it leaves with the rest
+		compact( triangle->arena );
+	}
+	else {
+
+		int dimensions = triangle->vertexBufferLayout->stride / sizeof( GLfloat );
+
+		triangle->tip = add(
+			triangle->arena,
+			triangleVertices + TRIANGLE_TIP_FIRST_VERTEX * dimensions,
+			3,
+			trianglePartIndices,
+			3
+		);
+	}
+}
+
+
+void modelMatrix( Triangle * triangle, mat4 model ){
+
+	vec3 zAxis = { 0, 0, 1 };
+	glm_rotate_make( model, triangle->angle, zAxis );
+}
+
+void draw( Triangle * triangle, Renderer * renderer ){
+
+	mat4 model;
+	modelMatrix( triangle, model );
+	setObjectData( renderer, model, triangle->color );
+	// Blended with the background where the texture is dark
+	setTranslucent( renderer, true );
+
+	// Same arena, shader, texture and object data,
+	// queued one after the other, so both end up in a single multi draw
+	if ( triangle->body != NULL )
+		draw( renderer, triangle->arena, triangle->body, triangle->shader, triangle->texture );
+	if ( triangle->tip != NULL )
+		draw( renderer, triangle->arena, triangle->tip, triangle->shader, triangle->texture );
+
+	// Back to the defaults, for whatever is drawn next
+	mat4 identity = GLM_MAT4_IDENTITY_INIT;
+	vec4 white = { 1, 1, 1, 1 };
+	setObjectData( renderer, identity, white );
+	setTranslucent( renderer, false );
+}
+
+
+
+
+//
+// Triangle instances
 //
 
-void init( Texture * texture, const char* filePath ){
+void init( TriangleInstances * instances, Triangle * triangle, Shader * shader, unsigned int instanceCount ){
 
-	// OpenGL expects the texture to start at the bottom left,
-	// not the top left as it is saved in massive storage
-	stbi_set_flip_vertically_on_load( true );
-
-	unsigned char* localBuffer = stbi_load(
-		filePath,
-		&texture->width,
-		&texture->height,
-		&texture->bpp,
-		// We want four channels for our picture (RGBA)
-		4
-	);
+	instances->triangle = triangle;
+	instances->shader = shader;
+	instances->instanceCount = instanceCount;
 
-	GLCall(glGenTextures( 1, &texture->rendererId ));
-	GLCall(glBindTexture( GL_TEXTURE_2D, texture->rendererId ));
 
-	GLCall(glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR ));
-	GLCall(glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR ));
-	GLCall(glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE ));
-	GLCall(glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE ));
+	// Lay the copies out in a grid covering the view,
+	// each one with its own tint
 
-	GLCall(glTexImage2D(
-		GL_TEXTURE_2D,
-		0,
-		GL_RGBA8,
-		texture->width,
-		texture->height,
-		0,
-		GL_RGBA,
-		GL_UNSIGNED_BYTE,
-		localBuffer
-	));
+	unsigned int side = 1;
+	while ( side * side < instanceCount )
+		side++;
 
-	GLCall(glBindTexture( GL_TEXTURE_2D, 0 ));
+	float cellSize = 2.0f / side;
 
-	// Free the image once it's already been loaded to OpenGL
-	if ( localBuffer )
-		stbi_image_free( localBuffer );
-}
+	TriangleInstance * data = (TriangleInstance*)
+		malloc( sizeof( TriangleInstance ) * instanceCount );
 
-void bind( Texture * texture, GLuint slot ){
+	for ( int i = 0; i < instanceCount; i++ ){
 
-	GLCall(glActiveTexture( GL_TEXTURE0 + slot ));
-	GLCall(glBindTexture( GL_TEXTURE_2D, texture->rendererId ));
-}
+		vec3 position = {
+			-1 + cellSize * ( i % side + 0.5f ),
+			-1 + cellSize * ( i / side + 0.5f ),
+			0
+		};
 
-void unbind( Texture * texture ){
+		glm_translate_make( data[i].model, position );
+		glm_scale_uni( data[i].model, cellSize );
 
-	GLCall(glBindTexture( GL_TEXTURE_2D, 0 ));
-}
+		data[i].color[0] = (float) ( i % side ) / side;
+		data[i].color[1] = (float) ( i / side ) / side;
+		data[i].color[2] = 1;
+		data[i].color[3] = 1;
+	}
 
 
+	// Same mesh attributes as the triangle,
+	// plus the per instance ones after them
 
+	instances->vertexArray =
+		(VertexArray*) malloc( sizeof( VertexArray ) );
+	init( instances->vertexArray );
+	push(
+		instances->vertexArray,
+		triangle->vertexBuffer,
+		triangle->vertexBufferLayout
+	);
 
+	instances->instanceBuffer =
+		(VertexBuffer*) malloc( sizeof( VertexBuffer ) );
+	init(
+		instances->instanceBuffer,
+		sizeof( TriangleInstance ) * instanceCount,
+		data
+	);
 
-//
-// Axes
-//
+	VertexBufferLayout * instanceLayout =
+		(VertexBufferLayout*) malloc( sizeof( VertexBufferLayout ) );
+	init( instanceLayout, 1 ); // advance once per instance
+	// Model matrix
+	push( instanceLayout, 16, GL_FLOAT );
+	// Tint
+	push( instanceLayout, 4, GL_FLOAT );
+	push(
+		instances->vertexArray,
+		instances->instanceBuffer,
+		instanceLayout
+	);
 
+	// The index buffer binding is stored in the vertex array too
+	bind( triangle->indexBuffer );
 
-void init( Axes * axes ){
+	free( data );
 
-	axes[0] = (Axes) {};
-    axes->axisSize = 1000;
+	setUniform1i( shader, getUniformLocation( shader, "u_Texture" ), 0 );
 }
 
 
-void createArrayData( Axes * axes ){
-
-	axes->colorArray[0] = 1; axes->colorArray[1] = 0; axes->colorArray[2] = 0;
-	axes->colorArray[3] = 1; axes->colorArray[4] = 0; axes->colorArray[5] = 0;
-	axes->colorArray[6] = 0; axes->colorArray[7] = 1; axes->colorArray[8] = 0;
-	axes->colorArray[9] = 0; axes->colorArray[10] = 1; axes->colorArray[11] = 0;
-	axes->colorArray[12] = 0; axes->colorArray[13] = 0; axes->colorArray[14] = 1;
-	axes->colorArray[15] = 0; axes->colorArray[16] = 0; axes->colorArray[17] = 1;
+void draw( TriangleInstances * instances, Renderer * renderer ){
 
-	axes->vertexArray[0] = -axes->axisSize; axes->vertexArray[1] = 0; axes->vertexArray[2] = 0;
-	axes->vertexArray[3] = axes->axisSize; axes->vertexArray[4] = 0; axes->vertexArray[5] = 0;
-	axes->vertexArray[6] = 0; axes->vertexArray[7] = -axes->axisSize; axes->vertexArray[8] = 0;
-	axes->vertexArray[9] = 0; axes->vertexArray[10] = axes->axisSize; axes->vertexArray[11] = 0;
-	axes->vertexArray[12] = 0; axes->vertexArray[13] = 0; axes->vertexArray[14] = -axes->axisSize;
-	axes->vertexArray[15] = 0; axes->vertexArray[16] = 0; axes->vertexArray[17] = axes->axisSize;
+	setTranslucent( renderer, true );
+	drawInstanced(
+		renderer,
+		instances->vertexArray,
+		instances->triangle->indexBuffer,
+		instances->shader,
+		instances->instanceCount,
+		instances->triangle->texture
+	);
+	setTranslucent( renderer, false );
 }
 
 
 
-void draw( Axes * axes ){
 
-	drawAxesLegacy( axes );
-}
+//
+// Sprites
+//
 
+void init( Sprites * sprites, Shader * shader, TextureManager * textures ){
 
-void drawAxesLegacy( Axes * axes ){
+	sprites->shader = shader;
+	sprites->spriteCount = 0;
+	sprites->textures = textures;
+	sprites->source = NULL;
 
-	glLineWidth( 1 );
+	// Small layers, so that the texture fills the first one
+	// and the rest go to the second
+	sprites->atlas = (TextureAtlas*) malloc( sizeof( TextureAtlas ) );
+	init( sprites->atlas, 256, 256, GL_TEXTURE_2D_ARRAY, 2 );
 
-	glBegin( GL_LINES );
-		// X axis, in red
-		glColor3f( 1, 0, 0 );
-		glVertex3f( -axes->axisSize, 0, 0 );
-		glVertex3f( axes->axisSize, 0, 0 );
-		// Y axis, in green
-		glColor3f( 0, 1, 0 );
-		glVertex3f( 0, -axes->axisSize, 0 );
-		glVertex3f( 0, axes->axisSize, 0 );
-		// Z axis, in blue
-		glColor3f( 0, 0, 1 );
-		glVertex3f( 0, 0, -axes->axisSize );
-		glVertex3f( 0, 0, axes->axisSize );
-	glEnd();
-}
+	// Only its size for now, read from the header,
+	// so its region is transparent until the texture is loaded
+	int imageWidth, imageHeight, imageBpp;
 
+	if ( stbi_info( "img/texture.jpeg", &imageWidth, &imageHeight, &imageBpp ) &&
+		reserve( sprites->atlas, imageWidth, imageHeight, &sprites->regions[sprites->spriteCount] ) ){
+		sprites->source = acquire( textures, "img/texture.jpeg" );
+		sprites->spriteCount++;
+	}
 
-void drawAxesModern( Axes * axes ){
 
-	glEnableClientState( GL_COLOR_ARRAY );
-	glColorPointer( 3, GL_FLOAT, 0, axes->colorArray );
-	glDrawArrays( GL_LINES, 0, 6 ) ;
-}
+	// Made up images for the rest: a checkerboard,
+	// and stripes of two different sizes
 
+	int sizes[SPRITE_COUNT - 1][2] = { { 96, 96 }, { 128, 48 }, { 48, 128 } };
 
+	for ( int i = 0; i < SPRITE_COUNT - 1; i++ ){
 
-void changeAxisSize( Axes * axes, float newSize ){
+		int width = sizes[i][0], height = sizes[i][1];
+		unsigned char* pixels = (unsigned char*) malloc( width * height * 4 );
 
-	axes->axisSize = newSize;
-	createArrayData( axes );
-}
+		for ( int y = 0; y < height; y++ )
+			for ( int x = 0; x < width; x++ ){
 
+				bool on = i == 0 ? ( ( x / 16 ) + ( y / 16 ) ) % 2 : ( ( i == 1 ? x : y ) / 8 ) % 2;
+				unsigned char* pixel = pixels + ( y * width + x ) * 4;
 
+				pixel[0] = pixel[1] = pixel[2] = on ? 255 : 128;
+				pixel[3] = 255;
+			}
 
+		if ( add( sprites->atlas, pixels, width, height, &sprites->regions[sprites->spriteCount] ) )
+			sprites->spriteCount++;
 
+		free( pixels );
+	}
 
-//
-// Triangle
-//
 
-void init( Triangle * triangle, Shader * shader ){
+	// A row of quads along the bottom of the view,
+	// as tall as each other and keeping the shape of their image
 
+	const int dimensions = 3 + 4 + 3;
+	GLfloat vertices[SPRITE_COUNT * 4 * dimensions];
+	GLuint indices[SPRITE_COUNT * 6];
 
-	triangle->shader = shader;
+	float left = -1.2, bottom = -0.95, height = 0.25;
 
-	GLfloat vertices[] = {
-		// 3 coords for position,
-		// 4 for base color,
-		// 2 for texture mapping
-		-0.5, -0.5, 0.0,	0.8, 0.5, 0.2, 1.0,		0.0, 0.0,
-		0.5, -0.5, 0.0,		0.8, 0.5, 0.2, 1.0,		1.0, 0.0,
-		0.0, 0.5, 0.0,		0.8, 0.5, 0.2, 1.0,		0.5, 0.8,
-		0.1, 0.7, 0.0,		0.8, 0.5, 0.2, 1.0,		0.6, 1.0,
-		-0.1, 0.7, 0.0,		0.8, 0.5, 0.2, 1.0,		0.4, 1.0
-	};
-	GLuint indices[] = {
-		0, 1, 2,
-		2, 3, 4
-	};
-	int positionDimensions = 3;
-	int colorDimensions = 4;
-	int textureDimensions = 2;
-	int dimensions = positionDimensions + colorDimensions + textureDimensions;
-	triangle->vertexCount =
-		sizeof( vertices ) / sizeof( GLfloat ) / dimensions;
-	triangle->indexCount =
-		sizeof( indices ) / sizeof( GLuint );
+	for ( unsigned int i = 0; i < sprites->spriteCount; i++ ){
 
+		AtlasRegion * region = &sprites->regions[i];
+		float width = height * region->width / region->height;
 
-	// Dealing with blending to display transparency
-	GLCall(glEnable( GL_BLEND ));
-	GLCall(glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA ));
+		GLfloat quad[4 * dimensions] = {
+			left, bottom, 0,			1, 1, 1, 1,	0, 0, 0,
+			left + width, bottom, 0,		1, 1, 1, 1,	1, 0, 0,
+			left + width, bottom + height, 0,	1, 1, 1, 1,	1, 1, 0,
+			left, bottom + height, 0,		1, 1, 1, 1,	0, 1, 0
+		};
 
+		// Texture coordinates and layer of its region
+		remapTexCoords( region, quad, 4, dimensions, 7, 3 );
+		memcpy( vertices + i * 4 * dimensions, quad, sizeof( quad ) );
 
-	// Initialize first the vertex array
-	// to have it bound when dealing with the rest
-	triangle->vertexArray =
-		(VertexArray*) malloc( sizeof( VertexArray ) );
-	init( triangle->vertexArray );
-	bind( triangle->vertexArray );
+		GLuint quadIndices[6] = { 0, 1, 2, 2, 3, 0 };
+		for ( int j = 0; j < 6; j++ )
+			indices[i * 6 + j] = i * 4 + quadIndices[j];
 
+		left += width + 0.05;
+	}
 
-	// Initialize index buffer
 
-	triangle->indexBuffer =
-		(IndexBuffer*) malloc( sizeof( IndexBuffer ) );
-	init(
-		triangle->indexBuffer,
-		sizeof( indices ),
-		indices
-	);
+	sprites->vertexArray = (VertexArray*) malloc( sizeof( VertexArray ) );
+	init( sprites->vertexArray );
+	bind( sprites->vertexArray );
 
+	sprites->indexBuffer = (IndexBuffer*) malloc( sizeof( IndexBuffer ) );
+	init( sprites->indexBuffer, sprites->spriteCount * 6 * sizeof( GLuint ), indices );
 
-	// Initialize vertex buffer
+	sprites->vertexBuffer = (VertexBuffer*) malloc( sizeof( VertexBuffer ) );
+	init( sprites->vertexBuffer, sprites->spriteCount * 4 * dimensions * sizeof( GLfloat ), vertices );
 
-	VertexBuffer * vertexBuffer =
-		(VertexBuffer*) malloc( sizeof( VertexBuffer ) );
-	init(
-		vertexBuffer,
-		sizeof( vertices ),
-		vertices
-	);
+	VertexBufferLayout * layout = (VertexBufferLayout*) malloc( sizeof( VertexBufferLayout ) );
+	init( layout );
+	push( layout, 3, GL_FLOAT );
+	push( layout, 4, GL_FLOAT );
+	// Texture coordinates and layer
+	push( layout, 3, GL_FLOAT );
+	push( sprites->vertexArray, sprites->vertexBuffer, layout );
 
-	// Tell the vertex array the configuration of our vertices,
-	// how should OpenGL interpret the raw data
-	VertexBufferLayout * vertexBufferLayout =
-		(VertexBufferLayout*) malloc( sizeof( VertexBufferLayout ) );
-	init( vertexBufferLayout );
-	// We have <positionDimensions> floats per vertex for position
-	push( vertexBufferLayout, positionDimensions, GL_FLOAT );
-	// <colorDimensions> more floats per vertex for the base color
-	push( vertexBufferLayout, colorDimensions, GL_FLOAT );
-	// and <textureDimensions> more floats per vertex for texturing
-	push( vertexBufferLayout, textureDimensions, GL_FLOAT );
-	// And load it finally to the vertex array
-	push(
-		triangle->vertexArray,
-		vertexBuffer,
-		vertexBufferLayout
-	);
+	setUniform1i( shader, getUniformLocation( shader, "u_Texture" ), 0 );
+}
 
 
-	// Initialize and bind the texture
+void update( Sprites * sprites ){
 
-	triangle->texture =
-		(Texture*) malloc( sizeof( Texture ) );
-	init( triangle->texture, "img/texture.jpeg" );
+	if ( sprites->source == NULL || !sprites->source->loaded )
+		return;
 
-	bind( triangle->texture, 0 ); // texture bound to slot 0
+	fill( sprites->atlas, &sprites->regions[0], sprites->source );
 
-	triangle->u_Texture = getUniformLocation( triangle->shader, "u_Texture" );
-	setUniform1i( triangle->shader, triangle->u_Texture, 0 ); // so 0 here too
+	release( sprites->textures, sprites->source );
+	sprites->source = NULL;
 }
 
+void draw( Sprites * sprites, Renderer * renderer ){
 
-void draw( Triangle * triangle, Renderer * renderer ){
+	if ( sprites->spriteCount == 0 )
+		return;
 
+	setTranslucent( renderer, true );
 	draw(
 		renderer,
-		triangle->vertexArray,
-		triangle->indexBuffer,
-		triangle->shader
+		sprites->vertexArray,
+		sprites->indexBuffer,
+		sprites->shader,
+		&sprites->atlas->texture
 	);
+	setTranslucent( renderer, false );
 }
 
 
@@ -1057,18 +6350,47 @@ void draw( Triangle * triangle, Renderer * renderer ){
 
 
 
-void initScene( Scene * scene, int screenWidth, int screenHeight, Shader * shader ){
+void initScene(
+	Scene * scene,
+	int screenWidth, int screenHeight,
+	Shader * shader, Shader * instancedShader, Shader * lineShader, Shader * arrayShader ){
 
     scene->frontPlane = 10;
     scene->backPlane = 100;
     scene->observerDistance = 4 * scene->frontPlane;
     scene->observerAngleX = scene->observerAngleY = 0;
 
+	// Textures are loaded in the background,
+	// uploading for at most 2 ms per frame
+	scene->textureLoader = (TextureLoader*) malloc( sizeof( TextureLoader ) );
+	init( scene->textureLoader, 2.0 );
+
+	scene->textures = (TextureManager*) malloc( sizeof( TextureManager ) );
+	init( scene->textures, 64 * 1024 * 1024, scene->textureLoader );
+
 	scene->axes = (Axes*) malloc( sizeof( Axes ) );
-	init( scene->axes );
+	init( scene->axes, lineShader );
 
 	scene->triangle = (Triangle*) malloc( sizeof( Triangle ) );
-	init( scene->triangle, shader );
+	init( scene->triangle, shader, scene->textures );
+
+	scene->staticMeshes = (MeshArena*) malloc( sizeof( MeshArena ) );
+	init( scene->staticMeshes, scene->triangle->vertexBufferLayout, 1024, 4096 );
+	addMeshes( scene->triangle, scene->staticMeshes );
+
+	scene->triangleInstances = (TriangleInstances*) malloc( sizeof( TriangleInstances ) );
+	init( scene->triangleInstances, scene->triangle, instancedShader, TRIANGLE_INSTANCES );
+	scene->showInstances = false;
+
+	scene->debugLines = (DebugLines*) malloc( sizeof( DebugLines ) );
+	init( scene->debugLines, lineShader, 4096 );
+	scene->showDebugLines = false;
+
+	scene->overlayLines = (DebugLines*) malloc( sizeof( DebugLines ) );
+	init( scene->overlayLines, lineShader, 256 );
+
+	scene->sprites = (Sprites*) malloc( sizeof( Sprites ) );
+	init( scene->sprites, arrayShader, scene->textures );
 
 	scene->cameraAngleX = 0;
 	scene->cameraAngleY = 0;
@@ -1094,12 +6416,51 @@ void drawScene( Scene * scene, Renderer * renderer ){
 	//changeObserver( scene );
 
 	drawObjects( scene, renderer );
+
+	flush( renderer );
+}
+
+void drawOverlay( Scene * scene, Renderer * renderer, FrameData * frame ){
+
+	if ( scene->overlayLines->vertexCount == 0 )
+		return;
+
+	FrameData screen = frame[0];
+	glm_mat4_identity( screen.view );
+	glm_mat4_copy( screen.projection, screen.viewProjection );
+	setFrameData( renderer, &screen );
+
+	draw( scene->overlayLines, renderer );
+	flush( renderer );
 }
 
 void drawObjects( Scene * scene, Renderer * renderer ){
 
-	draw( scene->axes );
+	draw( scene->axes, renderer );
 	draw( scene->triangle, renderer );
+
+	if ( scene->showInstances )
+		draw( scene->triangleInstances, renderer );
+
+	draw( scene->sprites, renderer );
+
+	if ( scene->showDebugLines ){
+
+		vec3 triangleBounds[2] = { { -0.5, -0.5, 0 }, { 0.5, 0.7, 0 } };
+		vec4 gridColor = { 1, 1, 1, 0.2 };
+		vec4 boundsColor = { 1, 1, 0, 1 };
+
+		// Around the triangle as it's turned
+		mat4 model;
+		vec3 bounds[2];
+		modelMatrix( scene->triangle, model );
+		glm_aabb_transform( triangleBounds, model, bounds );
+
+		addGrid( scene->debugLines, 1, 20, gridColor );
+		addBox( scene->debugLines, bounds, boundsColor );
+	}
+
+	draw( scene->debugLines, renderer );
 }
 
 
@@ -1164,6 +6525,358 @@ void idleAnimation( Scene * scene ){
 
 
 
+//
+// Benchmarks
+//
+
+bool runBenchmark( const char* name, Renderer * renderer, Shader * shader ){
+
+	if ( strcmp( name, "streaming" ) == 0 )
+		benchmarkStreaming();
+	else if ( strcmp( name, "sampling" ) == 0 )
+		benchmarkSampling( renderer, shader );
+	else if ( strcmp( name, "errors" ) == 0 )
+		benchmarkErrorChecks( renderer, shader );
+	else
+		return false;
+
+	return true;
+}
+
+// Every frame, a number of writes fill most of a region,
+// and the GPU copies them to another buffer, so that it reads them
+// like a draw would, and the modes that don't fence have to sync.
+// CPU time is until the frame is submitted,
+// total time includes waiting for the GPU at the end
+void benchmarkStreaming(){
+
+	const unsigned int regionSize = 4 << 20;
+	const unsigned int writeSize = 64 << 10;
+	const unsigned int writesPerFrame = 60;
+	const int frames = 300;
+
+	const char* modeNames[] = {
+		"glBufferSubData",
+		"orphaning",
+		"unsynchronized map",
+		"persistent map"
+	};
+
+	GLuint target;
+	GLCall(glGenBuffers( 1, &target ));
+	stateBindBuffer( GL_COPY_WRITE_BUFFER, target );
+	GLCall(glBufferData( GL_COPY_WRITE_BUFFER, regionSize, NULL, GL_STATIC_COPY ));
+
+	printf(
+		"Streaming %u KB per frame in %u writes, %d frames\n",
+		writeSize * writesPerFrame >> 10, writesPerFrame, frames
+	);
+
+	for ( int mode = STREAM_SUB_DATA; mode <= STREAM_PERSISTENT; mode++ ){
+
+		BufferRing ring;
+		init( &ring, GL_ARRAY_BUFFER, regionSize, (StreamMode) mode );
+
+		// Not measured, the first frames allocate
+		GLCall(glFinish());
+		double cpuTime = 0;
+		double start = glfwGetTime();
+
+		for ( int frame = 0; frame < frames; frame++ ){
+
+			double frameStart = glfwGetTime();
+			unsigned int first = 0;
+
+			for ( unsigned int i = 0; i < writesPerFrame; i++ ){
+
+				unsigned int offset;
+				char* data = (char*) beginWrite( &ring, writeSize, &offset );
+
+				if ( data == NULL )
+					break;
+
+				memset( data, frame + i, writeSize );
+				endWrite( &ring );
+
+				if ( i == 0 )
+					first = offset;
+			}
+
+			stateBindBuffer( GL_COPY_READ_BUFFER, ring.rendererId );
+			stateBindBuffer( GL_COPY_WRITE_BUFFER, target );
+			GLCall(glCopyBufferSubData( GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, first, 0, ring.used ));
+
+			nextFrame( &ring );
+			GLCall(glFlush());
+
+			cpuTime += glfwGetTime() - frameStart;
+		}
+
+		GLCall(glFinish());
+		double totalTime = glfwGetTime() - start;
+
+		printf(
+			"  %-20s cpu %.3f ms/frame, total %.3f ms/frame\n",
+			modeNames[ring.mode],
+			cpuTime * 1000 / frames,
+			totalTime * 1000 / frames
+		);
+
+		destroy( &ring );
+	}
+
+	stateForgetBuffer( target );
+	GLCall(glDeleteBuffers( 1, &target ));
+}
+
+// A 4096x4096 texture of noise drawn over the whole window,
+// and then at 1/16 of its size as many times as it takes
+// to cover the same pixels. Without mipmaps the small draws
+// read texels far apart, missing the texture cache,
+// while with them they read a level close to their size.
+// Instanced copies, in a single call, so that the GPU doesn't wait for the CPU
+void benchmarkSampling( Renderer * renderer, Shader * shader ){
+
+	const int size = 4096;
+	const unsigned int fullDraws = 64;
+	const int repeats = 10;
+
+	typedef struct {
+		const char* name;
+		TextureOptions options;
+	} SamplingCase;
+
+	SamplingCase cases[] = {
+		{ "no mipmaps", { MIPMAPS_NONE, false, 1 } },
+		{ "bilinear mipmaps", { MIPMAPS_GPU, false, 1 } },
+		{ "trilinear", { MIPMAPS_GPU, true, 1 } },
+		{ "trilinear, 8x anisotropic", { MIPMAPS_GPU, true, 8 } }
+	};
+
+	float scales[] = { 1, 1.0f / 16 };
+
+
+	// Noise, so that neighbouring texels don't compress or cache any better
+
+	unsigned char* pixels = (unsigned char*) malloc( size * size * 4 );
+	uint32_t random = 1;
+
+	for ( int i = 0; i < size * size; i++ ){
+		random ^= random << 13;
+		random ^= random >> 17;
+		random ^= random << 5;
+		memcpy( pixels + i * 4, &random, 4 );
+	}
+
+
+	// A quad over the whole window, white and fully textured
+
+	GLfloat vertices[] = {
+		-1, -1, 0,	1, 1, 1, 1,	0, 0,
+		1, -1, 0,	1, 1, 1, 1,	1, 0,
+		1, 1, 0,	1, 1, 1, 1,	1, 1,
+		-1, 1, 0,	1, 1, 1, 1,	0, 1
+	};
+	GLuint indices[] = { 0, 1, 2, 2, 3, 0 };
+
+	VertexArray vertexArray;
+	init( &vertexArray );
+	bind( &vertexArray );
+
+	IndexBuffer indexBuffer;
+	init( &indexBuffer, sizeof( indices ), indices );
+
+	VertexBuffer vertexBuffer;
+	init( &vertexBuffer, sizeof( vertices ), vertices );
+
+	VertexBufferLayout layout;
+	init( &layout );
+	push( &layout, 3, GL_FLOAT );
+	push( &layout, 4, GL_FLOAT );
+	push( &layout, 2, GL_FLOAT );
+	push( &vertexArray, &vertexBuffer, &layout );
+
+	setUniform1i( shader, getUniformLocation( shader, "u_Texture" ), 0 );
+
+	FrameData frame = {};
+	glm_mat4_identity( frame.view );
+	glm_mat4_identity( frame.projection );
+	glm_mat4_identity( frame.viewProjection );
+
+	GLuint query;
+	GLCall(glGenQueries( 1, &query ));
+
+	GLint viewport[4];
+	GLCall(glGetIntegerv( GL_VIEWPORT, viewport ));
+
+	printf(
+		"Sampling a %dx%d texture, %u times over %dx%d pixels\n",
+		size, size, fullDraws, viewport[2], viewport[3]
+	);
+
+
+	for ( int c = 0; c < sizeof( cases ) / sizeof( cases[0] ); c++ ){
+
+		Texture texture = {};
+		texture.target = GL_TEXTURE_2D;
+		texture.width = texture.height = size;
+		texture.bpp = 4;
+		texture.format = GL_RGBA8;
+		texture.options = cases[c].options;
+		texture.levels = cases[c].options.mipmaps == MIPMAPS_NONE ? 1 : mipmapLevels( size, size );
+		texture.loaded = true;
+		texture.rendererId = createTexture( size, size, pixels, texture.levels, texture.options );
+
+		if ( texture.levels > 1 ){
+			stateBindTexture( GL_TEXTURE_2D, texture.rendererId );
+			GLCall(glGenerateMipmap( GL_TEXTURE_2D ));
+		}
+
+		printf( "  %-26s", cases[c].name );
+
+		for ( int s = 0; s < sizeof( scales ) / sizeof( scales[0] ); s++ ){
+
+			// As many copies as it takes to draw the same pixels
+			unsigned int instances = fullDraws / ( scales[s] * scales[s] );
+			double best = 0;
+
+			for ( int r = 0; r < repeats; r++ ){
+
+				mat4 model;
+				vec3 scale = { scales[s], scales[s], 1 };
+				vec4 white = { 1, 1, 1, 1 };
+				glm_scale_make( model, scale );
+
+				setFrameData( renderer, &frame );
+				setObjectData( renderer, model, white );
+				drawInstanced( renderer, &vertexArray, &indexBuffer, shader, instances, &texture );
+
+				GLCall(glBeginQuery( GL_TIME_ELAPSED, query ));
+				flush( renderer );
+				GLCall(glEndQuery( GL_TIME_ELAPSED ));
+
+				GLuint64 nanoseconds;
+				GLCall(glGetQueryObjectui64v( query, GL_QUERY_RESULT, &nanoseconds ));
+
+				// The best run, as the first ones warm up the driver
+				if ( r == 0 || nanoseconds / 1e6 < best )
+					best = nanoseconds / 1e6;
+			}
+
+			printf( "  1/%-2.0f %8.3f ms", 1 / scales[s], best );
+		}
+
+		printf( "\n" );
+
+		stateForgetTexture( texture.rendererId );
+		GLCall(glDeleteTextures( 1, &texture.rendererId ));
+	}
+
+	GLCall(glDeleteQueries( 1, &query ));
+	free( pixels );
+}
+
+// A frame of many small draws, each with its own object data,
+// so that each goes through several GLCalls, submitted with the
+// error checks of each mode. CPU time is until the frame is submitted,
+// with the once per frame check of the deferred mode.
+// The GPU is waited for between frames, outside of the time,
+// so that the ring never makes the CPU wait
+void benchmarkErrorChecks( Renderer * renderer, Shader * shader ){
+
+#ifdef GL_ERROR_CHECKS_DISABLED
+	printf( "Built with GL_ERROR_CHECKS_DISABLED, there are no checks to measure\n" );
+#else
+	const unsigned int draws = 500;
+	const int frames = 200;
+
+	int modes[] = { GL_ERRORS_IMMEDIATE, GL_ERRORS_DEFERRED };
+	const char* modeNames[] = { "immediate", "deferred" };
+
+
+	// A small quad
+
+	GLfloat vertices[] = {
+		-0.01, -0.01, 0,	1, 1, 1, 1,	0, 0,
+		0.01, -0.01, 0,		1, 1, 1, 1,	1, 0,
+		0.01, 0.01, 0,		1, 1, 1, 1,	1, 1,
+		-0.01, 0.01, 0,		1, 1, 1, 1,	0, 1
+	};
+	GLuint indices[] = { 0, 1, 2, 2, 3, 0 };
+
+	VertexArray vertexArray;
+	init( &vertexArray );
+	bind( &vertexArray );
+
+	IndexBuffer indexBuffer;
+	init( &indexBuffer, sizeof( indices ), indices );
+
+	VertexBuffer vertexBuffer;
+	init( &vertexBuffer, sizeof( vertices ), vertices );
+
+	VertexBufferLayout layout;
+	init( &layout );
+	push( &layout, 3, GL_FLOAT );
+	push( &layout, 4, GL_FLOAT );
+	push( &layout, 2, GL_FLOAT );
+	push( &vertexArray, &vertexBuffer, &layout );
+
+	FrameData frame = {};
+	glm_mat4_identity( frame.view );
+	glm_mat4_identity( frame.projection );
+	glm_mat4_identity( frame.viewProjection );
+
+	int previousMode = glErrorMode;
+	double times[2];
+
+	printf( "Error checks, %u draws per frame, %d frames\n", draws, frames );
+
+	for ( int m = 0; m < 2; m++ ){
+
+		glErrorMode = modes[m];
+
+		// Not measured, the first frames warm up the driver
+		GLCall(glFinish());
+		double cpuTime = 0;
+
+		for ( int f = -10; f < frames; f++ ){
+
+			double frameStart = glfwGetTime();
+
+			setFrameData( renderer, &frame );
+
+			for ( unsigned int i = 0; i < draws; i++ ){
+
+				mat4 model;
+				vec3 position = { ( i % 25 ) / 12.5f - 0.96f, ( i / 25 ) / 10.0f - 0.96f, 0 };
+				vec4 white = { 1, 1, 1, 1 };
+				glm_translate_make( model, position );
+
+				setObjectData( renderer, model, white );
+				draw( renderer, &vertexArray, &indexBuffer, shader );
+			}
+
+			flush( renderer );
+			GLCheckFrameErrors();
+
+			if ( f >= 0 )
+				cpuTime += glfwGetTime() - frameStart;
+
+			GLCall(glFinish());
+		}
+
+		times[m] = cpuTime * 1000 / frames;
+		printf( "  %-10s cpu %.3f ms/frame\n", modeNames[m], times[m] );
+	}
+
+	printf( "  deferred saves %.3f ms/frame, %.1fx\n", times[0] - times[1], times[0] / times[1] );
+
+	glErrorMode = previousMode;
+#endif
+}
+
+
+
 //
 // Input
 //
@@ -1194,6 +6907,14 @@ void update( Scene * scene, GLFWwindow * window ){
 		scene->cameraAngleX -= scene->cursorSpeed;
 	}
 
+	if ( glfwGetKey( window, GLFW_KEY_A ) == GLFW_PRESS ){
+		scene->triangle->angle += scene->cursorSpeed;
+	}
+
+	if ( glfwGetKey( window, GLFW_KEY_D ) == GLFW_PRESS ){
+		scene->triangle->angle -= scene->cursorSpeed;
+	}
+
 
 	// Mouse input
 
@@ -1258,6 +6979,16 @@ void keyCallback( GLFWwindow* window, int key, int scanCode, int action, int mod
 		printf( "Pressed key: %d.\n", key );
 		if ( key == GLFW_KEY_LEFT )
 			;//cameraAngleY -= 0.01;
+		else if ( key == GLFW_KEY_F1 )
+			showFrameStats = !showFrameStats;
+		else if ( key == GLFW_KEY_F2 )
+			saveTrace = true;
+		else if ( key == GLFW_KEY_I && scene != NULL )
+			scene->showInstances = !scene->showInstances;
+		else if ( key == GLFW_KEY_G && scene != NULL )
+			scene->showDebugLines = !scene->showDebugLines;
+		else if ( key == GLFW_KEY_T && scene != NULL )
+			toggleTip( scene->triangle );
 	}
 	else if ( action == GLFW_REPEAT ){
 